@@ -5,16 +5,23 @@
 // and ensures proper game state transitions.
 
 // --- Include necessary libraries ---
+#define _GNU_SOURCE      // For pthread_setaffinity_np
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>      // For offsetof
 
 #include <unistd.h>      // For sleep // FIXED: Was <unistd.>
-#include <time.h>        // For srand, time
+#include <time.h>        // For time
 #include <math.h>        // For fabsf, roundf, sqrtf, hypot, sin, cos
 #include <fcntl.h>       // For O_NONBLOCK, fcntl
 #include <errno.h>       // For errno
 #include <string.h>      // For strerror, memset
 #include <poll.h>        // For poll
+#include <pthread.h>     // For pinning station threads to cores
+#include <sched.h>       // For cpu_set_t
+#include <sys/mman.h>    // For shm_open, mmap
+#include <sys/stat.h>    // For shm_open modes, fstat
+#include <sys/file.h>    // For flock
 
 // xwiimote and bluetooth libraries for Wii Balance Board
 #include <xwiimote.h>
@@ -26,10 +33,18 @@
 #include <SDL2/SDL_mixer.h>
 #include <SDL2/SDL_image.h> // Required for PNG images
 
+// SIMD span fills for the software raster fallback
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 // --- Game Configuration ---
 #define WINDOW_WIDTH 1920
 #define WINDOW_HEIGHT 1080
 #define GAME_OBJECT_SIZE 150   // INCREASED SIZE for better visibility on a large TV.
+#define MIDDLE_GRID_SIZE 600   // Side of the centred reference grid, in pixels
 #define COB_SCALE_GENERAL 0.00015    // Original working value for general modes
 #define COB_SCALE_DODGE 0.00025 // Increased sensitivity for Dodge mode
 #define DEAD_ZONE 400.0      // Original working value
@@ -41,10 +56,41 @@
 #define POLL_TIMEOUT_THRESHOLD 100  // Much more forgiving timeout
 #define TARGET_FPS 60
 #define FRAME_TIME (1000.0f / TARGET_FPS)
+#define SOFT_RASTER_ENV "BALANCE_SOFT_RASTER" // Set in the environment to force the tiled software rasteriser
+#define AUDIO_BUFFER_SAMPLES 2048 // Mixer chunk size unless the tuning profile says otherwise
+
+// --- Device Tuning ---
+#define TUNING_FILE "tuning.cfg" // Per-unit profile written by --autotune
+#define AUTOTUNE_RENDER_MS 2000 // Render benchmark length per render scale
+#define AUTOTUNE_FPS_HEADROOM 1.2f // Required fps margin over TARGET_FPS before accepting a setting
+#define AUTOTUNE_AUDIO_MS 2000 // Audio stability test length per buffer size
+#define AUTOTUNE_AUDIO_WARMUP 4 // Callbacks ignored while the device starts
+#define AUTOTUNE_LATE_FACTOR 1.5 // A callback this many periods after the previous one is late
+#define AUTOTUNE_BOARD_WAIT_MS 5000 // How long to look for a balance board
+#define AUTOTUNE_BOARD_MS 3000 // Board sampling time
+
+// --- Replay Benchmark ---
+#define BENCH_WIN_FRAMES 150 // Frames of the win screen rendered after each replayed win
+
+// --- Stations ---
+#define MAX_STATIONS 4
+#define FONT_FILE "shingom.otf"
+
+// --- Shared Asset Cache ---
+#define ASSET_CACHE_PREFIX "/balance-game-" // Shared memory names, followed by kind and content hash
+#define ASSET_CACHE_MAGIC 0x42414c31 // Written once a segment's data is complete
+#define ASSET_CACHE_MAX_SEGMENTS 32
+#define ASSET_CACHE_LOCK ASSET_CACHE_PREFIX "lock" // flock()ed while segments are created, attached or removed
+#define ASSET_CACHE_FNV_OFFSET 14695981039346656037ULL
+
+// --- Render Resource Disk Cache ---
+#define RENDER_CACHE_DIR "render-cache" // Derived resources kept across reboots, next to the game
+#define RENDER_CACHE_MAGIC 0x43444242 // "BBDC"
+#define RENDER_CACHE_VERSION 1 // Bump whenever the layout or generation of a cached resource changes
+#define RENDER_CACHE_MAX_FILES 32
 
 // --- Debug & Performance ---
 #define DEBUG_INTERVAL 60 // Print debug info every 60 frames
-char debug_buffer[256]; // Buffer for formatted debug strings
 
 // --- Dodge Mode Configuration ---
 #define MAX_DODGE_BLOCKS 10
@@ -54,11 +100,78 @@ char debug_buffer[256]; // Buffer for formatted debug strings
 #define BLOCK_SPEED_INCREMENT 50.0f
 #define BLOCK_SPAWN_INTERVAL 2.0f
 #define DODGE_SCORE_FILE "dodge_score.txt"
-#define MENU_SELECT_TIME_REQUIRED 1.5 // Reduced time to make selection easier
+#define MENU_SELECT_TIME_REQUIRED 1.5 // Dwell needed when the lean is only just past the threshold
+#define MENU_SELECT_MIN_TIME 0.4 // Dwell needed once the lean is unambiguous (full confidence)
 #define TRANSITION_DURATION 1.5 // Duration of the camera shake and transition music
 #define MIN_TOTAL_WEIGHT 2000.0f  // Original working value
 #define INACTIVITY_TIMEOUT_SECONDS 15 // Reset to connection screen after 15 seconds of no input
 
+// --- Session Resume ---
+#define RESUME_GRACE_SECONDS 20 // A reconnect within this window continues the interrupted game
+#define RESUME_COUNTDOWN_SECONDS 3 // Countdown shown before play continues after a resume
+#define SNAPSHOT_MAGIC 0x42425353u // "BBSS"
+#define SNAPSHOT_VERSION 2
+
+// --- Speculative Pre-warming ---
+#define PREWARM_TEXT_PER_FRAME 1 // Labels of the predicted next screen rasterised per dwell frame
+
+// --- Gesture Recognition ---
+#define GESTURE_FILTER_TIME_CONSTANT 0.08f // Low-pass time constant (seconds) applied to the CoB stream
+#define GESTURE_LEAN_THRESHOLD 200.0f // Filtered CoB beyond which a lean is recognised
+#define GESTURE_CENTER_THRESHOLD 150.0f // Filtered CoB within which the player counts as centered
+#define GESTURE_AXIS_MARGIN 1.5f // Forward/back must exceed the lateral lean by this factor; diagonals count as sideways
+#define GESTURE_FULL_CONFIDENCE_COB 900.0f // Lean at which confidence reaches 1.0
+#define GESTURE_CENTER_MAX_CONFIDENCE 0.5f // Standing still is the resting pose, so never fast-track it fully
+#define GESTURE_FLICK_MAX_TIME 0.45f // A lean released within this many seconds is a flick
+#define GESTURE_FLICK_MIN_COB 600.0f // ...provided it reached at least this far
+
+// --- Step Detection ---
+#define STEP_ON_WEIGHT MIN_TOTAL_WEIGHT // Raw total weight that counts as someone on the board
+#define STEP_OFF_WEIGHT 1200.0f // Lower release threshold so hovering near the limit doesn't chatter
+#define STEP_DEBOUNCE_MS 150.0f // A crossing must persist this long before an edge is reported
+#define STEP_EVENT_QUEUE_SIZE 8
+
+// --- Limits of Stability ---
+#define STABILITY_SECTORS 64 // Polar sectors around the board centre, one envelope point each
+#define STABILITY_TEST_SECONDS 30 // Length of one assessment
+#define STABILITY_RESULT_SECONDS 8 // How long the final envelope stays on screen
+#define STABILITY_DIRECTIONS 8 // Forward, forward-right, right, ... reach is reported for
+#define STABILITY_MIN_EXCURSION 0.01f // Normalised CoB below which a sample carries no direction
+
+// --- Board Signal Statistics ---
+#define BOARD_EXPECTED_INTERVAL_MS 10.0f // Nominal balance board report cadence (~100 Hz)
+#define BOARD_GAP_FACTOR 2.5f // An interval this many times the cadence counts as a Bluetooth gap
+#define BOARD_HIST_BUCKETS 8 // Inter-sample interval histogram buckets, last one is open-ended
+#define BOARD_HIST_BUCKET_MS 5 // Width of each histogram bucket
+#define BOARD_STATS_LOG_FILE "board_stats.log" // One summary line is appended per connection
+
+// --- Sprite Atlas ---
+#define SPRITE_ATLAS_MAX_SIZE 2048 // Upper bound for the shared sprite atlas texture
+#define SPRITE_ATLAS_PADDING 2 // Transparent gap between packed images, keeps linear filtering clean
+#define MAX_SPRITES 8
+#define BOARDPOWER_WIDTH 846 // Connection screen illustration size
+#define BOARDPOWER_HEIGHT 462
+#define PLAYER_PORTRAIT_SIZE 150 // Player image size on the selection screen
+
+// --- Glyph Atlas & Text Runs ---
+#define GLYPH_PAGE_SIZE 1024      // Atlas page width/height in pixels
+#define GLYPH_MAX_PAGES 4         // Resident pages before LRU eviction kicks in
+#define GLYPH_PADDING 1           // Transparent border around each glyph
+#define GLYPH_MAX_ENTRIES 4096    // Distinct (font, codepoint) pairs tracked before a full reset
+#define GLYPH_HASH_SIZE 4096      // Must be a power of two
+#define GLYPH_BATCH_QUADS 256     // Glyph quads per SDL_RenderGeometry call
+#define MAX_TEXT_RUNS 64
+#define SDF_MASTER_SIZE 64        // Point size glyphs are rendered at for the distance field
+#define SDF_SPREAD 6              // Field range in master pixels either side of an outline
+#define SDF_ATLAS_SIZE 1024       // Distance field atlas width/height, one byte per texel
+#define SDF_MAX_GLYPHS 512
+
+// --- Software Raster Fallback ---
+#define SOFT_TILE_SIZE 128
+#define SOFT_MAX_COMMANDS 4096  // Pending commands before an early rasterise pass
+#define SOFT_MAX_WORKERS 7      // Worker threads in addition to the main thread
+#define SOFT_MAX_SPRITES 16
+
 // --- UI Configuration ---
 #define TITLE_FONT_SIZE 60
 #define TUTORIAL_FONT_SIZE 60  // Increased font size for connecting screen
@@ -71,6 +184,8 @@ char debug_buffer[256]; // Buffer for formatted debug strings
 #define TRAIL_COLOR_G 83 // Reddish-orange
 #define TRAIL_COLOR_B 81 // Reddish-orange
 #define TRAIL_THICKNESS 5
+#define INK_TRAIL_FADE_SECONDS 1.5f // Time for an ink trail stroke to fade out completely
+#define HUD_LAYER_HEIGHT 180 // Top strip of the screen covered by the cached gameplay HUD
 
 // --- Balance Hold Mode Configuration ---
 #define BH_HOLD_TIME_REQUIRED 1.5 // Time in seconds to hold position
@@ -84,6 +199,39 @@ char debug_buffer[256]; // Buffer for formatted debug strings
 #define BH_TARGET_MOVEMENT_SPEED_MEDIUM 25.0f
 #define BH_TARGET_MOVEMENT_SPEED_HARD 50.0f
 
+// --- Feedback Synthesis ---
+#define SYNTH_BASE_FREQUENCY 330.0f // Hold tone pitch when the hold has just started
+#define SYNTH_TOP_FREQUENCY 880.0f // Hold tone pitch when the target is about to be scored
+#define SYNTH_TONE_VOLUME 0.15f
+#define SYNTH_BLIP_VOLUME 0.25f
+#define SYNTH_BLIP_MS 120 // Length of the hit/reset blips
+#define SYNTH_PARAM_SMOOTHING_MS 15.0f // Glide time for pitch, volume and pan changes
+
+// --- Session Recording & Ghost Configuration ---
+#define RECORDING_MAGIC "BBRC"
+#define RECORDING_VERSION 3 // 2 adds the trailing keyframe index, 3 the simulation seed; older files are still read
+#define RECORDING_INDEX_MAGIC "BBIX"
+#define RECORDING_KEYFRAME_MS 1000 // Session time between keyframes in the index
+#define GHOST_ENABLED_DEFAULT 1 // Show the best previous run in Balance Hold and Coin Collector (F2 toggles)
+#define GHOST_COLOR_R 120
+#define GHOST_COLOR_G 120
+#define GHOST_COLOR_B 255
+#define GHOST_ALPHA 90
+
+// --- Event Bus Configuration ---
+#define EVENT_QUEUE_CAPACITY 1024 // Events buffered per consumer; must be a power of two
+#define EVENT_QUEUE_RESERVE 64 // Cells only non-sample events may fill, so a sample backlog can't crowd them out
+#define EVENT_BUS_IDLE_MS 100     // Longest an idle consumer sleeps before re-checking its queue
+
+// --- Watchdog Configuration ---
+#define WATCHDOG_INTERVAL_MS 50   // How often the watchdog thread checks the heartbeats
+#define WATCHDOG_INPUT_MS 3000    // Longest a connected board may go without any event before it is checked
+#define WATCHDOG_AUDIO_MS 300     // Longest between mixer callbacks before the audio device is reopened
+#define WATCHDOG_RENDER_MS 500    // Longest frame before the station's render targets are rebuilt
+#define WATCHDOG_IO_MS 3000       // Longest an event consumer may spend on one batch (file writes, fsync)
+#define WATCHDOG_MAX_RESTARTS 3   // Restarts without a heartbeat in between before a subsystem is given up on
+#define WATCHDOG_MAX_WATCHES 16
+
 // --- Coin Collector Mode Configuration ---
 #define CC_COIN_SPAWN_RADIUS 600
 #define COIN_SAFE_MARGIN 300    // INCREASED safety margin for the larger coins
@@ -115,7 +263,8 @@ typedef enum {
     GAME_BALANCE_HOLD,
     GAME_COIN_COLLECTOR,
     GAME_DODGE,
-    WINNING
+    WINNING,
+    GAME_STABILITY      // Limits of stability assessment, entered with a forward lean in the main menu
 } GameState;
 
 // --- Game Type for Menu Selection ---
@@ -133,6 +282,20 @@ typedef enum {
     HARD
 } Difficulty;
 
+// Per-difficulty parameters, indexed by Difficulty
+typedef struct {
+    float target_speed;     // Balance Hold target drift speed, 0 keeps it still
+    int hold_targets;       // Balance Hold targets needed to win
+    int coin_targets;       // Coin Collector coins needed to win
+    float coin_timer;       // Coin Collector seconds per coin, 0 for untimed
+} DifficultyConfig;
+
+static const DifficultyConfig difficulty_configs[] = {
+    [EASY]   = {BH_TARGET_MOVEMENT_SPEED_EASY,   10, 15, 0.0f},
+    [MEDIUM] = {BH_TARGET_MOVEMENT_SPEED_MEDIUM, 15, 20, 0.0f},
+    [HARD]   = {BH_TARGET_MOVEMENT_SPEED_HARD,   25, 30, CC_COIN_TIMER},
+};
+
 // --- Player Configuration ---
 typedef struct {
     const char* name;
@@ -182,13 +345,685 @@ typedef struct {
     int active;
 } DodgeBlock;
 
+// Everything needed to continue an interrupted game. Plain data so it can be
+// serialised with a fixed header and restored after a board reconnect.
+typedef struct {
+    int state;                   // GameState being played
+    int selected_game;
+    int difficulty;
+    int player_index;
+    int coins;
+    int current_game_target;
+    PlayerObject player;
+    TargetObject balance_hold_target;
+    float hold_timer;
+    float coin_timer;
+    Uint32 elapsed_ms;           // Game time so far, excluding pauses
+    Uint32 session_time_ms;      // Recording clock of the current run
+    Uint32 sim_rng;              // Simulation generator state, so a resumed run spawns what it would have
+    Coin coin_collector_coins[30];
+    DodgeBlock dodge_blocks[MAX_DODGE_BLOCKS];
+    float block_spawn_timer;
+    float current_block_speed;
+    float dynamic_block_spawn_interval;
+    int dodge_score;
+    int dodge_high_score;
+    float lowest_time_to_win;
+    int total_wins;
+} GameSnapshot;
+
+typedef struct {
+    Uint32 magic;
+    Uint16 version;
+    Uint16 size;
+} SnapshotHeader;
+
+#define SNAPSHOT_BUFFER_SIZE (sizeof(SnapshotHeader) + sizeof(GameSnapshot))
+
+// Saved per-profile records, loaded from disk when a player is selected
+typedef struct {
+    int player_index;
+    float lowest_time;
+    int total_wins;
+    int dodge_high_score;
+} ProfileStats;
+
+// The screen the current menu dwell is expected to lead to
+typedef struct {
+    int state;             // GameState that follows if the dwell completes
+    int player_index;
+    int game;              // GameType
+    int difficulty;        // Difficulty, only meaningful for the game screens
+} PrewarmTarget;
+
+// Describes the data in a shared asset segment
+typedef struct {
+    int w, h, pitch;        // Images only
+    Uint32 size;            // Data bytes
+} AssetInfo;
+
+// First page of a shared asset segment; the data starts on the next page
+typedef struct {
+    Uint32 magic;           // ASSET_CACHE_MAGIC once the data is complete
+    int refcount;           // Attached processes, updated atomically
+    AssetInfo info;
+} AssetHeader;
+
+// A segment this process has mapped
+typedef struct {
+    char name[64];
+    AssetHeader* header;
+    const void* data;
+    size_t size;
+    dev_t dev;              // Identify the segment, in case its name is later reused for a new one
+    ino_t ino;
+} AssetSegment;
+
+// Header of a file in RENDER_CACHE_DIR; the payload follows it
+typedef struct {
+    Uint32 magic;           // RENDER_CACHE_MAGIC
+    Uint16 version;         // RENDER_CACHE_VERSION
+    Uint16 kind;            // Resource kind letter, also part of the file name
+    Uint64 key;             // Hash of every input the resource was generated from
+    Uint64 size;            // Payload bytes
+} RenderCacheHeader;
+
+// A cache file this process has mapped
+typedef struct {
+    void* map;
+    size_t size;
+} RenderCacheMapping;
+
+// Disk cache payload of a packed sprite atlas; the ARGB8888 pixels follow, pitch w * 4
+typedef struct {
+    int count;
+    int w, h;
+    SDL_Rect slots[MAX_SPRITES]; // Per request, in request order
+} SpriteAtlasCache;
+
+// A decoded image shared read-only by all stations
+typedef struct {
+    char path[64];
+    SDL_Surface* surface;       // ARGB8888
+} SharedImage;
+
+// A station's pre-warming worker and the prediction it works on
+typedef struct {
+    SDL_Thread* thread;
+    SDL_mutex* mutex;
+    SDL_cond* cond;
+    int quit;
+    int active;                 // A prediction is outstanding
+    PrewarmTarget target;       // Latest prediction from the game thread
+    unsigned int generation;    // Bumped whenever the prediction changes or is discarded
+    unsigned int done_generation; // Generation the worker last completed
+    ProfileStats stats;         // Valid when done_generation == generation
+} Prewarm;
+
+// Session recording layout: RecordingHeader, one RecordingSample per gameplay frame,
+// then the keyframe index (RecordingKeyframe entries and a RecordingTrailer) once
+// the recording has been closed. A recording cut short has no index.
+typedef struct {
+    char magic[4];          // RECORDING_MAGIC
+    Uint16 version;
+    Uint16 sample_size;     // sizeof(RecordingSample), guards against layout changes
+    Uint8 mode;             // GameType
+    Uint8 difficulty;
+    Uint8 player_index;
+    Uint8 completed;        // 1 if the run ended in a win
+    Uint32 duration_ms;     // Filled in when the recording is finished
+    Sint64 started_at;      // Wall-clock start, seconds since the epoch
+    Uint32 seed;            // Simulation seed of the run, version 3 and later
+    Uint32 reserved;
+} RecordingHeader;
+
+typedef struct {
+    Uint32 time_ms;         // Session time, pauses excluded
+    Sint16 x, y;            // Player position in pixels
+    Sint16 x_cob, y_cob;    // CoB input that produced it
+    Uint16 weight;          // Total weight as read from the board
+    Uint16 score;           // Targets/coins collected so far
+} RecordingSample;
+
+// Samples hold absolute state, so a keyframe is the sample the index points at
+typedef struct {
+    Uint32 time_ms;         // Session time of the keyframe sample
+    Uint32 sample_index;    // Its position in the sample array
+} RecordingKeyframe;
+
+typedef struct {
+    Uint32 sample_count;
+    Uint32 keyframe_count;  // RecordingKeyframe entries right before the trailer
+    char magic[4];          // RECORDING_INDEX_MAGIC, the last bytes of the file
+} RecordingTrailer;
+
+typedef struct {
+    FILE* file;
+    char path[256];
+    RecordingHeader header;
+    GameType game;
+    Difficulty difficulty;
+    int player_index;
+    Uint32 sample_count;
+    Uint32 next_keyframe_ms;
+    RecordingKeyframe* keyframes; // Index built while recording, written on close
+    Uint32 keyframe_count;
+    Uint32 keyframe_capacity;
+} SessionRecorder;
+
+// Read-only memory mapping of a recording. Seeking only touches the index and
+// the span of samples between two keyframes.
+typedef struct {
+    void* map;
+    size_t map_size;
+    const RecordingHeader* header; // Fields from seed on are only valid from version 3
+    Uint32 seed;            // Simulation seed, 0 if the recording predates seeds
+    const RecordingSample* samples;
+    Uint32 sample_count;
+    const RecordingKeyframe* keyframes; // NULL when the recording has no index
+    Uint32 keyframe_count;
+} RecordingView;
+
+// Game events. Gameplay publishes them; sound, profile writes, the session
+// recording, metrics and log lines are produced by the consumers.
+typedef enum {
+    EVENT_TARGET_HIT,       // A Balance Hold target was held long enough
+    EVENT_COIN_COLLECTED,
+    EVENT_BLOCK_PASSED,     // A Dodge block left the screen
+    EVENT_BLOCK_HIT,        // The player ran into a Dodge block
+    EVENT_HOLD_RESET,       // A hold in progress was lost
+    EVENT_MENU_SELECT,
+    EVENT_STATE_CHANGE,
+    EVENT_DISCONNECT,
+    EVENT_RUN_STARTED,
+    EVENT_RUN_SAMPLE,       // One gameplay frame for the session recording
+    EVENT_RUN_WON,
+    EVENT_RUN_ENDED,        // The run was abandoned; its recording is closed as incomplete
+    EVENT_STABILITY_RESULT, // A limits of stability assessment finished
+    EVENT_TYPE_COUNT
+} GameEventType;
+
+typedef enum {
+    STATE_CAUSE_NONE,
+    STATE_CAUSE_TIME_UP,
+    STATE_CAUSE_INACTIVITY
+} StateCause;
+
+// Fixed-size event record, copied by value through the queues
+typedef struct {
+    Uint8 type;             // GameEventType
+    Sint8 player_index;     // Selected profile, -1 if none
+    Uint16 reserved;
+    Uint32 time_ms;         // Session time when published; the run length for RUN_WON and RUN_ENDED
+    struct Station* origin; // Publishing station, which also holds the consumers' per-station state
+    union {
+        struct { int count; int new_high_score; } score;  // TARGET_HIT, COIN_COLLECTED, BLOCK_PASSED
+        struct { Uint8 from, to, cause; } state;          // STATE_CHANGE: GameState, GameState, StateCause
+        struct { Uint8 resumable; } disconnect;
+        struct { Uint8 game, difficulty; Uint32 seed; } run; // RUN_STARTED
+        RecordingSample sample;                           // RUN_SAMPLE
+        struct { float win_time; int total_wins; Uint8 new_best; } won;
+        struct { float area; Uint8 reach[STABILITY_DIRECTIONS]; } stability; // STABILITY_RESULT, percent
+    } data;
+} GameEvent;
+
+typedef struct {
+    SDL_atomic_t sequence;  // Slot position plus one once filled, see event_queue_push
+    GameEvent event;
+} EventCell;
+
+// Bounded lock-free queue: any thread pushes, one consumer thread pops
+typedef struct {
+    EventCell cells[EVENT_QUEUE_CAPACITY];
+    SDL_atomic_t tail;      // Next position producers claim
+    char tail_padding[60];  // Keeps producers and the consumer off each other's cache line
+    unsigned int head;      // Next position to pop; owned by the consumer
+    SDL_atomic_t sleeping;  // The consumer is waiting on wake
+    SDL_atomic_t dropped;   // Samples lost to a full queue
+    SDL_atomic_t dropped_control; // Other events lost, which only happens once the reserve is used up too
+    SDL_sem* wake;
+} EventQueue;
+
+// One monitored subsystem. The owner beats; the watchdog thread flags a stall
+// and the owner restarts the subsystem on its own thread when it sees the flag.
+typedef struct {
+    char name[24];
+    Uint32 deadline_ms;
+    SDL_atomic_t armed;     // Only armed watches are checked
+    SDL_atomic_t last_beat; // SDL ticks of the last heartbeat
+    SDL_atomic_t stalled;   // Set by the watchdog, cleared by watchdog_take_stall
+    SDL_atomic_t restarts;  // Stalls since the last heartbeat
+    SDL_atomic_t stalls;    // Total, reported at exit
+} Watch;
+
+typedef struct {
+    const char* name;
+    Uint32 subscriptions;   // One bit per GameEventType
+    void (*handle)(const GameEvent* event);
+    EventQueue queue;
+    SDL_Thread* thread;     // NULL if it could not be started; events are then handled inline
+    SDL_atomic_t quit;
+    int watch;              // Watchdog slot the thread beats, -1 if unwatched
+} EventConsumer;
+
+typedef struct {
+    int counts[EVENT_TYPE_COUNT];
+    float win_time_total;   // Seconds, summed over RUN_WON events
+} EventMetrics;
+
+typedef struct {
+    RecordingView recording; // Mapped best run, map is NULL while no ghost is loaded
+    Uint32 next;            // Index of the first sample not yet shown
+    RecordingSample last;   // Most recent sample at or before the current time
+    int visible;
+    float x, y;             // Interpolated ghost position
+    PlayerObject trail_points[TRAIL_LENGTH];
+    int trail_head;
+} GhostRun;
+
+typedef enum {
+    SYNTH_BLIP_HIT,
+    SYNTH_BLIP_RESET
+} SynthBlip;
+
+// Per-connection statistics about the sample stream delivered by the board
+typedef struct {
+    Uint32 connected_at;          // SDL ticks when the connection was opened
+    unsigned long samples;        // Balance board events received
+    unsigned long gaps;           // Intervals longer than BOARD_GAP_FACTOR * cadence
+    unsigned long dropped;        // Estimated samples lost inside those gaps
+    double last_sample_ms;        // Kernel timestamp of the previous event
+    double interval_mean_ms;      // Running mean of the inter-sample interval
+    double interval_m2;           // Running sum of squared deviations (Welford)
+    float interval_min_ms;
+    float interval_max_ms;
+    unsigned long interval_hist[BOARD_HIST_BUCKETS];
+    int samples_last_frame;       // Events drained by the most recent dispatch loop
+    int samples_max_frame;
+    unsigned long frames_polled;  // Dispatch loops that returned data
+} BoardStats;
+
+typedef enum {
+    GESTURE_NONE,
+    GESTURE_CENTER,
+    GESTURE_LEFT,
+    GESTURE_RIGHT,
+    GESTURE_FORWARD,
+    GESTURE_BACK
+} Gesture;
+
+// Classifies the filtered CoB into lean poses, with a confidence score and flick detection
+typedef struct {
+    float filtered_x;
+    float filtered_y;
+    Gesture pose;          // Current pose
+    float confidence;      // 0-1, how unambiguous the current pose is
+    float hold_time;       // Seconds the current pose has been held
+    Gesture flick;         // Set for exactly one update when a quick lean-and-release completes
+    Gesture excursion;     // Direction of the lean currently being tracked for flicks
+    float excursion_time;
+    float excursion_peak;
+} GestureRecognizer;
+
+typedef enum {
+    STEP_ON,
+    STEP_OFF
+} StepEventType;
+
+typedef struct {
+    StepEventType type;
+    Uint32 time; // SDL ticks when the edge was confirmed
+} StepEvent;
+
+// Hysteresis + debounce edge detector fed with every raw total-weight sample
+typedef struct {
+    int on_board;               // Debounced state
+    int candidate;              // State the raw signal currently suggests
+    double candidate_since_ms;  // Kernel timestamp of the first sample in that state
+    StepEvent queue[STEP_EVENT_QUEUE_SIZE];
+    int queue_head;
+    int queue_count;
+} StepDetector;
+
+typedef struct {
+    float x, y;
+} StabilityPoint;
+
+// Maximum CoB excursion envelope for the limits of stability assessment.
+// Each raw sample only touches the sector it falls in, so feeding is O(1);
+// the convex hull of the sector extremes is rebuilt at most once per frame.
+typedef struct {
+    int active;                                 // Samples are being collected
+    Uint32 start_time;
+    Uint32 finished_at;                         // 0 while the test is running
+    unsigned long samples;
+    StabilityPoint current;                     // Latest sample, for the live marker
+    StabilityPoint extreme[STABILITY_SECTORS];  // Farthest sample seen in each polar sector
+    float extreme_dist_sq[STABILITY_SECTORS];   // 0 for sectors not reached yet
+    int dirty;                                  // extreme changed since the hull was built
+    StabilityPoint hull[STABILITY_SECTORS];     // Counter-clockwise hull of the extremes
+    int hull_count;
+    float area;                                 // Percent of the full CoB range
+    float reach[STABILITY_DIRECTIONS];          // Percent, forward first, clockwise
+} StabilityTest;
+
+// Quality tiers, cheapest first
+enum {
+    QUALITY_LOW,
+    QUALITY_MEDIUM,
+    QUALITY_HIGH
+};
+
+// How the player trail is drawn
+enum {
+    TRAIL_STYLE_LINES,      // Geometry through the last trail_length points
+    TRAIL_STYLE_INK         // Strokes stamped into a fading render target
+};
+
+// Result of one gameplay update
+typedef enum {
+    MODE_RUNNING,
+    MODE_WON,
+    MODE_TIME_UP
+} ModeOutcome;
+
+// Values a mode update hands to the renderer
+typedef struct {
+    float hold_progress;
+    float pulse_scale;
+} ModeFrame;
+
+typedef ModeOutcome (*ModeUpdateFn)(PlayerObject* player, float x_cob, float delta_time, ModeFrame* frame);
+
+// Render target, viewport and scale saved around offscreen drawing
+typedef struct {
+    SDL_Texture* target;
+    SDL_Rect viewport;
+    float scale_x, scale_y;
+} SavedRenderState;
+
+typedef struct {
+    SDL_Texture* texture;   // Window-sized (times render_scale) render target
+    SDL_BlendMode fade_mode;
+    float fade_carry;       // Fade owed but not yet applied, in 1/255 steps
+    Uint32 last_update;
+    float last_x, last_y;   // End of the previous stroke
+    int has_last;
+    int needs_clear;
+    int failed;             // Unsupported by the renderer; use the line trail
+} InkTrail;
+
+// A static image: a sub-rect of the sprite atlas, or of its own texture if it did not fit
+typedef struct {
+    SDL_Texture* texture;
+    SDL_Rect src;
+} Sprite;
+
+// One image to pack, and where to store the resulting sprite
+typedef struct {
+    const char* path;
+    int max_w, max_h;       // Largest size the image is drawn at
+    Sprite** sprite;
+} SpriteRequest;
+
+// Every value the gameplay HUD shows. All ints so the struct has no padding and compares with memcmp.
+typedef struct {
+    int state;              // GAME_BALANCE_HOLD, GAME_COIN_COLLECTOR or GAME_DODGE
+    int player_index;       // -1 hides the player name
+    int count, target;      // Targets/coins reached and needed, or dodge score and high score
+    int hold_fill;          // Filled width of the hold bar in pixels, -1 hides the bar
+    int timer_tenths;       // Hard-mode coin timer in tenths of a second, -1 hides it
+} HudValues;
+
+typedef struct {
+    SDL_Texture* texture;   // WINDOW_WIDTH x HUD_LAYER_HEIGHT render target
+    HudValues shown;        // Values the texture currently shows
+    int valid;              // Cleared when the target's contents are lost
+    int failed;             // No render target support; draw directly
+} HudLayer;
+
+// Per-unit settings loaded from TUNING_FILE at startup
+typedef struct {
+    int target_fps;         // Frame limiter
+    int poll_timeout_ms;    // Board poll timeout per frame
+    int trail_length;       // Trail points drawn, at most TRAIL_LENGTH
+    int trail_style;        // TRAIL_STYLE_*
+    int audio_buffer;       // Mixer chunk size in samples
+    int quality;            // QUALITY_*
+    float render_scale;     // Internal resolution relative to the window
+    float filter_strength;  // CoB low-pass time constant in seconds, 0 disables
+    int vsync;              // Present with vsync
+} Tuning;
+
+// Headless replay benchmark state (--bench)
+typedef struct {
+    int active;
+    char** paths;           // Recordings from the command line
+    int path_count;
+    int next_path;
+    RecordingView recording; // Recording being replayed
+    Uint32 next_sample;
+    Uint32 last_sample_ms;
+    RecordingSample expected; // Recorded result of the frame being replayed
+    int diverged_frames;    // Frames whose replayed position differs from the recording
+    int win_frames;         // Win screen frames rendered so far
+    int recordings_played;
+    float* frame_ms;        // Measured frame times
+    int frame_count;
+    int frame_capacity;
+} Bench;
+
+typedef struct {
+    TTF_Font* font;
+    Uint32 codepoint;
+    int page;         // Atlas page holding the bitmap, -1 if not resident
+    SDL_Rect rect;    // Bitmap location inside the page
+    int x_offset;     // Bitmap offset from the pen position
+    int advance;
+    int blank;        // Nothing to draw (whitespace or unrenderable)
+    int next;         // Hash chain, index + 1 (0 ends the chain)
+} GlyphEntry;
+
+typedef struct {
+    SDL_Texture* texture;
+    int shelf_x, shelf_y, shelf_h; // Current packing shelf
+    Uint32 last_used;
+} GlyphPage;
+
+typedef struct {
+    Uint32 codepoint;
+    Sint16 x, y;      // Pen position relative to the run's top-left corner
+} RunGlyph;
+
+typedef struct {
+    char* text;
+    TTF_Font* font;
+    int wrap_width;   // 0 for single-line text
+    RunGlyph* glyphs;
+    int glyph_count;
+    int w, h;
+    Uint32 last_used;
+} TextRun;
+
+typedef enum {
+    SOFT_CMD_RECT,
+    SOFT_CMD_GRADIENT,
+    SOFT_CMD_CIRCLE,
+    SOFT_CMD_RING,
+    SOFT_CMD_QUAD,
+    SOFT_CMD_SPRITE,
+    SOFT_CMD_GLYPH
+} SoftCommandType;
+
+typedef struct {
+    SDL_Texture* texture;   // Texture (usually the sprite atlas) this stands in for
+    Uint32* pixels;         // ARGB8888 copy of the texture's image
+    int w, h;
+} SoftSprite;
+
+typedef struct {
+    SoftCommandType type;
+    SDL_Rect bounds;        // Screen-space bounding box, clipped to the framebuffer
+    SDL_Color color;        // Fill colour (gradient start)
+    SDL_Color color2;       // Gradient end colour
+    int cx, cy, radius, inner_radius; // Circle and ring
+    float qx[4], qy[4];     // Convex quad corners, in order
+    const SoftSprite* sprite;
+    int glyph_page;
+    SDL_Rect src;           // Glyph rect in its atlas page, or sprite rect in its sheet
+} SoftCommand;
+
+typedef struct {
+    Uint32* pixels;         // WINDOW_WIDTH x WINDOW_HEIGHT ARGB8888
+    SDL_Texture* texture;
+    SoftCommand commands[SOFT_MAX_COMMANDS];
+    int command_count;
+    SoftSprite sprites[SOFT_MAX_SPRITES];
+    int sprite_count;
+    Uint8* glyph_masks[GLYPH_MAX_PAGES]; // Alpha of each atlas page
+    int tiles_x, tiles_y;
+
+    SDL_Thread* workers[SOFT_MAX_WORKERS];
+    int worker_count;
+    SDL_mutex* mutex;
+    SDL_cond* start_cond;
+    SDL_cond* done_cond;
+    int generation;         // Bumped for each rasterise pass
+    int quit;
+    SDL_atomic_t next_tile;
+    SDL_atomic_t tiles_remaining;
+} SoftRaster;
+
+// One board-and-display station and everything it plays and draws. Station
+// code reaches it through the thread-local `station`: its simulation thread
+// updates it and the main thread draws it, each holding lock.
+typedef struct Station {
+    int index;
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    TTF_Font* font_score;
+    TTF_Font* font_tutorial;
+    TTF_Font* font_menu_title;
+    TTF_Font* font_menu_description;
+    SDL_Texture* scene_target;  // Reduced-resolution render target when tuning.render_scale < 1
+    SDL_Thread* thread;         // Simulation thread; NULL when the main thread runs the only station
+    SDL_mutex* lock;            // Held by the simulation for each frame update and by the main thread while drawing
+    SDL_atomic_t finished;      // The simulation thread has exited
+    int quit;
+
+    // Game loop
+    GameState state;
+    GameState published_state;  // Last state announced on the event bus
+    StateCause state_cause;     // Why the next state change happens, if notable
+    PlayerObject player;
+    float x_cob, y_cob;
+    Uint32 last_frame_time;
+    Uint32 last_input_time;
+    float hold_progress;        // Balance Hold bar, written by the mode update
+    float pulse_scale;          // Balance Hold target pulse
+    int render_offset_x, render_offset_y; // Transition shake
+    int debug_frame_counter;
+    char debug_buffer[256];     // Buffer for formatted debug strings
+
+    // Board
+    struct xwii_iface *iface;
+    int fd;
+    struct xwii_event event;
+    int claimed_board;          // This station's slot in claimed_boards, -1 if none
+    Uint32 last_data_ms;        // When the board last delivered a report
+    int board_dispatch_error;   // xwii_iface_dispatch failed with more than "nothing pending", or the device went away
+    BoardStats board_stats;
+    int show_board_stats;       // Toggled with F1
+    StepDetector step_detector;
+    StabilityTest stability;
+    GestureRecognizer gesture;
+    float current_total_weight;
+    float cob_filtered_x, cob_filtered_y; // Low-passed CoB when tuning.filter_strength > 0
+    int input_watch;            // Board samples
+    int render_watch;           // Presented frames
+
+    // Rendering
+    ConfettiParticle confetti[NUM_CONFETTI];
+    PlayerObject trail_points[TRAIL_LENGTH];
+    int trail_head;
+    HudLayer hud_layer;
+    InkTrail ink_trail;
+    Sprite* boardpower_sprite;
+    Sprite* player_sprites[3];
+    Sprite* coin_sprite;
+    Sprite sprite_slots[MAX_SPRITES];
+    int sprite_count;
+    SDL_Texture* sprite_atlas_texture;
+    GlyphEntry glyph_entries[GLYPH_MAX_ENTRIES];
+    int glyph_entry_count;
+    int glyph_hash[GLYPH_HASH_SIZE]; // Index + 1 of the first entry in each bucket
+    GlyphPage glyph_pages[GLYPH_MAX_PAGES];
+    int glyph_page_count;
+    TextRun text_runs[MAX_TEXT_RUNS];
+    int text_run_count;
+    Uint32 text_cache_clock;
+    int soft_raster_enabled;    // Primitives go through the tiled software rasteriser
+    SoftRaster soft;
+
+    // Profile
+    float lowest_time_to_win;
+    int total_wins;
+    int game_paused;            // Set while the player is off the board mid-game
+    Uint32 pause_start_time;
+
+    // Menus
+    float menu_select_timer;
+    GameType selected_game;
+    int stability_selected;     // Forward lean highlighted in the main menu
+    Difficulty current_difficulty;
+    int difficulty_selection;   // 0: None, 1: Easy, 2: Medium, 3: Hard
+    int selected_player_index;
+    int player_selection_choice; // 1 for left, 2 for center, 3 for right
+
+    // Games
+    Uint32 sim_seed;            // Seed the current run started from
+    Uint32 sim_rng;             // Spawns and target placement; replays reseed it from the recording
+    Uint32 fx_rng;              // Confetti and screen shake, kept apart so they can't shift the simulation
+    int current_game_target;    // Target score for the current game
+    float hold_timer;
+    int coins;
+    Coin coin_collector_coins[30]; // Max coins for hard mode
+    float coin_timer;
+    Uint32 game_start_time;
+    Uint32 win_message_start_time;
+    int beeps_played;
+    float pulse_timer;          // Drives the Balance Hold target pulse
+    TargetObject balance_hold_target; // Specific target for Balance Hold mode
+    DodgeBlock dodge_blocks[MAX_DODGE_BLOCKS];
+    float block_spawn_timer;
+    float current_block_speed;
+    int dodge_score;
+    int dodge_high_score;
+    float dynamic_block_spawn_interval;
+    Uint32 dodge_last_input_time;
+
+    // Transition
+    Uint32 transition_start_time;
+    float shake_intensity;
+    Uint32 connection_start_time;
+
+    // Session recording, ghost playback and resume
+    SessionRecorder recorder;   // Owned by the recorder consumer
+    GhostRun ghost;
+    int ghost_enabled;
+    Uint32 session_time_ms;     // Play time of the current run, pauses excluded
+    Uint8 snapshot_buffers[2][SNAPSHOT_BUFFER_SIZE]; // Written each frame into the back buffer, then flipped
+    int snapshot_front;         // -1 while no snapshot has been taken
+    int resume_available;       // A game was interrupted by a disconnect
+    Uint32 resume_deadline;     // SDL ticks after which the interrupted game is discarded
+    int resume_countdown_active;
+    Uint32 resume_countdown_start;
+
+    Prewarm prewarm;            // Speculative pre-warming worker, shared with it by pointer
+    EventMetrics metrics;       // Owned by the metrics consumer
+} Station;
+
 // --- Global Variables ---
-struct xwii_iface *iface = NULL;
-int fd = -1;
-struct xwii_event event;
-ConfettiParticle confetti[NUM_CONFETTI];
-float lowest_time_to_win = -1.0f;
-int total_wins = 0; // NEW: Global variable for total wins
 // Pointers to the sound effects and music
 Mix_Chunk *coin_sound = NULL;
 Mix_Chunk *win_sound = NULL;
@@ -200,52 +1035,75 @@ Mix_Music *connection_main_music = NULL;
 Mix_Music *transition_music = NULL;
 Mix_Music *main_intro_music = NULL;
 Mix_Music *main_loop_music = NULL;
-PlayerObject trail_points[TRAIL_LENGTH];
-int trail_head = 0;
-SDL_Texture* boardpower_texture = NULL;
-SDL_Texture* player_textures[3];
-SDL_Texture* coin_texture = NULL;
-int poll_timeout_count = 0;
-Coin coin_collector_coins[30]; // Max coins for hard mode
-float current_total_weight = 0.0f;
-float coin_timer = 0.0f;
-
-// Dodge game variables
-DodgeBlock dodge_blocks[MAX_DODGE_BLOCKS];
-float block_spawn_timer = 0;
-float current_block_speed = BLOCK_INITIAL_SPEED;
-int dodge_score = 0;
-int dodge_high_score = 0;
-
-// Add a variable to manage the dynamic spawn interval
-float dynamic_block_spawn_interval = BLOCK_SPAWN_INTERVAL;
-
-// Menu-specific global variables
-float menu_select_timer = 0.0f;
-GameType selected_game = NO_GAME_SELECTED;
-Difficulty current_difficulty;
-int difficulty_selection = 0; // 0: None, 1: Easy, 2: Medium, 3: Hard
-int selected_player_index = -1;
-int player_selection_choice = 0; // 1 for left, 2 for center, 3 for right
-
-// Game-specific variables
-int current_game_target = 0; // Target score for the current game
-float hold_timer = 0.0;
-int coins = 0;
-Uint32 game_start_time = 0;
-Uint32 win_message_start_time = 0;
-int beeps_played = 0;
-TargetObject balance_hold_target; // Specific target for Balance Hold mode
-
-// Transition variables
-Uint32 transition_start_time = 0;
-float shake_intensity = 0.0f;
-Uint32 connection_start_time = 0;
-
-// Dodge game movement control
-Uint32 dodge_last_input_time = 0;
+
+Tuning tuning; // Loaded from TUNING_FILE at startup
+Bench bench;
+int persistence_enabled = 1; // Scores, wins and recordings are written to the profile
+
+// Feedback synthesis parameters, written by the game thread and read by the audio callback
+SDL_atomic_t synth_tone_frequency_mhz; // Milli-hertz
+SDL_atomic_t synth_tone_amplitude;     // 0-10000
+SDL_atomic_t synth_tone_pan;           // -10000 (left) to 10000 (right)
+SDL_atomic_t synth_hit_count;          // Incremented to trigger a blip
+SDL_atomic_t synth_reset_count;
+
+// Stations. A single station runs on the main thread; with --stations N each
+// simulates on its own thread and the main thread draws all of them.
+Station* stations[MAX_STATIONS];
+int station_count = 1;
+_Thread_local Station* station = NULL; // Station the calling thread is working for
+SDL_mutex* shared_asset_lock = NULL;   // Shared image cache, board claims and font face creation
+SharedImage shared_images[MAX_SPRITES];
+int shared_image_count = 0;
+const void* shared_font_data = NULL;   // FONT_FILE bytes; each station opens its faces from these
+size_t shared_font_size = 0;
+int shared_font_owned = 0;             // shared_font_data is a private copy rather than shared memory
+AssetSegment asset_segments[ASSET_CACHE_MAX_SEGMENTS]; // Guarded by shared_asset_lock once stations run
+int asset_segment_count = 0;
+int asset_cache_lock_fd = -1;          // ASSET_CACHE_LOCK, opened on first use
+RenderCacheMapping render_cache_maps[RENDER_CACHE_MAX_FILES]; // Guarded by shared_asset_lock
+int render_cache_map_count = 0;
+char claimed_boards[MAX_STATIONS][256]; // Board device paths in use, "" for a free slot
+int autotune_mode = 0;                 // --autotune
+
+// Watchdog. Slots are only added, never removed, so the thread reads them without a lock.
+Watch watches[WATCHDOG_MAX_WATCHES];
+SDL_atomic_t watch_count;
+SDL_Thread* watchdog_thread = NULL;
+SDL_sem* watchdog_wake = NULL;
+SDL_atomic_t watchdog_quit;
+int audio_watch = -1;                  // The mixer callback
+SDL_mutex* mixer_lock = NULL;          // Held around Mix_ calls once threads run: music, sound effects, reopening the device
+int audio_open = 0;                    // Guarded by mixer_lock
+SDL_Thread* audio_keeper_thread = NULL; // Reopens the audio device when the watchdog flags it
+SDL_sem* audio_keeper_wake = NULL;
+SDL_atomic_t audio_keeper_quit;
 
 // --- Function Prototypes ---
+const void* asset_cache_attach(char kind, Uint64 key, AssetInfo* info_out);
+const void* asset_cache_publish(char kind, Uint64 key, const AssetInfo* info, const void* data, AssetInfo* info_out);
+void asset_cache_release_all(void);
+Mix_Chunk* load_shared_chunk(const char* path);
+SDL_Surface* load_shared_image(const char* path);
+const void* load_shared_file(const char* path, size_t* size, int* owned);
+Uint64 fnv1a64(const void* data, size_t size, Uint64 hash);
+int asset_source_key(const char* path, Uint64* key);
+void* render_cache_map(char kind, Uint64 key, size_t* size_out);
+int render_cache_store(char kind, Uint64 key, const void* const* parts, const size_t* sizes, int count);
+void render_cache_release_all(void);
+int board_claim(const char* path);
+void board_release(void);
+SDL_Surface* shared_image(const char* path);
+void cleanup_shared_images(void);
+TTF_Font* open_shared_font(int size);
+void close_shared_font(TTF_Font* font);
+void cleanup_sdf_atlas(void);
+void station_route_event(const SDL_Event* event_sdl);
+int station_update(void);
+int station_draw(void);
+Station* station_open(int index);
+void station_close(Station* s);
+void run_stations(void);
 void init_dodge_game(PlayerObject *player); 
 void reset_game_state();
 int init_xwiimote_non_blocking();
@@ -254,6 +1112,8 @@ void write_lowest_time(const char* filename, float new_score);
 int read_total_wins(const char* filename);
 void write_total_wins(const char* filename, int wins);
 void draw_hold_timer_bar(SDL_Renderer* renderer, int x, int y, int width, int height, float progress);
+void draw_hud(SDL_Renderer* renderer, TTF_Font* font, const HudValues* values);
+void cleanup_hud_layer(void);
 void cleanup_text_cache(void);
 int read_dodge_high_score(const char* filename);
 void write_dodge_high_score(const char* filename, int score);
@@ -261,50 +1121,173 @@ void draw_gradient_background(SDL_Renderer* renderer, SDL_Color start_color, SDL
 void draw_middle_grid(SDL_Renderer* renderer);
 void draw_filled_circle(SDL_Renderer* renderer, int x, int y, int radius);
 void draw_outlined_circle(SDL_Renderer* renderer, int x, int y, int radius, int thickness);
+int text_size(TTF_Font* font, const char* text, int* w, int* h);
 void draw_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color);
+int soft_raster_init(SDL_Renderer* renderer);
+void soft_raster_shutdown(void);
+void soft_raster_flush(void);
+void soft_raster_begin_frame(SDL_Renderer* renderer);
+void soft_raster_present(SDL_Renderer* renderer);
+void soft_raster_gradient(SDL_Color start_color, SDL_Color end_color);
+void soft_raster_circle(SDL_Renderer* renderer, int x, int y, int radius, int thickness);
+void soft_raster_quad(const float* xs, const float* ys, SDL_Color color);
+void soft_raster_store_glyph(int page, const SDL_Rect* slot, const Uint32* pixels, int pitch_pixels);
+void soft_raster_glyph(int page, const SDL_Rect* src, int x, int y, SDL_Color color);
+void render_fill_rect(SDL_Renderer* renderer, const SDL_Rect* rect);
+int load_sprite_atlas(SDL_Renderer* renderer, SpriteRequest* requests, int count);
+void cleanup_sprites(void);
+void draw_sprite(SDL_Renderer* renderer, const Sprite* sprite, const SDL_Rect* dst, Uint8 alpha);
 void draw_centered_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, int y, SDL_Color color);
+void draw_text_scaled(SDL_Renderer* renderer, TTF_Font* font, const char* text, int center_x, int center_y, float scale, SDL_Color color);
 void draw_confetti(SDL_Renderer* renderer, ConfettiParticle particle);
 void init_confetti(float x, float y);
 void update_confetti(float delta_time);
 void draw_thick_line(SDL_Renderer* renderer, float x1, float y1, float x2, float y2, int thickness, SDL_Color color);
+void draw_trail(SDL_Renderer* renderer, const PlayerObject* points, int head, SDL_Color color, int thickness);
 void draw_line_trail(SDL_Renderer* renderer);
+int push_render_target(SDL_Renderer* renderer, SDL_Texture* target, float scale, SavedRenderState* saved);
+void pop_render_target(SDL_Renderer* renderer, const SavedRenderState* saved);
+void ink_trail_reset(void);
+int draw_ink_trail(SDL_Renderer* renderer, SDL_Color color, int thickness);
+void cleanup_ink_trail(void);
 int read_wii_balance_board_data(float *x_cob, float *y_cob);
 void init_player(PlayerObject *player);
+Uint32 sim_new_seed(void);
+void sim_seed(Uint32 seed);
+int sim_rand(void);
+int fx_rand(void);
 void init_balance_hold_game(PlayerObject *player, TargetObject *target);
 void init_coin_collector_game(PlayerObject *player);
+void spawn_coin(int index, const PlayerObject* player);
 void spawn_dodge_block();
 int is_in_zone(PlayerObject player, TargetObject target, int zone_radius);
 void music_intro_finished_callback();
 void update_player_position(PlayerObject* player, float target_x, float target_y, float delta_time);
+void board_stats_reset(void);
+void board_stats_record_sample(const struct timeval* timestamp);
+void board_stats_end_frame(int samples_this_frame);
+float board_stats_effective_rate(void);
+float board_stats_jitter_ms(void);
+float board_stats_signal_quality(void);
+void board_stats_format(char* buffer, size_t size);
+void board_stats_log_session(const char* reason);
+void draw_board_stats_overlay(SDL_Renderer* renderer, TTF_Font* font);
+void gesture_reset(GestureRecognizer* recognizer);
+void gesture_update(GestureRecognizer* recognizer, float x_cob, float y_cob, float total_weight, float delta_time);
+int update_lean_menu(int* choice, int allow_forward, float delta_time);
+void tuning_set_defaults(Tuning* t);
+int load_tuning(const char* filename, Tuning* t);
+int save_tuning(const char* filename, const Tuning* t, const char* comment);
+int run_autotune(SDL_Renderer* renderer, TTF_Font* font);
+int bench_start(char** paths, int count);
+int bench_open_next(GameType* game, Difficulty* difficulty, int* player_index);
+int bench_next_input(float* x_cob, float* y_cob, float* delta_time);
+void bench_check_frame(const PlayerObject* player);
+void bench_record_frame(Uint64 start_counter);
+int bench_report(void);
+void format_recording_filename(char* filename, size_t size, GameType game, Difficulty difficulty, int player_index, int station, const char* kind);
+void recorder_start(GameType game, Difficulty difficulty);
+void recorder_write(Uint32 time_ms, const PlayerObject* player, float x_cob, float y_cob, float total_weight, int score);
+void recorder_discard(void);
+void ghost_open(GameType game, Difficulty difficulty, int player_index);
+void ghost_close(void);
+void ghost_advance(Uint32 time_ms);
+void ghost_seek(Uint32 time_ms);
+int recording_map(const char* path, RecordingView* view);
+void recording_unmap(RecordingView* view);
+Uint32 recording_seek(const RecordingView* view, Uint32 time_ms);
+int inspect_recording(const char* path, float from_seconds, float to_seconds);
+void draw_ghost(SDL_Renderer* renderer, const Sprite* player_sprite);
+int synth_init(void);
+void synth_shutdown(void);
+int synth_available(void);
+void synth_set_tone(float frequency, float amplitude, float pan);
+void synth_trigger(SynthBlip blip);
+size_t snapshot_serialize(const GameSnapshot* snapshot, Uint8* buffer, size_t size);
+int snapshot_deserialize(const Uint8* buffer, size_t size, GameSnapshot* snapshot);
+void snapshot_capture(GameState state, const PlayerObject* player);
+int snapshot_restore(GameState* state, PlayerObject* player);
+void load_profile_stats(int player_index, ProfileStats* stats);
+int game_target_for(GameType game, Difficulty difficulty);
+ModeUpdateFn mode_update_for(GameState state, Difficulty difficulty);
+int prewarm_init(void);
+void prewarm_shutdown(void);
+void prewarm_predict(GameState next_state, int player_index, GameType game, Difficulty difficulty);
+void prewarm_cancel(void);
+void commit_profile_stats(GameState next_state, int player_index, ProfileStats* stats);
+void prewarm_warm_text(SDL_Renderer* renderer, TTF_Font* font_title, TTF_Font* font_description, TTF_Font* font_score);
+void step_detector_reset(void);
+void step_detector_feed(float total_weight, const struct timeval* timestamp);
+int step_detector_poll(StepEvent* out_event);
+void stability_begin(void);
+void stability_feed(const float* cells, float total_weight);
+int stability_update(void);
+void draw_stability(SDL_Renderer* renderer, TTF_Font* font_title, TTF_Font* font_description);
+int station_index(void);
+void event_publish(GameEvent event);
+int event_bus_start(void);
+void event_bus_stop(void);
+int watchdog_register(const char* name, Uint32 deadline_ms);
+void watchdog_arm(int watch);
+void watchdog_disarm(int watch);
+void watchdog_beat(int watch);
+int watchdog_take_stall(int watch);
+int watchdog_start(void);
+void watchdog_stop(void);
+int board_reopen(void);
+int audio_restart(void);
+int audio_keeper_start(void);
+void audio_keeper_stop(void);
+int music_play(Mix_Music* music, int loops);
+int music_playing(void);
+void music_halt(void);
 
 
 /**
  * @brief Resets all game state variables and cleans up xwiimote resources.
  */
 void reset_game_state() {
-    if (iface) {
-        xwii_iface_close(iface, XWII_IFACE_BALANCE_BOARD);
-        xwii_iface_unref(iface);
-    }
-    iface = NULL;
-    fd = -1;
-    poll_timeout_count = 0;
-    menu_select_timer = 0.0f;
-    selected_game = NO_GAME_SELECTED;
-    difficulty_selection = 0;
-    selected_player_index = -1;
-    player_selection_choice = 0;
-    current_game_target = 0;
-    hold_timer = 0.0f;
-    coins = 0;
-    beeps_played = 0;
-    Mix_HaltMusic(); // Stop all music
+    if (station->iface) {
+        board_stats_log_session("reset");
+        xwii_iface_close(station->iface, XWII_IFACE_BALANCE_BOARD);
+        xwii_iface_unref(station->iface);
+    }
+    station->iface = NULL;
+    board_release();
+    station->fd = -1;
+    station->last_data_ms = 0;
+    watchdog_disarm(station->input_watch);
+    station->menu_select_timer = 0.0f;
+    gesture_reset(&station->gesture);
+    prewarm_cancel();
+    station->selected_game = NO_GAME_SELECTED;
+    station->difficulty_selection = 0;
+    station->selected_player_index = -1;
+    station->player_selection_choice = 0;
+    station->current_game_target = 0;
+    station->hold_timer = 0.0f;
+    station->coins = 0;
+    station->beeps_played = 0;
+    station->game_paused = 0;
+    station->resume_countdown_active = 0;
+    station->stability.active = 0;
+    station->stability_selected = 0;
+    if (!station->resume_available) {
+        // Keep the snapshot and the open recording while a reconnect may still resume
+        station->snapshot_front = -1;
+        recorder_discard();
+        ghost_close();
+    }
+    // Stop all music. Only a single station plays any.
+    if (station_count == 1) music_halt();
 }
 
 /**
  * @brief Initializes the xwiimote interface and connects to the Wii Balance Board.
  * @return 0 on success, -1 on failure.
  */
+static int board_open_path(const char* path);
+
 int init_xwiimote_non_blocking() {
     struct xwii_monitor *mon = NULL;
     char *path = NULL;
@@ -313,13 +1296,14 @@ int init_xwiimote_non_blocking() {
         fprintf(stderr, "Failed to create xwiimote monitor\n");
         return -1;
     }
-    path = xwii_monitor_poll(mon);
+    // Take the first board that no other station is using
+    while ((path = xwii_monitor_poll(mon)) && board_claim(path) != 0) free(path);
     if (!path) {
         xwii_monitor_unref(mon);
         // Try again with specific MAC
         mon = xwii_monitor_new(false, WII_BB_MAC_ADDRESS);
         if (!mon) return -1;
-        path = xwii_monitor_poll(mon);
+        while ((path = xwii_monitor_poll(mon)) && board_claim(path) != 0) free(path);
     }
     xwii_monitor_unref(mon);
     if (!path) {
@@ -327,62 +1311,136 @@ int init_xwiimote_non_blocking() {
         return -1;
     }
     printf("Found balance board at: %s\n", path);
-    if (xwii_iface_new(&iface, path) < 0) {
+    int ret = board_open_path(path);
+    free(path);
+    if (ret != 0) {
+        board_release();
+        return -1;
+    }
+    printf("Wii Balance Board connected!\n");
+    board_stats_reset();
+    station->cob_filtered_x = station->cob_filtered_y = 0.0f;
+    step_detector_reset();
+    watchdog_arm(station->input_watch);
+    return 0;
+}
+
+// Opens the balance board interface at a claimed device path into iface and fd.
+static int board_open_path(const char* path) {
+    if (xwii_iface_new(&station->iface, path) < 0) {
         perror("Failed to open interface, retrying...");
-        free(path);
-        iface = NULL;
+        station->iface = NULL;
         return -1;
     }
-    free(path);
-    fd = xwii_iface_get_fd(iface);
-    if (fd < 0) {
+    station->fd = xwii_iface_get_fd(station->iface);
+    if (station->fd < 0) {
         perror("Failed to get file descriptor, retrying...");
-        xwii_iface_unref(iface);
-        iface = NULL;
+        xwii_iface_unref(station->iface);
+        station->iface = NULL;
         return -1;
     }
-    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+    if (fcntl(station->fd, F_SETFL, fcntl(station->fd, F_GETFL) | O_NONBLOCK) < 0) {
         perror("Failed to set non-blocking mode on fd, retrying...");
-        xwii_iface_unref(iface);
-        iface = NULL;
+        xwii_iface_unref(station->iface);
+        station->iface = NULL;
+        station->fd = -1;
         return -1;
     }
-    int ret = xwii_iface_open(iface, XWII_IFACE_BALANCE_BOARD);
+    int ret = xwii_iface_open(station->iface, XWII_IFACE_BALANCE_BOARD);
     if (ret < 0) {
         fprintf(stderr, "Cannot open interface: %d\n", ret);
-        xwii_iface_unref(iface);
-        iface = NULL;
+        xwii_iface_unref(station->iface);
+        station->iface = NULL;
+        station->fd = -1;
         return -1;
     }
 
-    ret = xwii_iface_watch(iface, true);
+    ret = xwii_iface_watch(station->iface, true);
     if (ret) {
         fprintf(stderr, "Cannot initialize hotplug watch: %d\n", ret);
-        xwii_iface_unref(iface);
-        iface = NULL;
+        xwii_iface_unref(station->iface);
+        station->iface = NULL;
+        station->fd = -1;
         return -1;
     }
-    printf("Wii Balance Board connected!\n");
+    station->last_data_ms = SDL_GetTicks();
+    return 0;
+}
+
+/**
+ * @brief Reopens this station's board in place after the watchdog found it silent.
+ * The claim, the session statistics and the game are kept.
+ * @return 0 on success, -1 if the board is gone (iface is then NULL).
+ */
+int board_reopen(void) {
+    if (!station->iface || station->claimed_board < 0) return -1;
+    char path[sizeof(claimed_boards[0])];
+    SDL_LockMutex(shared_asset_lock);
+    snprintf(path, sizeof(path), "%s", claimed_boards[station->claimed_board]);
+    SDL_UnlockMutex(shared_asset_lock);
+    xwii_iface_close(station->iface, XWII_IFACE_BALANCE_BOARD);
+    xwii_iface_unref(station->iface);
+    station->iface = NULL;
+    station->fd = -1;
+    if (board_open_path(path) != 0) return -1;
+    station->board_dispatch_error = 0;
+    printf("Board reopened\n");
     return 0;
 }
 
 // --- File I/O Functions ---
-// Helper function to generate profile-specific filename
-char* get_profile_filename(const char* base_filename, int player_index) {
-    static char filename[256];
+// Helper function to generate profile-specific filename into a caller-owned buffer
+void format_station_profile_filename(char* filename, size_t size, const char* base_filename, int player_index, int station) {
     const char* player_name = available_players[player_index].name;
-    // Convert player name to lowercase for filename
+    // Convert player name to lowercase for filename, with spaces as underscores so
+    // the names survive make and the shell (see BENCH_RECORDINGS in the Makefile)
     char lowercase_name[64];
     int i = 0;
     while (player_name[i] && i < 63) {
         lowercase_name[i] = (player_name[i] >= 'A' && player_name[i] <= 'Z') ? 
-                           player_name[i] + 32 : player_name[i];
+                           player_name[i] + 32 : (player_name[i] == ' ' ? '_' : player_name[i]);
         i++;
     }
     lowercase_name[i] = '\0';
     
-    snprintf(filename, sizeof(filename), "%s_%s", lowercase_name, base_filename);
-    return filename;
+    // Stations after the first keep separate profiles
+    char prefix[24] = "";
+    if (station > 0) snprintf(prefix, sizeof(prefix), "station%d_", station + 1);
+    snprintf(filename, size, "%s%s_%s", prefix, lowercase_name, base_filename);
+
+    // Carry over a file saved under the old name with spaces
+    if (strchr(player_name, ' ') && access(filename, F_OK) != 0) {
+        char old_filename[256];
+        snprintf(old_filename, sizeof(old_filename), "%s%.*s_%s", prefix, i, player_name, base_filename);
+        for (int c = (int)strlen(prefix); c < (int)strlen(prefix) + i; c++) {
+            if (old_filename[c] >= 'A' && old_filename[c] <= 'Z') old_filename[c] += 32;
+        }
+        if (access(old_filename, F_OK) == 0 && rename(old_filename, filename) == 0) {
+            printf("Renamed %s to %s\n", old_filename, filename);
+        }
+    }
+}
+
+// Profile file of the calling thread's station
+void format_profile_filename(char* filename, size_t size, const char* base_filename, int player_index) {
+    format_station_profile_filename(filename, size, base_filename, player_index, station_index());
+}
+
+// Profile files are rewritten through a temporary file that is then renamed over
+// them, so a reader (load_profile_stats, the pre-warm worker) sees the old or the
+// new contents but never a truncated file.
+static FILE* profile_file_begin(const char* filename, char* temp, size_t size) {
+    snprintf(temp, size, "%s.tmp", filename);
+    return fopen(temp, "w");
+}
+
+static int profile_file_commit(FILE* file, const char* temp, const char* filename) {
+    int ok = fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (ok && rename(temp, filename) == 0) return 0;
+    perror(filename);
+    remove(temp);
+    return -1;
 }
 
 float read_lowest_time(const char* filename) {
@@ -393,8 +1451,10 @@ float read_lowest_time(const char* filename) {
 }
 
 void write_lowest_time(const char* filename, float new_score) {
-    FILE* file = fopen(filename, "w");
-    if (file) { fprintf(file, "%.2f", new_score); fclose(file); }
+    if (!persistence_enabled) return;
+    char temp[272];
+    FILE* file = profile_file_begin(filename, temp, sizeof(temp));
+    if (file) { fprintf(file, "%.2f", new_score); profile_file_commit(file, temp, filename); }
     else { perror("Failed to write to score.txt"); }
 }
 
@@ -407,8 +1467,10 @@ int read_total_wins(const char* filename) {
 }
 
 void write_total_wins(const char* filename, int wins) {
-    FILE* file = fopen(filename, "w");
-    if (file) { fprintf(file, "%d", wins); fclose(file); }
+    if (!persistence_enabled) return;
+    char temp[272];
+    FILE* file = profile_file_begin(filename, temp, sizeof(temp));
+    if (file) { fprintf(file, "%d", wins); profile_file_commit(file, temp, filename); }
     else { perror("Failed to write to wins.txt"); }
 }
 
@@ -427,14 +1489,17 @@ int read_dodge_high_score(const char* filename) {
 }
 
 void write_dodge_high_score(const char* filename, int score) {
-    FILE* file = fopen(filename, "w");
+    if (!persistence_enabled) return;
+    char temp[272];
+    FILE* file = profile_file_begin(filename, temp, sizeof(temp));
     if (!file) return;
     fprintf(file, "%d", score);
-    fclose(file);
+    profile_file_commit(file, temp, filename);
 }
 
 // --- Drawing Helper Functions ---
 void draw_gradient_background(SDL_Renderer* renderer, SDL_Color start_color, SDL_Color end_color) {
+    if (station->soft_raster_enabled) { soft_raster_gradient(start_color, end_color); return; }
     for (int i = 0; i < WINDOW_HEIGHT; ++i) {
         float ratio = (float)i / (float)WINDOW_HEIGHT;
         Uint8 r = start_color.r + (end_color.r - start_color.r) * ratio;
@@ -446,11 +1511,24 @@ void draw_gradient_background(SDL_Renderer* renderer, SDL_Color start_color, SDL
 }
 
 void draw_middle_grid(SDL_Renderer* renderer) {
-    int grid_size = 600;
+    int grid_size = MIDDLE_GRID_SIZE;
     int grid_x = (WINDOW_WIDTH - grid_size) / 2;
     int grid_y = (WINDOW_HEIGHT - grid_size) / 2;
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 150);
     int line_thickness = 4;
+    if (station->soft_raster_enabled) {
+        // Same pixels as the outlines below, as filled bands
+        SDL_Rect bands[] = {
+            {grid_x - line_thickness + 1, grid_y - line_thickness + 1, grid_size + 2 * line_thickness - 2, line_thickness},
+            {grid_x - line_thickness + 1, grid_y + grid_size - 1, grid_size + 2 * line_thickness - 2, line_thickness},
+            {grid_x - line_thickness + 1, grid_y + 1, line_thickness, grid_size - 2},
+            {grid_x + grid_size - 1, grid_y + 1, line_thickness, grid_size - 2},
+            {grid_x, grid_y + grid_size / 2 - line_thickness + 1, grid_size + 1, line_thickness},
+            {grid_x + grid_size / 2 - line_thickness + 1, grid_y, line_thickness, grid_size + 1},
+        };
+        for (int i = 0; i < (int)SDL_arraysize(bands); i++) render_fill_rect(renderer, &bands[i]);
+        return;
+    }
     for (int i = 0; i < line_thickness; ++i) {
         SDL_Rect outer_rect = {grid_x - i, grid_y - i, grid_size + 2 * i, grid_size + 2 * i};
         SDL_RenderDrawRect(renderer, &outer_rect);
@@ -460,6 +1538,7 @@ void draw_middle_grid(SDL_Renderer* renderer) {
 }
 
 void draw_filled_circle(SDL_Renderer* renderer, int x, int y, int radius) {
+    if (station->soft_raster_enabled) { soft_raster_circle(renderer, x, y, radius, 0); return; }
     for (int dy = -radius; dy <= radius; dy++) {
         int dx = sqrt(radius * radius - dy * dy);
         SDL_RenderDrawLine(renderer, x - dx, y + dy, x + dx, y + dy);
@@ -467,6 +1546,7 @@ void draw_filled_circle(SDL_Renderer* renderer, int x, int y, int radius) {
 }
 
 void draw_outlined_circle(SDL_Renderer* renderer, int x, int y, int radius, int thickness) {
+    if (station->soft_raster_enabled) { soft_raster_circle(renderer, x, y, radius, thickness); return; }
     int dx = radius;
     int dy = 0;
     int err = 0;
@@ -492,1101 +1572,5757 @@ void draw_outlined_circle(SDL_Renderer* renderer, int x, int y, int radius, int
     }
 }
 
-// A function to render text to the screen, centered within a given rectangle
-void draw_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color) {
-    SDL_Surface* textSurface = TTF_RenderText_Blended(font, text, color);
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        SDL_Rect textRect = {x, y, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-        SDL_DestroyTexture(textTexture);
-        SDL_FreeSurface(textSurface);
-    }
-}
+// --- Glyph Atlas & Text Runs ---
+// Text is decoded as UTF-8 and drawn glyph by glyph from a small set of fixed-size
+// atlas pages, so large character sets (the Shin Go face covers Japanese) only
+// cost a texture slot per glyph actually used. Glyphs are rasterised in white on
+// first use and tinted through vertex colours. When every page is full the least
+// recently drawn page is evicted and its glyphs are rasterised again on demand.
+// Laid-out strings ("runs") are cached separately so per-frame text skips
+// decoding, metrics and kerning.
+//
+// Glyph bitmaps are not rasterised by FreeType per font size. Each glyph is
+// rendered once at SDF_MASTER_SIZE into a process-wide signed distance field
+// atlas (8SSEDT), and every size is resampled from that field, which keeps
+// edges crisp at any scale. The renderer has no shaders to threshold the field
+// on the GPU, so the resampling happens on the CPU once per size; scaled and
+// pulsing text reuses the resident bitmaps through vertex transforms. Glyphs
+// that no longer fit the field atlas fall back to direct rasterisation.
 
-void draw_centered_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, int y, SDL_Color color) {
-    SDL_Surface* textSurface = TTF_RenderText_Blended_Wrapped(font, text, color, WINDOW_WIDTH - 200);
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        SDL_Rect textRect = {(WINDOW_WIDTH - textSurface->w) / 2, y, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-        SDL_DestroyTexture(textTexture);
-        SDL_FreeSurface(textSurface);
+typedef struct {
+    Uint32 codepoint;
+    SDL_Rect rect;    // Field location in sdf_atlas, including the SDF_SPREAD border
+    int x_offset;     // Master bitmap offset from the pen position
+} SdfGlyph;
+
+// Disk cache payload of the distance field atlas; SDF_ATLAS_SIZE squared bytes follow
+typedef struct {
+    int glyph_count;
+    int shelf_x, shelf_y, shelf_h;
+    SdfGlyph glyphs[SDF_MAX_GLYPHS];
+} SdfAtlasCache;
+
+typedef struct {
+    Sint16 dx, dy;    // Offset to the nearest seed pixel
+} SdfPoint;
+
+// Distance field atlas shared by every font size, built under shared_asset_lock
+Uint8* sdf_atlas = NULL;      // 128 on an outline, higher inside
+SdfGlyph sdf_glyphs[SDF_MAX_GLYPHS];
+int sdf_glyph_count = 0;
+int sdf_atlas_cached = -1;    // Glyphs the disk cache held (sdf_atlas then lives in its mapping), -1 if not loaded
+int sdf_shelf_x = 0, sdf_shelf_y = 0, sdf_shelf_h = 0;
+TTF_Font* sdf_master_font = NULL;
+
+// Per-page vertex batches filled while drawing runs
+static SDL_Vertex glyph_batch_vertices[GLYPH_MAX_PAGES][GLYPH_BATCH_QUADS * 4];
+static int glyph_batch_quads[GLYPH_MAX_PAGES];
+static int glyph_batch_indices[GLYPH_BATCH_QUADS * 6];
+
+// Decodes one UTF-8 sequence and advances *text past it. Malformed input yields U+FFFD.
+static Uint32 utf8_next(const char** text) {
+    const unsigned char* s = (const unsigned char*)*text;
+    Uint32 codepoint;
+    int length;
+    if (s[0] < 0x80) { codepoint = s[0]; length = 1; }
+    else if ((s[0] & 0xE0) == 0xC0) { codepoint = s[0] & 0x1F; length = 2; }
+    else if ((s[0] & 0xF0) == 0xE0) { codepoint = s[0] & 0x0F; length = 3; }
+    else if ((s[0] & 0xF8) == 0xF0) { codepoint = s[0] & 0x07; length = 4; }
+    else { *text += 1; return 0xFFFD; }
+    for (int i = 1; i < length; i++) {
+        if ((s[i] & 0xC0) != 0x80) { *text += i; return 0xFFFD; }
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
     }
+    *text += length;
+    return codepoint;
 }
 
-void draw_confetti(SDL_Renderer* renderer, ConfettiParticle particle) {
-    SDL_SetRenderDrawColor(renderer, particle.color.r, particle.color.g, particle.color.b, 255);
-    SDL_Rect rect = {roundf(particle.x), roundf(particle.y), 5, 5};
-    SDL_RenderFillRect(renderer, &rect);
+static unsigned glyph_hash_key(TTF_Font* font, Uint32 codepoint) {
+    uintptr_t key = (uintptr_t)font ^ ((uintptr_t)codepoint * 2654435761u);
+    return (unsigned)(key ^ (key >> 15)) & (GLYPH_HASH_SIZE - 1);
 }
 
-void init_confetti(float x, float y) {
-    SDL_Color colors[] = { {95, 215, 11, 255}, {114, 187, 255, 255}, {166, 255, 166, 255} };
-    for (int i = 0; i < NUM_CONFETTI; ++i) {
-        confetti[i].x = x;
-        confetti[i].y = y;
-        confetti[i].vx = (float)(rand() % (int)CONFETTI_SPREAD) - (CONFETTI_SPREAD / 2.0f);
-        confetti[i].vy = (float)(rand() % (int)CONFETTI_SPREAD) - (CONFETTI_SPREAD / 2.0f);
-        confetti[i].lifetime = CONFETTI_LIFETIME;
-        confetti[i].color = colors[rand() % (sizeof(colors) / sizeof(colors[0]))];
+// Forgets every glyph and page allocation. Page textures are kept for reuse.
+static void glyph_atlas_reset(void) {
+    soft_raster_flush(); // Pending glyph commands still point into the pages
+    memset(station->glyph_hash, 0, sizeof(station->glyph_hash));
+    station->glyph_entry_count = 0;
+    for (int i = 0; i < station->glyph_page_count; i++) {
+        station->glyph_pages[i].shelf_x = station->glyph_pages[i].shelf_y = station->glyph_pages[i].shelf_h = 0;
     }
 }
 
-void update_confetti(float delta_time) {
-    for (int i = 0; i < NUM_CONFETTI; ++i) {
-        if (confetti[i].lifetime > 0) {
-            confetti[i].x += confetti[i].vx * delta_time;
-            confetti[i].y += confetti[i].vy * delta_time;
-            confetti[i].vy += CONFETTI_GRAVITY * delta_time;
-            confetti[i].lifetime -= delta_time;
-        }
+static GlyphEntry* glyph_find(TTF_Font* font, Uint32 codepoint) {
+    for (int i = station->glyph_hash[glyph_hash_key(font, codepoint)]; i; i = station->glyph_entries[i - 1].next) {
+        GlyphEntry* entry = &station->glyph_entries[i - 1];
+        if (entry->font == font && entry->codepoint == codepoint) return entry;
     }
+    return NULL;
 }
 
-// MODIFIED: A function to draw a thick line between two points using SDL_RenderGeometry with SDL_Vertex
-void draw_thick_line(SDL_Renderer* renderer, float x1, float y1, float x2, float y2, int thickness, SDL_Color color) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    float len = hypot(dx, dy);
-    if (len == 0) return; // Avoid division by zero
-
-    float nx = -dy / len; // Normal vector x
-    float ny = dx / len;  // Normal vector y
-
-    // Calculate half-thickness offsets
-    float offset_x = nx * thickness / 2.0f;
-    float offset_y = ny * thickness / 2.0f;
-
-    SDL_Vertex vertices[4];
-
-    // Define vertices for a rectangle
-    vertices[0].position.x = x1 - offset_x;
-    vertices[0].position.y = y1 - offset_y;
-    vertices[0].color = color;
-    vertices[0].tex_coord.x = 0; vertices[0].tex_coord.y = 0;
-
-    vertices[1].position.x = x1 + offset_x;
-    vertices[1].position.y = y1 + offset_y;
-    vertices[1].color = color;
-    vertices[1].tex_coord.x = 0; vertices[1].tex_coord.y = 0;
-
-    vertices[2].position.x = x2 + offset_x;
-    vertices[2].position.y = y2 + offset_y;
-    vertices[2].color = color;
-    vertices[2].tex_coord.x = 0; vertices[2].tex_coord.y = 0;
-
-    vertices[3].position.x = x2 - offset_x;
-    vertices[3].position.y = y2 - offset_y;
-    vertices[3].color = color;
-    vertices[3].tex_coord.x = 0; vertices[3].tex_coord.y = 0;
-    
-    // Define indices for the two triangles forming the rectangle (0,1,2 and 0,2,3)
-    int indices[6] = {0, 1, 2, 0, 2, 3};
+// Returns the metrics entry for a glyph, creating it (without rasterising) if needed.
+static GlyphEntry* glyph_lookup(TTF_Font* font, Uint32 codepoint) {
+    GlyphEntry* entry = glyph_find(font, codepoint);
+    if (entry) return entry;
+    if (station->glyph_entry_count == GLYPH_MAX_ENTRIES) glyph_atlas_reset();
+
+    unsigned bucket = glyph_hash_key(font, codepoint);
+    entry = &station->glyph_entries[station->glyph_entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->font = font;
+    entry->codepoint = codepoint;
+    entry->page = -1;
+    int minx, maxx, miny, maxy, advance;
+    if (TTF_GlyphMetrics32(font, codepoint, &minx, &maxx, &miny, &maxy, &advance) == 0) {
+        entry->x_offset = minx < 0 ? minx : 0;
+        entry->advance = advance;
+        entry->blank = (maxx <= minx);
+    } else {
+        entry->blank = 1;
+    }
+    entry->next = station->glyph_hash[bucket];
+    station->glyph_hash[bucket] = station->glyph_entry_count;
+    return entry;
+}
 
-    SDL_RenderGeometry(renderer, NULL, vertices, 4, indices, 6);
+static int glyph_page_alloc(GlyphPage* page, int w, int h, SDL_Rect* rect) {
+    if (page->shelf_x + w > GLYPH_PAGE_SIZE) {
+        page->shelf_y += page->shelf_h;
+        page->shelf_x = 0;
+        page->shelf_h = 0;
+    }
+    if (page->shelf_y + h > GLYPH_PAGE_SIZE) return -1;
+    rect->x = page->shelf_x;
+    rect->y = page->shelf_y;
+    rect->w = w;
+    rect->h = h;
+    page->shelf_x += w;
+    if (h > page->shelf_h) page->shelf_h = h;
+    return 0;
 }
 
+// Finds room for a w x h bitmap, adding a page or evicting the least recently used one.
+static int glyph_atlas_alloc(SDL_Renderer* renderer, int w, int h, SDL_Rect* rect) {
+    if (w > GLYPH_PAGE_SIZE || h > GLYPH_PAGE_SIZE) return -1;
+    for (int i = 0; i < station->glyph_page_count; i++) {
+        if (glyph_page_alloc(&station->glyph_pages[i], w, h, rect) == 0) return i;
+    }
 
-void draw_hold_timer_bar(SDL_Renderer* renderer, int x, int y, int width, int height, float progress) {
-    SDL_Rect bg_rect = {x, y, width, height};
-    SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);
-    SDL_RenderFillRect(renderer, &bg_rect);
+    int page_index;
+    if (station->glyph_page_count < GLYPH_MAX_PAGES) {
+        SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE);
+        if (!texture) {
+            fprintf(stderr, "Failed to create glyph atlas page: %s\n", SDL_GetError());
+            return -1;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        page_index = station->glyph_page_count++;
+        station->glyph_pages[page_index].texture = texture;
+    } else {
+        page_index = 0;
+        for (int i = 1; i < station->glyph_page_count; i++) {
+            if (station->glyph_pages[i].last_used < station->glyph_pages[page_index].last_used) page_index = i;
+        }
+        soft_raster_flush();
+        for (int i = 0; i < station->glyph_entry_count; i++) {
+            if (station->glyph_entries[i].page == page_index) station->glyph_entries[i].page = -1;
+        }
+    }
+    GlyphPage* page = &station->glyph_pages[page_index];
+    page->shelf_x = page->shelf_y = page->shelf_h = 0;
+    page->last_used = station->text_cache_clock;
+    return glyph_page_alloc(page, w, h, rect) == 0 ? page_index : -1;
+}
 
-    int filled_width = (int)(width * progress);
-    SDL_Rect fill_rect = {x, y, filled_width, height};
-    
-    // Interpolate color from red to green based on progress
-    int r = (int)(255 * (1.0f - progress));
-    int g = (int)(255 * progress);
-    SDL_SetRenderDrawColor(renderer, r, g, 0, 255);
-    SDL_RenderFillRect(renderer, &fill_rect);
+static inline int sdf_distance_sq(SdfPoint p) {
+    return p.dx * p.dx + p.dy * p.dy;
 }
 
-// MODIFIED: This function now draws a solid, thick, fading line.
-void draw_line_trail(SDL_Renderer* renderer) {
-    SDL_Color trail_color = {TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255}; 
+static inline void sdf_compare(const SdfPoint* grid, int w, int h, SdfPoint* p, int x, int y, int ox, int oy) {
+    int nx = x + ox, ny = y + oy;
+    if (nx < 0 || ny < 0 || nx >= w || ny >= h) return;
+    SdfPoint other = grid[ny * w + nx];
+    other.dx += ox;
+    other.dy += oy;
+    if (sdf_distance_sq(other) < sdf_distance_sq(*p)) *p = other;
+}
 
-    // Ensure TRAIL_LENGTH is at least 2 to prevent division by zero and ensure at least one segment can be drawn
-    if (TRAIL_LENGTH < 2) {
-        return; 
+// 8-point sequential signed Euclidean distance transform: a forward and a
+// backward sweep propagate each pixel's nearest seed offset from its neighbours.
+static void sdf_sweep(SdfPoint* grid, int w, int h) {
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            SdfPoint p = grid[y * w + x];
+            sdf_compare(grid, w, h, &p, x, y, -1, 0);
+            sdf_compare(grid, w, h, &p, x, y, 0, -1);
+            sdf_compare(grid, w, h, &p, x, y, -1, -1);
+            sdf_compare(grid, w, h, &p, x, y, 1, -1);
+            grid[y * w + x] = p;
+        }
+        for (int x = w - 1; x >= 0; x--) {
+            SdfPoint p = grid[y * w + x];
+            sdf_compare(grid, w, h, &p, x, y, 1, 0);
+            grid[y * w + x] = p;
+        }
     }
-
-    // Iterate backwards from the newest point (trail_head - 1)
-    for (int i = 0; i < TRAIL_LENGTH - 1; ++i) {
-        // Calculate the indices for the current segment (newest to oldest)
-        int current_point_idx = (trail_head - 1 - i + TRAIL_LENGTH) % TRAIL_LENGTH;
-        int next_point_idx = (trail_head - 1 - (i + 1) + TRAIL_LENGTH) % TRAIL_LENGTH;
-
-        // Only draw if both points are valid (not at 0,0 default init)
-        // This break prevents drawing lines from the origin during initial frames
-        if ((trail_points[current_point_idx].x == 0 && trail_points[current_point_idx].y == 0) ||
-            (trail_points[next_point_idx].x == 0 && trail_points[next_point_idx].y == 0)) {
-            break; 
+    for (int y = h - 1; y >= 0; y--) {
+        for (int x = w - 1; x >= 0; x--) {
+            SdfPoint p = grid[y * w + x];
+            sdf_compare(grid, w, h, &p, x, y, 1, 0);
+            sdf_compare(grid, w, h, &p, x, y, 0, 1);
+            sdf_compare(grid, w, h, &p, x, y, -1, 1);
+            sdf_compare(grid, w, h, &p, x, y, 1, 1);
+            grid[y * w + x] = p;
         }
+        for (int x = 0; x < w; x++) {
+            SdfPoint p = grid[y * w + x];
+            sdf_compare(grid, w, h, &p, x, y, -1, 0);
+            grid[y * w + x] = p;
+        }
+    }
+}
 
-        float alpha_ratio = 1.0f - ((float)i / (TRAIL_LENGTH - 1)); // Fade out from full alpha to 0
-        Uint8 alpha = (Uint8)(255 * alpha_ratio);
-        
-        SDL_Color current_trail_color = trail_color;
-        current_trail_color.a = alpha;
+// Disk cache key of the atlas: the font file and every constant the fields depend on
+static int sdf_atlas_key(Uint64* key) {
+    int parameters[3] = {SDF_MASTER_SIZE, SDF_SPREAD, SDF_ATLAS_SIZE};
+    if (asset_source_key(FONT_FILE, key) != 0) return -1;
+    *key = fnv1a64(parameters, sizeof(parameters), *key);
+    return 0;
+}
 
-        draw_thick_line(renderer, 
-                        trail_points[current_point_idx].x, trail_points[current_point_idx].y,
-                        trail_points[next_point_idx].x, trail_points[next_point_idx].y,
-                        TRAIL_THICKNESS, current_trail_color);
+// Opens the master font and maps the atlas left by earlier runs, or starts an
+// empty one. New glyphs are packed into the copy-on-write mapping in place.
+static void sdf_atlas_load(void) {
+    if (!sdf_master_font) sdf_master_font = open_shared_font(SDF_MASTER_SIZE);
+    if (!sdf_master_font) return;
+    Uint64 key;
+    size_t size = 0;
+    SdfAtlasCache* cached = sdf_atlas_key(&key) == 0 ? render_cache_map('d', key, &size) : NULL;
+    if (cached && size == sizeof(*cached) + (size_t)SDF_ATLAS_SIZE * SDF_ATLAS_SIZE &&
+        cached->glyph_count >= 0 && cached->glyph_count <= SDF_MAX_GLYPHS) {
+        memcpy(sdf_glyphs, cached->glyphs, sizeof(SdfGlyph) * cached->glyph_count);
+        sdf_glyph_count = sdf_atlas_cached = cached->glyph_count;
+        sdf_shelf_x = cached->shelf_x;
+        sdf_shelf_y = cached->shelf_y;
+        sdf_shelf_h = cached->shelf_h;
+        sdf_atlas = (Uint8*)(cached + 1);
+    } else {
+        sdf_atlas = calloc((size_t)SDF_ATLAS_SIZE * SDF_ATLAS_SIZE, 1);
     }
 }
 
-/**
+// Returns the master field for a glyph, building it on first use. NULL if the
+// glyph can't be rendered or the atlas is full. Caller holds shared_asset_lock.
+static const SdfGlyph* sdf_glyph(Uint32 codepoint) {
+    if (!sdf_atlas) sdf_atlas_load();
+    if (!sdf_master_font || !sdf_atlas) return NULL;
+    for (int i = 0; i < sdf_glyph_count; i++) {
+        if (sdf_glyphs[i].codepoint == codepoint) return &sdf_glyphs[i];
+    }
+    if (sdf_glyph_count == SDF_MAX_GLYPHS) return NULL;
+
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* rendered = TTF_RenderGlyph32_Blended(sdf_master_font, codepoint, white);
+    if (!rendered) return NULL;
+    SDL_Surface* surface = rendered->format->format == SDL_PIXELFORMAT_ARGB8888 ? rendered
+                         : SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+    int w = surface ? surface->w + SDF_SPREAD * 2 : 0;
+    int h = surface ? surface->h + SDF_SPREAD * 2 : 0;
+
+    // Shelf-pack the bordered field
+    if (sdf_shelf_x + w > SDF_ATLAS_SIZE) {
+        sdf_shelf_y += sdf_shelf_h;
+        sdf_shelf_x = 0;
+        sdf_shelf_h = 0;
+    }
+    SdfPoint* inside = NULL;
+    SdfPoint* outside = NULL;
+    if (surface && w <= SDF_ATLAS_SIZE && sdf_shelf_y + h <= SDF_ATLAS_SIZE) {
+        inside = malloc(sizeof(SdfPoint) * w * h);
+        outside = malloc(sizeof(SdfPoint) * w * h);
+    }
+    SdfGlyph* glyph = NULL;
+    if (inside && outside) {
+        // Seed each grid with the pixels on one side of the outline
+        const SdfPoint seed = {0, 0}, far = {9999, 9999};
+        SDL_LockSurface(surface);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                int sx = x - SDF_SPREAD, sy = y - SDF_SPREAD;
+                int covered = sx >= 0 && sy >= 0 && sx < surface->w && sy < surface->h &&
+                              (((const Uint32*)((const Uint8*)surface->pixels + (size_t)sy * surface->pitch))[sx] >> 24) >= 128;
+                inside[y * w + x] = covered ? seed : far;
+                outside[y * w + x] = covered ? far : seed;
+            }
+        }
+        SDL_UnlockSurface(surface);
+        sdf_sweep(inside, w, h);
+        sdf_sweep(outside, w, h);
+
+        glyph = &sdf_glyphs[sdf_glyph_count++];
+        glyph->codepoint = codepoint;
+        glyph->rect = (SDL_Rect){sdf_shelf_x, sdf_shelf_y, w, h};
+        int minx, maxx, miny, maxy, advance;
+        glyph->x_offset = (TTF_GlyphMetrics32(sdf_master_font, codepoint, &minx, &maxx, &miny, &maxy, &advance) == 0 && minx < 0) ? minx : 0;
+        for (int y = 0; y < h; y++) {
+            Uint8* row = sdf_atlas + (size_t)(sdf_shelf_y + y) * SDF_ATLAS_SIZE + sdf_shelf_x;
+            for (int x = 0; x < w; x++) {
+                // Positive inside the glyph
+                float distance = sqrtf((float)sdf_distance_sq(outside[y * w + x])) - sqrtf((float)sdf_distance_sq(inside[y * w + x]));
+                float value = 128.0f + distance * (127.0f / SDF_SPREAD);
+                row[x] = (Uint8)(value < 0.0f ? 0 : (value > 255.0f ? 255 : value));
+            }
+        }
+        sdf_shelf_x += w;
+        if (h > sdf_shelf_h) sdf_shelf_h = h;
+    }
+    free(inside);
+    free(outside);
+    if (surface && surface != rendered) SDL_FreeSurface(surface);
+    SDL_FreeSurface(rendered);
+    return glyph;
+}
+
+static float sdf_sample(const SdfGlyph* glyph, float x, float y) {
+    x = x < 0.0f ? 0.0f : (x > glyph->rect.w - 1 ? glyph->rect.w - 1 : x);
+    y = y < 0.0f ? 0.0f : (y > glyph->rect.h - 1 ? glyph->rect.h - 1 : y);
+    int x0 = (int)x, y0 = (int)y;
+    int x1 = x0 + 1 < glyph->rect.w ? x0 + 1 : x0;
+    int y1 = y0 + 1 < glyph->rect.h ? y0 + 1 : y0;
+    float fx = x - x0, fy = y - y0;
+    const Uint8* row0 = sdf_atlas + (size_t)(glyph->rect.y + y0) * SDF_ATLAS_SIZE + glyph->rect.x;
+    const Uint8* row1 = sdf_atlas + (size_t)(glyph->rect.y + y1) * SDF_ATLAS_SIZE + glyph->rect.x;
+    float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+/**
+ * @brief Renders a glyph for `font` by resampling its master distance field.
+ * @return White ARGB8888 pixels with coverage in alpha (caller frees), or NULL
+ * if the glyph has no field and must be rasterised directly.
+ */
+static Uint32* sdf_render_glyph(TTF_Font* font, Uint32 codepoint, int* w_out, int* h_out, int* x_offset_out) {
+    Uint32* pixels = NULL;
+    SDL_LockMutex(shared_asset_lock);
+    const SdfGlyph* glyph = sdf_glyph(codepoint);
+    if (glyph) {
+        float scale = (float)TTF_FontHeight(font) / TTF_FontHeight(sdf_master_font);
+        int w = SDL_max(1, (int)ceilf((glyph->rect.w - SDF_SPREAD * 2) * scale));
+        int h = SDL_max(1, (int)ceilf((glyph->rect.h - SDF_SPREAD * 2) * scale));
+        float field_to_pixels = scale * SDF_SPREAD / 127.0f;
+        pixels = malloc(sizeof(Uint32) * w * h);
+        for (int y = 0; pixels && y < h; y++) {
+            float field_y = (y + 0.5f) / scale - 0.5f + SDF_SPREAD;
+            for (int x = 0; x < w; x++) {
+                float field_x = (x + 0.5f) / scale - 0.5f + SDF_SPREAD;
+                // One output pixel of antialiasing around the outline
+                float coverage = 0.5f + (sdf_sample(glyph, field_x, field_y) - 128.0f) * field_to_pixels;
+                coverage = coverage < 0.0f ? 0.0f : (coverage > 1.0f ? 1.0f : coverage);
+                pixels[y * w + x] = ((Uint32)(coverage * 255.0f + 0.5f) << 24) | 0x00FFFFFF;
+            }
+        }
+        *w_out = w;
+        *h_out = h;
+        *x_offset_out = (int)lroundf(glyph->x_offset * scale);
+    }
+    SDL_UnlockMutex(shared_asset_lock);
+    return pixels;
+}
+
+void cleanup_sdf_atlas(void) {
+    // Keep the fields built this run for the next start
+    Uint64 key;
+    if (sdf_atlas && sdf_glyph_count > SDL_max(sdf_atlas_cached, 0) && sdf_atlas_key(&key) == 0) {
+        SdfAtlasCache table = {sdf_glyph_count, sdf_shelf_x, sdf_shelf_y, sdf_shelf_h, {{0}}};
+        memcpy(table.glyphs, sdf_glyphs, sizeof(SdfGlyph) * sdf_glyph_count);
+        const void* parts[2] = {&table, sdf_atlas};
+        size_t sizes[2] = {sizeof(table), (size_t)SDF_ATLAS_SIZE * SDF_ATLAS_SIZE};
+        render_cache_store('d', key, parts, sizes, 2);
+    }
+    if (sdf_atlas_cached < 0) free(sdf_atlas); // Otherwise it is unmapped with the render cache
+    sdf_atlas = NULL;
+    sdf_atlas_cached = -1;
+    sdf_glyph_count = 0;
+    sdf_shelf_x = sdf_shelf_y = sdf_shelf_h = 0;
+    close_shared_font(sdf_master_font);
+    sdf_master_font = NULL;
+}
+
+// Rasterises a glyph into the atlas if it is not resident. Returns 0 if it can be drawn.
+static int glyph_make_resident(SDL_Renderer* renderer, GlyphEntry* entry) {
+    if (entry->blank) return -1;
+    if (entry->page >= 0) return 0;
+
+    int w, h, x_offset = entry->x_offset;
+    SDL_Surface* rendered = NULL;
+    SDL_Surface* surface = NULL;
+    const Uint8* source;
+    int source_pitch;
+    Uint32* field_pixels = sdf_render_glyph(entry->font, entry->codepoint, &w, &h, &x_offset);
+    if (field_pixels) {
+        source = (const Uint8*)field_pixels;
+        source_pitch = w * sizeof(Uint32);
+    } else {
+        SDL_Color white = {255, 255, 255, 255};
+        rendered = TTF_RenderGlyph32_Blended(entry->font, entry->codepoint, white);
+        if (!rendered) { entry->blank = 1; return -1; }
+        surface = rendered->format->format == SDL_PIXELFORMAT_ARGB8888 ? rendered
+                : SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (!surface) { SDL_FreeSurface(rendered); entry->blank = 1; return -1; }
+        SDL_LockSurface(surface);
+        source = surface->pixels;
+        source_pitch = surface->pitch;
+        w = surface->w;
+        h = surface->h;
+    }
+
+    int padded_w = w + GLYPH_PADDING * 2;
+    int padded_h = h + GLYPH_PADDING * 2;
+    SDL_Rect slot;
+    int page = glyph_atlas_alloc(renderer, padded_w, padded_h, &slot);
+    Uint32* pixels = page >= 0 ? calloc((size_t)padded_w * padded_h, sizeof(Uint32)) : NULL;
+    if (pixels) {
+        // Upload with a cleared border so stale neighbours never bleed in
+        for (int row = 0; row < h; row++) {
+            memcpy(pixels + (size_t)(row + GLYPH_PADDING) * padded_w + GLYPH_PADDING,
+                   source + (size_t)row * source_pitch, (size_t)w * sizeof(Uint32));
+        }
+        SDL_UpdateTexture(station->glyph_pages[page].texture, &slot, pixels, padded_w * sizeof(Uint32));
+        soft_raster_store_glyph(page, &slot, pixels, padded_w);
+        free(pixels);
+        entry->page = page;
+        entry->rect = (SDL_Rect){slot.x + GLYPH_PADDING, slot.y + GLYPH_PADDING, w, h};
+        entry->x_offset = x_offset;
+    } else {
+        entry->blank = 1;
+    }
+    free(field_pixels);
+    if (surface) SDL_UnlockSurface(surface);
+    if (surface && surface != rendered) SDL_FreeSurface(surface);
+    if (rendered) SDL_FreeSurface(rendered);
+    return entry->page >= 0 ? 0 : -1;
+}
+
+// Moves a run glyph that overflowed the wrap width, and the rest of its word, onto a new line.
+static int wrap_run_line(RunGlyph* glyphs, int count, int break_index, int line_y) {
+    int shift = glyphs[break_index].x;
+    for (int i = break_index; i < count; i++) {
+        glyphs[i].x -= shift;
+        glyphs[i].y = line_y;
+    }
+    return shift;
+}
+
+// Lays out a UTF-8 string, wrapping at spaces when wrap_width is set.
+static int layout_text_run(TextRun* run) {
+    // A codepoint takes at least one byte, so this always fits the whole string
+    RunGlyph* glyphs = malloc(sizeof(RunGlyph) * (strlen(run->text) + 1));
+    if (!glyphs) return -1;
+    int count = 0;
+    int line_skip = TTF_FontLineSkip(run->font);
+    int pen_x = 0, pen_y = 0, width = 0;
+    int line_start = 0, break_index = -1;
+    Uint32 previous = 0;
+
+    const char* cursor = run->text;
+    while (*cursor) {
+        Uint32 codepoint = utf8_next(&cursor);
+        if (codepoint == '\n') {
+            if (pen_x > width) width = pen_x;
+            pen_x = 0;
+            pen_y += line_skip;
+            line_start = count;
+            break_index = -1;
+            previous = 0;
+            continue;
+        }
+        if (codepoint < 0x20) continue;
+
+        // Only the advance is kept: a later lookup may reset the atlas and reuse the entry
+        int advance = glyph_lookup(run->font, codepoint)->advance;
+        if (previous) pen_x += TTF_GetFontKerningSizeGlyphs32(run->font, previous, codepoint);
+        previous = codepoint;
+        if (codepoint == ' ') {
+            break_index = count + 1; // A wrap moves everything after the space
+        } else if (run->wrap_width > 0 && pen_x + advance > run->wrap_width && count > line_start) {
+            // Break after the last space on this line, or mid-word (CJK text has no spaces)
+            int index = (break_index > line_start && break_index < count) ? break_index : count;
+            int line_width = glyphs[index - 1].x + glyph_lookup(run->font, glyphs[index - 1].codepoint)->advance;
+            if (line_width > width) width = line_width;
+            pen_y += line_skip;
+            if (index < count) pen_x -= wrap_run_line(glyphs, count, index, pen_y);
+            else pen_x = 0;
+            line_start = index;
+            break_index = -1;
+        }
+        glyphs[count].codepoint = codepoint;
+        glyphs[count].x = (Sint16)pen_x;
+        glyphs[count].y = (Sint16)pen_y;
+        count++;
+        pen_x += advance;
+    }
+    if (pen_x > width) width = pen_x;
+
+    run->glyphs = glyphs;
+    run->glyph_count = count;
+    run->w = width;
+    run->h = pen_y + TTF_FontHeight(run->font);
+    return 0;
+}
+
+static TextRun* find_text_run(TTF_Font* font, const char* text, int wrap_width) {
+    for (int i = 0; i < station->text_run_count; i++) {
+        if (station->text_runs[i].font == font && station->text_runs[i].wrap_width == wrap_width && strcmp(station->text_runs[i].text, text) == 0) {
+            return &station->text_runs[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns the cached layout for a string, laying it out on a miss.
+TextRun* get_text_run(TTF_Font* font, const char* text, int wrap_width) {
+    if (!font || !text || !text[0]) return NULL;
+    TextRun* run = find_text_run(font, text, wrap_width);
+    if (run) {
+        run->last_used = ++station->text_cache_clock;
+        return run;
+    }
+
+    // Create new entry, or recycle the least recently used one
+    if (station->text_run_count < MAX_TEXT_RUNS) {
+        run = &station->text_runs[station->text_run_count++];
+    } else {
+        run = &station->text_runs[0];
+        for (int i = 1; i < MAX_TEXT_RUNS; i++) {
+            if (station->text_runs[i].last_used < run->last_used) run = &station->text_runs[i];
+        }
+        free(run->text);
+        free(run->glyphs);
+    }
+    memset(run, 0, sizeof(*run));
+    run->font = font;
+    run->wrap_width = wrap_width;
+    run->text = strdup(text);
+    if (!run->text || layout_text_run(run) != 0) {
+        free(run->text);
+        run->text = strdup("");
+        run->glyph_count = 0;
+        return NULL;
+    }
+    run->last_used = ++station->text_cache_clock;
+    return run;
+}
+
+// Same contract as TTF_SizeUTF8, answered from the run cache.
+int text_size(TTF_Font* font, const char* text, int* w, int* h) {
+    TextRun* run = get_text_run(font, text, 0);
+    if (w) *w = run ? run->w : 0;
+    if (h) *h = run ? run->h : (font ? TTF_FontHeight(font) : 0);
+    return run ? 0 : -1;
+}
+
+// Rasterises every glyph of a run without drawing it. Returns the number of new glyphs.
+int warm_text_run(SDL_Renderer* renderer, TextRun* run) {
+    int rasterised = 0;
+    for (int i = 0; i < run->glyph_count; i++) {
+        GlyphEntry* entry = glyph_lookup(run->font, run->glyphs[i].codepoint);
+        if (entry->page < 0 && !entry->blank && glyph_make_resident(renderer, entry) == 0) rasterised++;
+    }
+    return rasterised;
+}
+
+static void flush_glyph_batches(SDL_Renderer* renderer) {
+    if (glyph_batch_indices[1] == 0) {
+        for (int q = 0; q < GLYPH_BATCH_QUADS; q++) {
+            int* idx = &glyph_batch_indices[q * 6];
+            idx[0] = q * 4; idx[1] = q * 4 + 1; idx[2] = q * 4 + 2;
+            idx[3] = q * 4; idx[4] = q * 4 + 2; idx[5] = q * 4 + 3;
+        }
+    }
+    for (int page = 0; page < station->glyph_page_count; page++) {
+        if (glyph_batch_quads[page] == 0) continue;
+        SDL_RenderGeometry(renderer, station->glyph_pages[page].texture, glyph_batch_vertices[page], glyph_batch_quads[page] * 4,
+                           glyph_batch_indices, glyph_batch_quads[page] * 6);
+        glyph_batch_quads[page] = 0;
+    }
+}
+
+// Draws a run with its top-left corner at (x, y), scaled by `scale` through the vertices.
+static void draw_text_run(SDL_Renderer* renderer, TextRun* run, float x, float y, float scale, SDL_Color color) {
+    for (int i = 0; i < run->glyph_count; i++) {
+        const RunGlyph* glyph = &run->glyphs[i];
+        GlyphEntry* entry = glyph_find(run->font, glyph->codepoint);
+        if (entry && entry->blank) continue; // Spaces never get a page; don't break the batch for them
+        if (!entry || entry->page < 0) {
+            // A new entry may reset the atlas and rasterising may evict a page, so draw what is queued first
+            flush_glyph_batches(renderer);
+            entry = glyph_lookup(run->font, glyph->codepoint);
+            if (entry->blank || glyph_make_resident(renderer, entry) != 0) continue;
+        }
+        if (station->soft_raster_enabled) {
+            // The software path draws glyphs unscaled at their scaled positions
+            soft_raster_glyph(entry->page, &entry->rect, (int)(x + (glyph->x + entry->x_offset) * scale), (int)(y + glyph->y * scale), color);
+            continue;
+        }
+        if (glyph_batch_quads[entry->page] == GLYPH_BATCH_QUADS) flush_glyph_batches(renderer);
+
+        GlyphPage* page = &station->glyph_pages[entry->page];
+        page->last_used = station->text_cache_clock;
+        float x0 = x + (glyph->x + entry->x_offset) * scale, y0 = y + glyph->y * scale;
+        float x1 = x0 + entry->rect.w * scale, y1 = y0 + entry->rect.h * scale;
+        float u0 = (float)entry->rect.x / GLYPH_PAGE_SIZE, v0 = (float)entry->rect.y / GLYPH_PAGE_SIZE;
+        float u1 = (float)(entry->rect.x + entry->rect.w) / GLYPH_PAGE_SIZE, v1 = (float)(entry->rect.y + entry->rect.h) / GLYPH_PAGE_SIZE;
+
+        SDL_Vertex* v = &glyph_batch_vertices[entry->page][glyph_batch_quads[entry->page]++ * 4];
+        v[0] = (SDL_Vertex){{x0, y0}, color, {u0, v0}};
+        v[1] = (SDL_Vertex){{x1, y0}, color, {u1, v0}};
+        v[2] = (SDL_Vertex){{x1, y1}, color, {u1, v1}};
+        v[3] = (SDL_Vertex){{x0, y1}, color, {u0, v1}};
+    }
+    flush_glyph_batches(renderer);
+}
+
+void cleanup_text_cache() {
+    for (int i = 0; i < station->text_run_count; i++) {
+        free(station->text_runs[i].text);
+        free(station->text_runs[i].glyphs);
+    }
+    station->text_run_count = 0;
+    for (int i = 0; i < station->glyph_page_count; i++) {
+        SDL_DestroyTexture(station->glyph_pages[i].texture);
+    }
+    station->glyph_page_count = 0;
+    glyph_atlas_reset();
+}
+
+// A function to render UTF-8 text to the screen at the given top-left position
+void draw_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color) {
+    TextRun* run = get_text_run(font, text, 0);
+    if (run) draw_text_run(renderer, run, x, y, 1.0f, color);
+}
+
+void draw_centered_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, int y, SDL_Color color) {
+    TextRun* run = get_text_run(font, text, WINDOW_WIDTH - 200);
+    if (run) draw_text_run(renderer, run, (WINDOW_WIDTH - run->w) / 2, y, 1.0f, color);
+}
+
+// Draws text scaled about its centre; pulses and zooms cost no rasterisation.
+void draw_text_scaled(SDL_Renderer* renderer, TTF_Font* font, const char* text, int center_x, int center_y, float scale, SDL_Color color) {
+    TextRun* run = get_text_run(font, text, 0);
+    if (run) draw_text_run(renderer, run, center_x - run->w * scale / 2.0f, center_y - run->h * scale / 2.0f, scale, color);
+}
+
+// --- Software Raster Fallback ---
+// On units that only get SDL's software renderer, SDL draws every scanline,
+// circle point and trail quad on the main thread. Instead, the drawing helpers
+// record commands here and the whole frame is rasterised into one ARGB
+// framebuffer, split into tiles that the main thread and a small worker pool
+// claim through an atomic counter. Spans are filled/blended with SSE2 or NEON.
+// The finished frame is uploaded to a streaming texture once, right before
+// present. Glyphs are drawn from CPU copies of the atlas pages, so text shares
+// the single upload too.
+
+// Writes count pixels of an opaque colour.
+static void soft_fill_span(Uint32* dst, int count, Uint32 color) {
+    int i = 0;
+#if defined(__SSE2__)
+    __m128i value = _mm_set1_epi32((int)color);
+    for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(dst + i), value);
+#elif defined(__ARM_NEON)
+    uint32x4_t value = vdupq_n_u32(color);
+    for (; i + 4 <= count; i += 4) vst1q_u32(dst + i, value);
+#endif
+    for (; i < count; i++) dst[i] = color;
+}
+
+// Blends a colour at the given alpha over count opaque pixels: (src * a + dst * (255 - a)) / 255.
+static void soft_blend_span(Uint32* dst, int count, Uint32 color, Uint8 alpha) {
+    int i = 0;
+    color |= 0xFF000000u;
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i inv_alpha = _mm_set1_epi16(255 - alpha);
+    __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero), _mm_set1_epi16(alpha));
+    __m128i bias = _mm_set1_epi16(128);
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((__m128i*)(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv_alpha), src), bias);
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv_alpha), src), bias);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    uint8x8_t inv_alpha = vdup_n_u8(255 - alpha);
+    uint16x8_t src = vaddq_u16(vmull_u8(vreinterpret_u8_u32(vdup_n_u32(color)), vdup_n_u8(alpha)), vdupq_n_u16(128));
+    for (; i + 2 <= count; i += 2) {
+        uint16x8_t t = vmlal_u8(src, vld1_u8((const uint8_t*)(dst + i)), inv_alpha);
+        vst1_u8((uint8_t*)(dst + i), vaddhn_u16(t, vshrq_n_u16(t, 8)));
+    }
+#endif
+    for (; i < count; i++) {
+        Uint32 d = dst[i], out = 0xFF000000u;
+        for (int shift = 0; shift < 24; shift += 8) {
+            unsigned t = ((color >> shift) & 0xFF) * alpha + ((d >> shift) & 0xFF) * (255 - alpha) + 128;
+            out |= ((t + (t >> 8)) >> 8) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+static void soft_span(Uint32* dst, int count, SDL_Color color) {
+    if (count <= 0 || color.a == 0) return;
+    Uint32 argb = 0xFF000000u | ((Uint32)color.r << 16) | ((Uint32)color.g << 8) | color.b;
+    if (color.a == 255) soft_fill_span(dst, count, argb);
+    else soft_blend_span(dst, count, argb, color.a);
+}
+
+// Blends one pixel with its own alpha (sprites and glyphs).
+static inline void soft_blend_pixel(Uint32* dst, Uint32 color, unsigned alpha) {
+    if (alpha == 0) return;
+    if (alpha >= 255) { *dst = color | 0xFF000000u; return; }
+    Uint32 d = *dst, out = 0xFF000000u;
+    for (int shift = 0; shift < 24; shift += 8) {
+        unsigned t = ((color >> shift) & 0xFF) * alpha + ((d >> shift) & 0xFF) * (255 - alpha) + 128;
+        out |= ((t + (t >> 8)) >> 8) << shift;
+    }
+    *dst = out;
+}
+
+// Rasterises one command clipped to a tile.
+static void soft_rasterise_command(SoftRaster* s, const SoftCommand* cmd, const SDL_Rect* clip) {
+    int x0 = clip->x, x1 = clip->x + clip->w; // [x0, x1)
+    for (int y = clip->y; y < clip->y + clip->h; y++) {
+        Uint32* row = s->pixels + (size_t)y * WINDOW_WIDTH;
+        int left = x0, right = x1; // Span for this row, [left, right)
+        switch (cmd->type) {
+            case SOFT_CMD_RECT:
+                soft_span(row + left, right - left, cmd->color);
+                break;
+            case SOFT_CMD_GRADIENT: {
+                // Same per-row colour as the scanline version in draw_gradient_background
+                float ratio = (float)y / (float)WINDOW_HEIGHT;
+                SDL_Color c = {cmd->color.r + (cmd->color2.r - cmd->color.r) * ratio,
+                               cmd->color.g + (cmd->color2.g - cmd->color.g) * ratio,
+                               cmd->color.b + (cmd->color2.b - cmd->color.b) * ratio, 255};
+                soft_span(row + left, right - left, c);
+                break;
+            }
+            case SOFT_CMD_CIRCLE:
+            case SOFT_CMD_RING: {
+                int dy = y - cmd->cy;
+                if (dy < -cmd->radius || dy > cmd->radius) break;
+                int outer = (int)sqrt(cmd->radius * cmd->radius - dy * dy);
+                int span_left = SDL_max(cmd->cx - outer, x0), span_right = SDL_min(cmd->cx + outer + 1, x1);
+                if (cmd->type == SOFT_CMD_RING && dy >= -cmd->inner_radius && dy <= cmd->inner_radius) {
+                    int inner = (int)sqrt(cmd->inner_radius * cmd->inner_radius - dy * dy);
+                    int hole_left = cmd->cx - inner, hole_right = cmd->cx + inner + 1;
+                    soft_span(row + span_left, SDL_min(hole_left, span_right) - span_left, cmd->color);
+                    int from = SDL_max(hole_right, span_left);
+                    soft_span(row + from, span_right - from, cmd->color);
+                } else {
+                    soft_span(row + span_left, span_right - span_left, cmd->color);
+                }
+                break;
+            }
+            case SOFT_CMD_QUAD: {
+                // Intersect the pixel-centre scanline with each edge of the convex quad
+                float yc = y + 0.5f, min_x = 1e9f, max_x = -1e9f;
+                for (int e = 0; e < 4; e++) {
+                    float ax = cmd->qx[e], ay = cmd->qy[e], bx = cmd->qx[(e + 1) % 4], by = cmd->qy[(e + 1) % 4];
+                    if ((ay <= yc && by > yc) || (by <= yc && ay > yc)) {
+                        float x = ax + (yc - ay) * (bx - ax) / (by - ay);
+                        if (x < min_x) min_x = x;
+                        if (x > max_x) max_x = x;
+                    }
+                }
+                if (min_x > max_x) break;
+                left = SDL_max((int)ceilf(min_x - 0.5f), x0);
+                right = SDL_min((int)floorf(max_x - 0.5f) + 1, x1);
+                soft_span(row + left, right - left, cmd->color);
+                break;
+            }
+            case SOFT_CMD_SPRITE: {
+                const SoftSprite* sprite = cmd->sprite;
+                int sy = cmd->src.y + (int)((Sint64)(y - cmd->cy) * cmd->src.h / cmd->inner_radius);
+                const Uint32* src_row = sprite->pixels + (size_t)sy * sprite->w + cmd->src.x;
+                for (int x = left; x < right; x++) {
+                    Uint32 pixel = src_row[(Sint64)(x - cmd->cx) * cmd->src.w / cmd->radius];
+                    soft_blend_pixel(&row[x], pixel, ((pixel >> 24) * cmd->color.a + 127) / 255);
+                }
+                break;
+            }
+            case SOFT_CMD_GLYPH: {
+                const Uint8* mask = s->glyph_masks[cmd->glyph_page];
+                if (!mask) break;
+                const Uint8* mask_row = mask + (size_t)(cmd->src.y + y - cmd->cy) * GLYPH_PAGE_SIZE + cmd->src.x - cmd->cx;
+                Uint32 argb = ((Uint32)cmd->color.r << 16) | ((Uint32)cmd->color.g << 8) | cmd->color.b;
+                for (int x = left; x < right; x++) {
+                    soft_blend_pixel(&row[x], argb, (mask_row[x] * cmd->color.a + 127) / 255);
+                }
+                break;
+            }
+        }
+    }
+}
+
+static void soft_rasterise_tile(SoftRaster* s, int tile) {
+    SDL_Rect tile_rect = {(tile % s->tiles_x) * SOFT_TILE_SIZE, (tile / s->tiles_x) * SOFT_TILE_SIZE, SOFT_TILE_SIZE, SOFT_TILE_SIZE};
+    tile_rect.w = SDL_min(tile_rect.w, WINDOW_WIDTH - tile_rect.x);
+    tile_rect.h = SDL_min(tile_rect.h, WINDOW_HEIGHT - tile_rect.y);
+    for (int i = 0; i < s->command_count; i++) {
+        SDL_Rect clip;
+        if (SDL_IntersectRect(&s->commands[i].bounds, &tile_rect, &clip)) {
+            soft_rasterise_command(s, &s->commands[i], &clip);
+        }
+    }
+}
+
+// Claims tiles until none are left. Runs on the main thread and every worker.
+static void soft_rasterise_tiles(SoftRaster* s) {
+    int tile_count = s->tiles_x * s->tiles_y;
+    int tile;
+    while ((tile = SDL_AtomicAdd(&s->next_tile, 1)) < tile_count) {
+        soft_rasterise_tile(s, tile);
+        if (SDL_AtomicAdd(&s->tiles_remaining, -1) == 1) {
+            SDL_LockMutex(s->mutex);
+            SDL_CondSignal(s->done_cond);
+            SDL_UnlockMutex(s->mutex);
+        }
+    }
+}
+
+// Workers get the raster by pointer.
+static int soft_worker(void* data) {
+    SoftRaster* s = data;
+    int seen = 0;
+    SDL_LockMutex(s->mutex);
+    for (;;) {
+        while (!s->quit && s->generation == seen) SDL_CondWait(s->start_cond, s->mutex);
+        if (s->quit) break;
+        seen = s->generation;
+        SDL_UnlockMutex(s->mutex);
+        soft_rasterise_tiles(s);
+        SDL_LockMutex(s->mutex);
+    }
+    SDL_UnlockMutex(s->mutex);
+    return 0;
+}
+
+/**
+ * @brief Switches drawing to the tiled software rasteriser.
+ * @return 0 on success, -1 if the framebuffer, its texture or the worker
+ *         synchronisation could not be created.
+ */
+int soft_raster_init(SDL_Renderer* renderer) {
+    memset(&station->soft, 0, sizeof(station->soft));
+    station->soft.pixels = aligned_alloc(16, (size_t)WINDOW_WIDTH * WINDOW_HEIGHT * sizeof(Uint32));
+    station->soft.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
+    station->soft.mutex = SDL_CreateMutex();
+    station->soft.start_cond = SDL_CreateCond();
+    station->soft.done_cond = SDL_CreateCond();
+    if (!station->soft.pixels || !station->soft.texture || !station->soft.mutex || !station->soft.start_cond || !station->soft.done_cond) {
+        fprintf(stderr, "Software raster fallback unavailable: %s\n", SDL_GetError());
+        free(station->soft.pixels);
+        if (station->soft.texture) SDL_DestroyTexture(station->soft.texture);
+        if (station->soft.mutex) SDL_DestroyMutex(station->soft.mutex);
+        if (station->soft.start_cond) SDL_DestroyCond(station->soft.start_cond);
+        if (station->soft.done_cond) SDL_DestroyCond(station->soft.done_cond);
+        memset(&station->soft, 0, sizeof(station->soft));
+        return -1;
+    }
+    SDL_SetTextureBlendMode(station->soft.texture, SDL_BLENDMODE_NONE);
+    station->soft.tiles_x = (WINDOW_WIDTH + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    station->soft.tiles_y = (WINDOW_HEIGHT + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+
+    // Spare cores: the main thread rasterises too, and with several stations each simulation thread has one.
+    // Stations are drawn one after another, so their pools never run at the same time.
+    int workers = SDL_min(SDL_GetCPUCount() - 1 - (station_count > 1 ? station_count : 0), SOFT_MAX_WORKERS);
+    for (int i = 0; i < workers; i++) {
+        station->soft.workers[station->soft.worker_count] = SDL_CreateThread(soft_worker, "soft_raster", &station->soft);
+        if (station->soft.workers[station->soft.worker_count]) station->soft.worker_count++;
+    }
+    station->soft_raster_enabled = 1;
+    printf("Software raster fallback enabled (%d worker threads, %dx%d tiles)\n", station->soft.worker_count, station->soft.tiles_x, station->soft.tiles_y);
+    return 0;
+}
+
+void soft_raster_shutdown(void) {
+    if (!station->soft_raster_enabled) return;
+    SDL_LockMutex(station->soft.mutex);
+    station->soft.quit = 1;
+    SDL_CondBroadcast(station->soft.start_cond);
+    SDL_UnlockMutex(station->soft.mutex);
+    for (int i = 0; i < station->soft.worker_count; i++) SDL_WaitThread(station->soft.workers[i], NULL);
+    SDL_DestroyCond(station->soft.start_cond);
+    SDL_DestroyCond(station->soft.done_cond);
+    SDL_DestroyMutex(station->soft.mutex);
+    for (int i = 0; i < station->soft.sprite_count; i++) free(station->soft.sprites[i].pixels);
+    for (int i = 0; i < GLYPH_MAX_PAGES; i++) free(station->soft.glyph_masks[i]);
+    if (station->soft.texture) SDL_DestroyTexture(station->soft.texture);
+    free(station->soft.pixels);
+    memset(&station->soft, 0, sizeof(station->soft));
+    station->soft_raster_enabled = 0;
+}
+
+// Rasterises all pending commands into the framebuffer, in parallel.
+void soft_raster_flush(void) {
+    if (!station->soft_raster_enabled || station->soft.command_count == 0) return;
+    SDL_AtomicSet(&station->soft.tiles_remaining, station->soft.tiles_x * station->soft.tiles_y);
+    SDL_AtomicSet(&station->soft.next_tile, 0);
+    SDL_LockMutex(station->soft.mutex);
+    station->soft.generation++;
+    SDL_CondBroadcast(station->soft.start_cond);
+    SDL_UnlockMutex(station->soft.mutex);
+
+    soft_rasterise_tiles(&station->soft);
+
+    SDL_LockMutex(station->soft.mutex);
+    while (SDL_AtomicGet(&station->soft.tiles_remaining) > 0) SDL_CondWait(station->soft.done_cond, station->soft.mutex);
+    SDL_UnlockMutex(station->soft.mutex);
+    station->soft.command_count = 0;
+}
+
+static SoftCommand* soft_push(SoftCommandType type, int x, int y, int w, int h) {
+    SDL_Rect screen = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_Rect bounds = {x, y, w, h};
+    if (!SDL_IntersectRect(&bounds, &screen, &bounds)) return NULL;
+    if (station->soft.command_count == SOFT_MAX_COMMANDS) soft_raster_flush();
+    SoftCommand* cmd = &station->soft.commands[station->soft.command_count++];
+    cmd->type = type;
+    cmd->bounds = bounds;
+    return cmd;
+}
+
+static SDL_Color soft_draw_color(SDL_Renderer* renderer) {
+    SDL_Color color;
+    SDL_GetRenderDrawColor(renderer, &color.r, &color.g, &color.b, &color.a);
+    return color;
+}
+
+// Starts a frame by clearing to the renderer's draw colour, like SDL_RenderClear.
+void soft_raster_begin_frame(SDL_Renderer* renderer) {
+    if (!station->soft_raster_enabled) return;
+    station->soft.command_count = 0;
+    SoftCommand* cmd = soft_push(SOFT_CMD_RECT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    cmd->color = soft_draw_color(renderer);
+    cmd->color.a = 255;
+}
+
+// Finishes the frame and uploads it in one go. Call right before SDL_RenderPresent.
+void soft_raster_present(SDL_Renderer* renderer) {
+    if (!station->soft_raster_enabled) return;
+    soft_raster_flush();
+    SDL_UpdateTexture(station->soft.texture, NULL, station->soft.pixels, WINDOW_WIDTH * sizeof(Uint32));
+    SDL_Rect dst = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_RenderCopy(renderer, station->soft.texture, NULL, &dst);
+}
+
+void soft_raster_rect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    SoftCommand* cmd = rect ? soft_push(SOFT_CMD_RECT, rect->x, rect->y, rect->w, rect->h)
+                            : soft_push(SOFT_CMD_RECT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (cmd) cmd->color = soft_draw_color(renderer);
+}
+
+void soft_raster_gradient(SDL_Color start_color, SDL_Color end_color) {
+    SoftCommand* cmd = soft_push(SOFT_CMD_GRADIENT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    cmd->color = start_color;
+    cmd->color2 = end_color;
+}
+
+// Filled circle, or a ring thickness pixels wide when thickness > 0.
+void soft_raster_circle(SDL_Renderer* renderer, int x, int y, int radius, int thickness) {
+    if (radius < 0) return;
+    SoftCommand* cmd = soft_push(thickness > 0 ? SOFT_CMD_RING : SOFT_CMD_CIRCLE, x - radius, y - radius, radius * 2 + 1, radius * 2 + 1);
+    if (!cmd) return;
+    cmd->color = soft_draw_color(renderer);
+    cmd->cx = x;
+    cmd->cy = y;
+    cmd->radius = radius;
+    cmd->inner_radius = radius - thickness;
+}
+
+void soft_raster_quad(const float* xs, const float* ys, SDL_Color color) {
+    float min_x = xs[0], max_x = xs[0], min_y = ys[0], max_y = ys[0];
+    for (int i = 1; i < 4; i++) {
+        min_x = fminf(min_x, xs[i]); max_x = fmaxf(max_x, xs[i]);
+        min_y = fminf(min_y, ys[i]); max_y = fmaxf(max_y, ys[i]);
+    }
+    SoftCommand* cmd = soft_push(SOFT_CMD_QUAD, (int)floorf(min_x), (int)floorf(min_y), (int)ceilf(max_x) - (int)floorf(min_x) + 1, (int)ceilf(max_y) - (int)floorf(min_y) + 1);
+    if (!cmd) return;
+    cmd->color = color;
+    memcpy(cmd->qx, xs, sizeof(cmd->qx));
+    memcpy(cmd->qy, ys, sizeof(cmd->qy));
+}
+
+// Keeps a CPU copy of a texture's image so its sprites can be drawn in software.
+void soft_raster_register_sprite(SDL_Texture* texture, SDL_Surface* surface) {
+    if (!station->soft_raster_enabled || station->soft.sprite_count == SOFT_MAX_SPRITES) return;
+    SDL_Surface* argb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!argb) return;
+    SoftSprite* sprite = &station->soft.sprites[station->soft.sprite_count];
+    sprite->pixels = malloc((size_t)argb->w * argb->h * sizeof(Uint32));
+    if (sprite->pixels) {
+        SDL_LockSurface(argb);
+        for (int row = 0; row < argb->h; row++) {
+            memcpy(sprite->pixels + (size_t)row * argb->w, (Uint8*)argb->pixels + (size_t)row * argb->pitch, argb->w * sizeof(Uint32));
+        }
+        SDL_UnlockSurface(argb);
+        sprite->texture = texture;
+        sprite->w = argb->w;
+        sprite->h = argb->h;
+        station->soft.sprite_count++;
+    }
+    SDL_FreeSurface(argb);
+}
+
+// Returns -1 if the texture has no CPU copy and must go through SDL instead.
+int soft_raster_sprite(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst, Uint8 alpha) {
+    const SoftSprite* sprite = NULL;
+    for (int i = 0; i < station->soft.sprite_count; i++) {
+        if (station->soft.sprites[i].texture == texture) sprite = &station->soft.sprites[i];
+    }
+    if (!sprite || dst->w <= 0 || dst->h <= 0) return -1;
+    SoftCommand* cmd = soft_push(SOFT_CMD_SPRITE, dst->x, dst->y, dst->w, dst->h);
+    if (!cmd) return 0;
+    cmd->sprite = sprite;
+    cmd->src = *src;
+    cmd->color = (SDL_Color){255, 255, 255, alpha};
+    // Unclipped destination origin and size, for mapping back into the image
+    cmd->cx = dst->x;
+    cmd->cy = dst->y;
+    cmd->radius = dst->w;
+    cmd->inner_radius = dst->h;
+    return 0;
+}
+
+// Mirrors an atlas page upload into the page's CPU alpha mask.
+void soft_raster_store_glyph(int page, const SDL_Rect* slot, const Uint32* pixels, int pitch_pixels) {
+    if (!station->soft_raster_enabled) return;
+    if (!station->soft.glyph_masks[page]) {
+        station->soft.glyph_masks[page] = calloc((size_t)GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE, 1);
+        if (!station->soft.glyph_masks[page]) return;
+    }
+    for (int y = 0; y < slot->h; y++) {
+        Uint8* dst = station->soft.glyph_masks[page] + (size_t)(slot->y + y) * GLYPH_PAGE_SIZE + slot->x;
+        for (int x = 0; x < slot->w; x++) dst[x] = pixels[(size_t)y * pitch_pixels + x] >> 24;
+    }
+}
+
+void soft_raster_glyph(int page, const SDL_Rect* src, int x, int y, SDL_Color color) {
+    SoftCommand* cmd = soft_push(SOFT_CMD_GLYPH, x, y, src->w, src->h);
+    if (!cmd) return;
+    cmd->glyph_page = page;
+    cmd->src = *src;
+    cmd->color = color;
+    cmd->cx = x;
+    cmd->cy = y;
+}
+
+// Fills a rectangle in the current draw colour through whichever path is active.
+void render_fill_rect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    if (station->soft_raster_enabled) soft_raster_rect(renderer, rect);
+    else SDL_RenderFillRect(renderer, rect);
+}
+
+// --- Sprite Atlas ---
+// All static images are packed into one texture at load time, each scaled down
+// to the largest size it is ever drawn at. Sprites are sub-rects of that
+// texture, so consecutive sprite draws batch into a single texture bind.
+// Anything that does not fit keeps a texture of its own.
+
+/**
+ * @brief Loads and packs the requested images, filling each request's Sprite pointer.
+ * @return Number of images that could not be loaded.
+ */
+int load_sprite_atlas(SDL_Renderer* renderer, SpriteRequest* requests, int count) {
+    SDL_Surface* images[MAX_SPRITES] = {0};
+    SDL_Rect slots[MAX_SPRITES];
+    int order[MAX_SPRITES];
+    int missing = 0;
+    if (count > MAX_SPRITES) count = MAX_SPRITES;
+
+    int atlas_width = SPRITE_ATLAS_MAX_SIZE;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0) {
+        atlas_width = SDL_min(atlas_width, info.max_texture_width);
+    }
+    int atlas_max_height = atlas_width;
+
+    // A warm start maps the packed atlas from the disk cache. The key covers the
+    // source file contents, the size limits and the renderer's texture limit.
+    Uint64 atlas_key = fnv1a64(&atlas_width, sizeof(atlas_width), ASSET_CACHE_FNV_OFFSET);
+    int keyed = 1;
+    for (int i = 0; i < count && keyed; i++) {
+        Uint64 source;
+        int limits[2] = {requests[i].max_w, requests[i].max_h};
+        keyed = asset_source_key(requests[i].path, &source) == 0;
+        atlas_key = fnv1a64(&source, sizeof(source), atlas_key);
+        atlas_key = fnv1a64(limits, sizeof(limits), atlas_key);
+    }
+    size_t cached_size = 0;
+    SDL_LockMutex(shared_asset_lock);
+    const SpriteAtlasCache* cached = keyed ? render_cache_map('s', atlas_key, &cached_size) : NULL;
+    SDL_UnlockMutex(shared_asset_lock);
+    if (cached && (cached->count != count || cached_size != sizeof(*cached) + (size_t)cached->w * cached->h * 4)) cached = NULL;
+    SDL_Surface* atlas = cached ? SDL_CreateRGBSurfaceWithFormatFrom((void*)(cached + 1), cached->w, cached->h, 32, cached->w * 4,
+                                                                     SDL_PIXELFORMAT_ARGB8888) : NULL;
+    if (atlas) {
+        for (int i = 0; i < count; i++) {
+            Sprite* sprite = &station->sprite_slots[station->sprite_count++];
+            sprite->texture = NULL;
+            sprite->src = cached->slots[i];
+            *requests[i].sprite = sprite;
+        }
+    } else {
+        // Images are decoded once per process and shared; hold the lock while reading them
+        SDL_LockMutex(shared_asset_lock);
+        for (int i = 0; i < count; i++) {
+            *requests[i].sprite = NULL;
+            order[i] = i;
+            images[i] = shared_image(requests[i].path);
+            if (!images[i]) {
+                fprintf(stderr, "Failed to load image %s. IMG_Error: %s\n", requests[i].path, IMG_GetError());
+                missing++;
+                continue;
+            }
+            slots[i].w = SDL_min(images[i]->w, requests[i].max_w);
+            slots[i].h = SDL_min(images[i]->h, requests[i].max_h);
+        }
+
+        // Shelf-pack the tallest images first
+        for (int i = 1; i < count; i++) {
+            for (int j = i; j > 0 && images[order[j]] && (!images[order[j - 1]] || slots[order[j]].h > slots[order[j - 1]].h); j--) {
+                int swap = order[j]; order[j] = order[j - 1]; order[j - 1] = swap;
+            }
+        }
+        int shelf_x = 0, shelf_y = 0, shelf_h = 0, used_w = 0;
+        for (int k = 0; k < count; k++) {
+            int i = order[k];
+            if (!images[i]) continue;
+            int w = slots[i].w + SPRITE_ATLAS_PADDING, h = slots[i].h + SPRITE_ATLAS_PADDING;
+            if (shelf_x + w > atlas_width) {
+                shelf_y += shelf_h;
+                shelf_x = 0;
+                shelf_h = 0;
+            }
+            if (w > atlas_width || shelf_y + h > atlas_max_height) {
+                slots[i].x = -1; // Gets its own texture
+                continue;
+            }
+            slots[i].x = shelf_x;
+            slots[i].y = shelf_y;
+            shelf_x += w;
+            used_w = SDL_max(used_w, shelf_x);
+            shelf_h = SDL_max(shelf_h, h);
+        }
+
+        atlas = used_w > 0 ? SDL_CreateRGBSurfaceWithFormat(0, used_w, shelf_y + shelf_h, 32, SDL_PIXELFORMAT_ARGB8888) : NULL;
+        for (int i = 0; i < count; i++) {
+            if (!images[i]) continue;
+            Sprite* sprite = &station->sprite_slots[station->sprite_count];
+            if (atlas && slots[i].x >= 0) {
+                if (slots[i].w == images[i]->w && slots[i].h == images[i]->h) SDL_BlitSurface(images[i], NULL, atlas, &slots[i]);
+                else SDL_SoftStretchLinear(images[i], NULL, atlas, &slots[i]);
+                sprite->src = slots[i];
+            } else {
+                // Too big for the shared atlas (or it could not be created)
+                SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, slots[i].w, slots[i].h, 32, SDL_PIXELFORMAT_ARGB8888);
+                if (scaled) SDL_SoftStretchLinear(images[i], NULL, scaled, NULL);
+                sprite->texture = scaled ? SDL_CreateTextureFromSurface(renderer, scaled) : NULL;
+                if (sprite->texture) soft_raster_register_sprite(sprite->texture, scaled);
+                if (scaled) SDL_FreeSurface(scaled);
+                sprite->src = (SDL_Rect){0, 0, slots[i].w, slots[i].h};
+                if (!sprite->texture) { missing++; continue; }
+            }
+            *requests[i].sprite = sprite;
+            station->sprite_count++;
+        }
+        SDL_UnlockMutex(shared_asset_lock);
+
+        // Only an atlas holding every image is cached, so a hit needs no decoding at all
+        int complete = keyed && atlas && missing == 0 && atlas->pitch == atlas->w * 4;
+        for (int i = 0; i < count && complete; i++) complete = slots[i].x >= 0;
+        if (complete) {
+            SpriteAtlasCache table = {count, atlas->w, atlas->h, {{0}}};
+            memcpy(table.slots, slots, sizeof(SDL_Rect) * count);
+            const void* parts[2] = {&table, atlas->pixels};
+            size_t sizes[2] = {sizeof(table), (size_t)atlas->pitch * atlas->h};
+            render_cache_store('s', atlas_key, parts, sizes, 2);
+        }
+    }
+
+    if (atlas) {
+        station->sprite_atlas_texture = SDL_CreateTextureFromSurface(renderer, atlas);
+        if (station->sprite_atlas_texture) {
+            SDL_SetTextureBlendMode(station->sprite_atlas_texture, SDL_BLENDMODE_BLEND);
+            soft_raster_register_sprite(station->sprite_atlas_texture, atlas);
+        } else {
+            fprintf(stderr, "Failed to create sprite atlas: %s\n", SDL_GetError());
+        }
+        for (int i = 0; i < count; i++) {
+            Sprite* sprite = *requests[i].sprite;
+            if (!sprite || sprite->texture) continue;
+            if (station->sprite_atlas_texture) sprite->texture = station->sprite_atlas_texture;
+            else { *requests[i].sprite = NULL; missing++; }
+        }
+        printf("Packed %d images into a %dx%d sprite atlas\n", station->sprite_count, atlas->w, atlas->h);
+        SDL_FreeSurface(atlas);
+    }
+    return missing;
+}
+
+void cleanup_sprites(void) {
+    for (int i = 0; i < station->sprite_count; i++) {
+        if (station->sprite_slots[i].texture && station->sprite_slots[i].texture != station->sprite_atlas_texture) SDL_DestroyTexture(station->sprite_slots[i].texture);
+    }
+    if (station->sprite_atlas_texture) SDL_DestroyTexture(station->sprite_atlas_texture);
+    station->sprite_atlas_texture = NULL;
+    station->sprite_count = 0;
+}
+
+// Draws a sprite stretched to dst. Translucent copies use vertex alpha so the
+// shared atlas texture's alpha mod never changes between batched draws.
+void draw_sprite(SDL_Renderer* renderer, const Sprite* sprite, const SDL_Rect* dst, Uint8 alpha) {
+    if (station->soft_raster_enabled && soft_raster_sprite(sprite->texture, &sprite->src, dst, alpha) == 0) return;
+    if (alpha == 255) {
+        SDL_RenderCopy(renderer, sprite->texture, &sprite->src, dst);
+        return;
+    }
+    int texture_w, texture_h;
+    SDL_QueryTexture(sprite->texture, NULL, NULL, &texture_w, &texture_h);
+    float u0 = (float)sprite->src.x / texture_w, v0 = (float)sprite->src.y / texture_h;
+    float u1 = (float)(sprite->src.x + sprite->src.w) / texture_w, v1 = (float)(sprite->src.y + sprite->src.h) / texture_h;
+    SDL_Color color = {255, 255, 255, alpha};
+    SDL_Vertex vertices[4] = {
+        {{dst->x, dst->y}, color, {u0, v0}},
+        {{dst->x + dst->w, dst->y}, color, {u1, v0}},
+        {{dst->x + dst->w, dst->y + dst->h}, color, {u1, v1}},
+        {{dst->x, dst->y + dst->h}, color, {u0, v1}},
+    };
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    SDL_RenderGeometry(renderer, sprite->texture, vertices, 4, indices, 6);
+}
+
+void draw_confetti(SDL_Renderer* renderer, ConfettiParticle particle) {
+    SDL_SetRenderDrawColor(renderer, particle.color.r, particle.color.g, particle.color.b, 255);
+    SDL_Rect rect = {roundf(particle.x), roundf(particle.y), 5, 5};
+    render_fill_rect(renderer, &rect);
+}
+
+void init_confetti(float x, float y) {
+    SDL_Color colors[] = { {95, 215, 11, 255}, {114, 187, 255, 255}, {166, 255, 166, 255} };
+    for (int i = 0; i < NUM_CONFETTI; ++i) {
+        station->confetti[i].x = x;
+        station->confetti[i].y = y;
+        station->confetti[i].vx = (float)(fx_rand() % (int)CONFETTI_SPREAD) - (CONFETTI_SPREAD / 2.0f);
+        station->confetti[i].vy = (float)(fx_rand() % (int)CONFETTI_SPREAD) - (CONFETTI_SPREAD / 2.0f);
+        station->confetti[i].lifetime = CONFETTI_LIFETIME;
+        station->confetti[i].color = colors[fx_rand() % (sizeof(colors) / sizeof(colors[0]))];
+    }
+}
+
+void update_confetti(float delta_time) {
+    for (int i = 0; i < NUM_CONFETTI; ++i) {
+        if (station->confetti[i].lifetime > 0) {
+            station->confetti[i].x += station->confetti[i].vx * delta_time;
+            station->confetti[i].y += station->confetti[i].vy * delta_time;
+            station->confetti[i].vy += CONFETTI_GRAVITY * delta_time;
+            station->confetti[i].lifetime -= delta_time;
+        }
+    }
+}
+
+// MODIFIED: A function to draw a thick line between two points using SDL_RenderGeometry with SDL_Vertex
+void draw_thick_line(SDL_Renderer* renderer, float x1, float y1, float x2, float y2, int thickness, SDL_Color color) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float len = hypot(dx, dy);
+    if (len == 0) return; // Avoid division by zero
+
+    float nx = -dy / len; // Normal vector x
+    float ny = dx / len;  // Normal vector y
+
+    // Calculate half-thickness offsets
+    float offset_x = nx * thickness / 2.0f;
+    float offset_y = ny * thickness / 2.0f;
+
+    if (station->soft_raster_enabled) {
+        float xs[4] = {x1 - offset_x, x1 + offset_x, x2 + offset_x, x2 - offset_x};
+        float ys[4] = {y1 - offset_y, y1 + offset_y, y2 + offset_y, y2 - offset_y};
+        soft_raster_quad(xs, ys, color);
+        return;
+    }
+
+    SDL_Vertex vertices[4];
+
+    // Define vertices for a rectangle
+    vertices[0].position.x = x1 - offset_x;
+    vertices[0].position.y = y1 - offset_y;
+    vertices[0].color = color;
+    vertices[0].tex_coord.x = 0; vertices[0].tex_coord.y = 0;
+
+    vertices[1].position.x = x1 + offset_x;
+    vertices[1].position.y = y1 + offset_y;
+    vertices[1].color = color;
+    vertices[1].tex_coord.x = 0; vertices[1].tex_coord.y = 0;
+
+    vertices[2].position.x = x2 + offset_x;
+    vertices[2].position.y = y2 + offset_y;
+    vertices[2].color = color;
+    vertices[2].tex_coord.x = 0; vertices[2].tex_coord.y = 0;
+
+    vertices[3].position.x = x2 - offset_x;
+    vertices[3].position.y = y2 - offset_y;
+    vertices[3].color = color;
+    vertices[3].tex_coord.x = 0; vertices[3].tex_coord.y = 0;
+    
+    // Define indices for the two triangles forming the rectangle (0,1,2 and 0,2,3)
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+
+    SDL_RenderGeometry(renderer, NULL, vertices, 4, indices, 6);
+}
+
+
+void draw_hold_timer_bar(SDL_Renderer* renderer, int x, int y, int width, int height, float progress) {
+    SDL_Rect bg_rect = {x, y, width, height};
+    SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);
+    render_fill_rect(renderer, &bg_rect);
+
+    int filled_width = (int)(width * progress);
+    SDL_Rect fill_rect = {x, y, filled_width, height};
+    
+    // Interpolate color from red to green based on progress
+    int r = (int)(255 * (1.0f - progress));
+    int g = (int)(255 * progress);
+    SDL_SetRenderDrawColor(renderer, r, g, 0, 255);
+    render_fill_rect(renderer, &fill_rect);
+}
+
+// --- HUD Layer ---
+// The gameplay HUD is composed into a cached render target and redrawn only
+// when one of the values it shows changes; other frames just copy the layer.
+
+static void draw_hud_contents(SDL_Renderer* renderer, TTF_Font* font, const HudValues* values) {
+    char text[100];
+    if (values->state == GAME_DODGE) {
+        snprintf(text, sizeof(text), "Score: %d  High Score: %d", values->count, values->target);
+        draw_text(renderer, font, text, 50, 50, (SDL_Color){255, 255, 255, 255});
+        return;
+    }
+    SDL_Color color = {FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+    snprintf(text, sizeof(text), values->state == GAME_BALANCE_HOLD ? "Targets: %d/%d" : "Coins: %d/%d", values->count, values->target);
+    draw_text(renderer, font, text, 50, 50, color);
+    if (values->hold_fill >= 0) {
+        draw_hold_timer_bar(renderer, (WINDOW_WIDTH - BH_HOLD_BAR_WIDTH) / 2, 50, BH_HOLD_BAR_WIDTH, BH_HOLD_BAR_HEIGHT,
+                            (float)values->hold_fill / BH_HOLD_BAR_WIDTH);
+    }
+    if (values->timer_tenths >= 0) {
+        snprintf(text, sizeof(text), "Time Left: %d.%d", values->timer_tenths / 10, values->timer_tenths % 10);
+        draw_centered_text(renderer, font, text, 100, color);
+    }
+    if (values->player_index >= 0) {
+        snprintf(text, sizeof(text), "Player: %s", available_players[values->player_index].name);
+        int text_w, text_h;
+        text_size(font, text, &text_w, &text_h);
+        draw_text(renderer, font, text, WINDOW_WIDTH - text_w - 50, 50, color);
+    }
+}
+
+/**
+ * @brief Draws the gameplay HUD, re-rendering the cached layer only if @p values differ from what it shows.
+ */
+void draw_hud(SDL_Renderer* renderer, TTF_Font* font, const HudValues* values) {
+    if (station->soft_raster_enabled) {
+        // The software rasteriser draws straight into its own framebuffer
+        draw_hud_contents(renderer, font, values);
+        return;
+    }
+    if (!station->hud_layer.texture) {
+        station->hud_layer.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, HUD_LAYER_HEIGHT);
+        if (!station->hud_layer.texture) {
+            fprintf(stderr, "Failed to create HUD layer, drawing the HUD directly: %s\n", SDL_GetError());
+            station->hud_layer.failed = 1;
+        } else {
+            // The layer holds premultiplied colour after being drawn with normal blending.
+            // Renderers without custom modes blend it as straight colour, which only darkens antialiased edges.
+            if (SDL_SetTextureBlendMode(station->hud_layer.texture, SDL_ComposeCustomBlendMode(
+                    SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                    SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD)) != 0) {
+                SDL_SetTextureBlendMode(station->hud_layer.texture, SDL_BLENDMODE_BLEND);
+            }
+            station->hud_layer.valid = 0;
+        }
+    }
+    if (station->hud_layer.failed) {
+        draw_hud_contents(renderer, font, values);
+        return;
+    }
+
+    if (!station->hud_layer.valid || memcmp(&station->hud_layer.shown, values, sizeof(*values)) != 0) {
+        SavedRenderState saved;
+        if (push_render_target(renderer, station->hud_layer.texture, 1.0f, &saved) != 0) {
+            draw_hud_contents(renderer, font, values);
+            return;
+        }
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        draw_hud_contents(renderer, font, values);
+        pop_render_target(renderer, &saved);
+        station->hud_layer.shown = *values;
+        station->hud_layer.valid = 1;
+    }
+    SDL_Rect dst = {0, 0, WINDOW_WIDTH, HUD_LAYER_HEIGHT};
+    SDL_RenderCopy(renderer, station->hud_layer.texture, NULL, &dst);
+}
+
+void cleanup_hud_layer(void) {
+    if (station->hud_layer.texture) SDL_DestroyTexture(station->hud_layer.texture);
+    memset(&station->hud_layer, 0, sizeof(station->hud_layer));
+}
+
+// Draws a solid, thick line through a ring of points that fades from the newest
+// point (just before head) to the oldest. All segments are submitted as a single
+// batched SDL_RenderGeometry call.
+void draw_trail(SDL_Renderer* renderer, const PlayerObject* points, int head, SDL_Color color, int thickness) {
+    static SDL_Vertex vertices[(TRAIL_LENGTH - 1) * 4];
+    static int indices[(TRAIL_LENGTH - 1) * 6];
+    int segments = 0;
+
+    // Ensure TRAIL_LENGTH is at least 2 to prevent division by zero and ensure at least one segment can be drawn
+    if (TRAIL_LENGTH < 2) {
+        return; 
+    }
+
+    // Iterate backwards from the newest point (head - 1), over the tuned trail length
+    int length = SDL_min(tuning.trail_length, TRAIL_LENGTH);
+    for (int i = 0; i < length - 1; ++i) {
+        // Calculate the indices for the current segment (newest to oldest)
+        const PlayerObject* current = &points[(head - 1 - i + TRAIL_LENGTH) % TRAIL_LENGTH];
+        const PlayerObject* next = &points[(head - 1 - (i + 1) + TRAIL_LENGTH) % TRAIL_LENGTH];
+
+        // Only draw if both points are valid (not at 0,0 default init)
+        // This break prevents drawing lines from the origin during initial frames
+        if ((current->x == 0 && current->y == 0) || (next->x == 0 && next->y == 0)) {
+            break; 
+        }
+
+        float dx = next->x - current->x;
+        float dy = next->y - current->y;
+        float len = hypot(dx, dy);
+        if (len == 0) continue; // Avoid division by zero
+
+        // Half-thickness offsets along the segment normal
+        float offset_x = -dy / len * thickness / 2.0f;
+        float offset_y = dx / len * thickness / 2.0f;
+
+        SDL_Color segment_color = color;
+        segment_color.a = (Uint8)(color.a * (1.0f - ((float)i / (length - 1)))); // Fade out towards the oldest point
+
+        if (station->soft_raster_enabled) {
+            float xs[4] = {current->x - offset_x, current->x + offset_x, next->x + offset_x, next->x - offset_x};
+            float ys[4] = {current->y - offset_y, current->y + offset_y, next->y + offset_y, next->y - offset_y};
+            soft_raster_quad(xs, ys, segment_color);
+            continue;
+        }
+
+        SDL_Vertex* v = &vertices[segments * 4];
+        v[0].position.x = current->x - offset_x; v[0].position.y = current->y - offset_y;
+        v[1].position.x = current->x + offset_x; v[1].position.y = current->y + offset_y;
+        v[2].position.x = next->x + offset_x;    v[2].position.y = next->y + offset_y;
+        v[3].position.x = next->x - offset_x;    v[3].position.y = next->y - offset_y;
+        for (int k = 0; k < 4; k++) {
+            v[k].color = segment_color;
+            v[k].tex_coord.x = 0; v[k].tex_coord.y = 0;
+        }
+
+        // Two triangles forming the segment's rectangle (0,1,2 and 0,2,3)
+        int* idx = &indices[segments * 6];
+        int base = segments * 4;
+        idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+        idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+        segments++;
+    }
+
+    if (segments > 0) {
+        SDL_RenderGeometry(renderer, NULL, vertices, segments * 4, indices, segments * 6);
+    }
+}
+
+void draw_line_trail(SDL_Renderer* renderer) {
+    SDL_Color trail_color = {TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255};
+    if (tuning.trail_style == TRAIL_STYLE_INK && draw_ink_trail(renderer, trail_color, TRAIL_THICKNESS) == 0) return;
+    draw_trail(renderer, station->trail_points, station->trail_head, trail_color, TRAIL_THICKNESS);
+}
+
+// --- Ink Trail ---
+// Constant-cost alternative to the geometric trail: each frame the newest
+// stroke is stamped into a persistent render target, whose alpha is faded by
+// one full-screen quad before it is composited over the scene. Cost does not
+// depend on trail length or session duration.
+
+/**
+ * @brief Points the renderer at an offscreen target drawn in window coordinates.
+ * @return 0 on success, -1 if the target could not be bound (state is left as it was).
+ */
+int push_render_target(SDL_Renderer* renderer, SDL_Texture* target, float scale, SavedRenderState* saved) {
+    saved->target = SDL_GetRenderTarget(renderer);
+    SDL_RenderGetViewport(renderer, &saved->viewport);
+    SDL_RenderGetScale(renderer, &saved->scale_x, &saved->scale_y);
+    if (SDL_SetRenderTarget(renderer, target) != 0) return -1;
+    SDL_RenderSetScale(renderer, scale, scale);
+    return 0;
+}
+
+void pop_render_target(SDL_Renderer* renderer, const SavedRenderState* saved) {
+    SDL_SetRenderTarget(renderer, saved->target);
+    SDL_RenderSetScale(renderer, saved->scale_x, saved->scale_y);
+    SDL_RenderSetViewport(renderer, &saved->viewport);
+}
+
+// Forgets the stroke so the next frame starts a fresh trail from the player.
+void ink_trail_reset(void) {
+    station->ink_trail.has_last = 0;
+    station->ink_trail.needs_clear = 1;
+}
+
+static int ink_trail_create(SDL_Renderer* renderer) {
+    int w = (int)(WINDOW_WIDTH * tuning.render_scale), h = (int)(WINDOW_HEIGHT * tuning.render_scale);
+    station->ink_trail.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!station->ink_trail.texture) {
+        fprintf(stderr, "Failed to create ink trail target, using the line trail: %s\n", SDL_GetError());
+        return -1;
+    }
+    // The target holds straight (non-premultiplied) colour. Fading only lowers alpha,
+    // so the stroke dims towards transparent without its hue drifting.
+    SDL_SetTextureBlendMode(station->ink_trail.texture, SDL_BLENDMODE_BLEND);
+    station->ink_trail.fade_mode = SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ZERO, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD,
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_REV_SUBTRACT);
+    SDL_BlendMode previous;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    if (SDL_SetRenderDrawBlendMode(renderer, station->ink_trail.fade_mode) != 0) {
+        fprintf(stderr, "Renderer cannot fade the ink trail, using the line trail\n");
+        SDL_DestroyTexture(station->ink_trail.texture);
+        station->ink_trail.texture = NULL;
+        return -1;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+    station->ink_trail.needs_clear = 1;
+    station->ink_trail.last_update = SDL_GetTicks();
+    return 0;
+}
+
+/**
+ * @brief Fades the ink target, stamps the stroke to the newest trail point and draws the result.
+ * @return 0 if drawn, -1 if ink is unavailable and the line trail should be used instead.
+ */
+int draw_ink_trail(SDL_Renderer* renderer, SDL_Color color, int thickness) {
+    if (station->ink_trail.failed || station->soft_raster_enabled) return -1;
+    if (!station->ink_trail.texture && ink_trail_create(renderer) != 0) {
+        station->ink_trail.failed = 1;
+        return -1;
+    }
+    SavedRenderState saved;
+    if (push_render_target(renderer, station->ink_trail.texture, tuning.render_scale, &saved) != 0) {
+        station->ink_trail.failed = 1;
+        return -1;
+    }
+    SDL_BlendMode previous;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    Uint32 now = SDL_GetTicks();
+    if (station->ink_trail.needs_clear) {
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        station->ink_trail.needs_clear = 0;
+        station->ink_trail.fade_carry = 0.0f;
+    } else {
+        // Linear fade, accumulated so slow frames and fast frames fade at the same rate
+        station->ink_trail.fade_carry += (now - station->ink_trail.last_update) * 255.0f / (INK_TRAIL_FADE_SECONDS * 1000.0f);
+        int fade = (int)station->ink_trail.fade_carry;
+        if (fade > 0) {
+            if (fade >= 255) {
+                // Trail not drawn for a while (menus, pause): everything has faded
+                fade = 255;
+                station->ink_trail.fade_carry = 0.0f;
+            } else {
+                station->ink_trail.fade_carry -= fade;
+            }
+            if (SDL_SetRenderDrawBlendMode(renderer, station->ink_trail.fade_mode) != 0) {
+                // The fade mode was refused after all; the line trail is redrawn directly instead
+                SDL_SetRenderDrawBlendMode(renderer, previous);
+                pop_render_target(renderer, &saved);
+                station->ink_trail.failed = 1;
+                return -1;
+            }
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, fade);
+            SDL_RenderFillRect(renderer, NULL);
+        }
+    }
+    station->ink_trail.last_update = now;
+
+    const PlayerObject* newest = &station->trail_points[(station->trail_head - 1 + TRAIL_LENGTH) % TRAIL_LENGTH];
+    if (station->ink_trail.has_last) {
+        // The stroke replaces colour and alpha so faded ink underneath cannot tint it
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        draw_thick_line(renderer, station->ink_trail.last_x, station->ink_trail.last_y, newest->x, newest->y, thickness, color);
+    }
+    station->ink_trail.last_x = newest->x;
+    station->ink_trail.last_y = newest->y;
+    station->ink_trail.has_last = 1;
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+    pop_render_target(renderer, &saved);
+
+    SDL_Rect dst = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_RenderCopy(renderer, station->ink_trail.texture, NULL, &dst);
+    return 0;
+}
+
+void cleanup_ink_trail(void) {
+    if (station->ink_trail.texture) SDL_DestroyTexture(station->ink_trail.texture);
+    memset(&station->ink_trail, 0, sizeof(station->ink_trail));
+}
+
+// --- Board Signal Statistics ---
+void board_stats_reset(void) {
+    memset(&station->board_stats, 0, sizeof(station->board_stats));
+    station->board_stats.connected_at = SDL_GetTicks();
+    station->board_stats.interval_min_ms = -1.0f;
+}
+
+// Called for every balance board event with the kernel's timestamp, so intervals
+// are measured at the source rather than being smeared by the frame loop.
+void board_stats_record_sample(const struct timeval* timestamp) {
+    double now_ms = timestamp->tv_sec * 1000.0 + timestamp->tv_usec / 1000.0;
+    if (station->board_stats.samples > 0) {
+        double interval = now_ms - station->board_stats.last_sample_ms;
+        if (interval < 0) interval = 0;
+        unsigned long n = station->board_stats.samples; // Number of intervals including this one
+        double delta = interval - station->board_stats.interval_mean_ms;
+        station->board_stats.interval_mean_ms += delta / n;
+        station->board_stats.interval_m2 += delta * (interval - station->board_stats.interval_mean_ms);
+        if (station->board_stats.interval_min_ms < 0 || interval < station->board_stats.interval_min_ms) station->board_stats.interval_min_ms = interval;
+        if (interval > station->board_stats.interval_max_ms) station->board_stats.interval_max_ms = interval;
+
+        int bucket = (int)(interval / BOARD_HIST_BUCKET_MS);
+        if (bucket >= BOARD_HIST_BUCKETS) bucket = BOARD_HIST_BUCKETS - 1;
+        station->board_stats.interval_hist[bucket]++;
+
+        if (interval > BOARD_EXPECTED_INTERVAL_MS * BOARD_GAP_FACTOR) {
+            station->board_stats.gaps++;
+            station->board_stats.dropped += (unsigned long)(interval / BOARD_EXPECTED_INTERVAL_MS + 0.5) - 1;
+        }
+    }
+    station->board_stats.last_sample_ms = now_ms;
+    station->board_stats.samples++;
+}
+
+void board_stats_end_frame(int samples_this_frame) {
+    station->board_stats.samples_last_frame = samples_this_frame;
+    if (samples_this_frame > station->board_stats.samples_max_frame) station->board_stats.samples_max_frame = samples_this_frame;
+    if (samples_this_frame > 0) station->board_stats.frames_polled++;
+}
+
+float board_stats_effective_rate(void) {
+    Uint32 elapsed = SDL_GetTicks() - station->board_stats.connected_at;
+    return elapsed > 0 ? station->board_stats.samples * 1000.0f / elapsed : 0.0f;
+}
+
+float board_stats_jitter_ms(void) {
+    if (station->board_stats.samples < 3) return 0.0f;
+    return sqrtf(station->board_stats.interval_m2 / (station->board_stats.samples - 2));
+}
+
+// 0-100 score: share of expected samples actually delivered, reduced by jitter.
+float board_stats_signal_quality(void) {
+    if (station->board_stats.samples < 2) return 0.0f;
+    float delivered = (float)station->board_stats.samples / (station->board_stats.samples + station->board_stats.dropped);
+    float jitter_penalty = board_stats_jitter_ms() / BOARD_EXPECTED_INTERVAL_MS;
+    float quality = 100.0f * delivered / (1.0f + jitter_penalty);
+    return quality < 0.0f ? 0.0f : quality;
+}
+
+void board_stats_format(char* buffer, size_t size) {
+    snprintf(buffer, size,
+             "rate=%.1fHz mean=%.1fms jitter=%.1fms min=%.1fms max=%.1fms gaps=%lu dropped=%lu per_frame=%d/%d quality=%.0f%%",
+             board_stats_effective_rate(), station->board_stats.interval_mean_ms, board_stats_jitter_ms(),
+             station->board_stats.interval_min_ms < 0 ? 0.0f : station->board_stats.interval_min_ms, station->board_stats.interval_max_ms,
+             station->board_stats.gaps, station->board_stats.dropped, station->board_stats.samples_last_frame, station->board_stats.samples_max_frame,
+             board_stats_signal_quality());
+}
+
+// Appends a one-line summary of the connection that is ending, for support triage.
+void board_stats_log_session(const char* reason) {
+    if (station->board_stats.samples == 0) return;
+    char summary[256];
+    board_stats_format(summary, sizeof(summary));
+    printf("Board session ended (%s): %s\n", reason, summary);
+    FILE* file = fopen(BOARD_STATS_LOG_FILE, "a");
+    if (!file) { perror("Failed to write to " BOARD_STATS_LOG_FILE); return; }
+    fprintf(file, "%ld reason=%s duration=%.1fs samples=%lu %s hist=", (long)time(NULL), reason,
+            (SDL_GetTicks() - station->board_stats.connected_at) / 1000.0f, station->board_stats.samples, summary);
+    for (int i = 0; i < BOARD_HIST_BUCKETS; i++) {
+        fprintf(file, "%lu%c", station->board_stats.interval_hist[i], i == BOARD_HIST_BUCKETS - 1 ? '\n' : ',');
+    }
+    fclose(file);
+}
+
+// --- Gesture Recognition ---
+void gesture_reset(GestureRecognizer* recognizer) {
+    memset(recognizer, 0, sizeof(*recognizer));
+}
+
+static float clamp_unit(float value) {
+    return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+void gesture_update(GestureRecognizer* recognizer, float x_cob, float y_cob, float total_weight, float delta_time) {
+    recognizer->flick = GESTURE_NONE;
+
+    // Exponential low-pass, frame-rate independent
+    float alpha = 1.0f - expf(-delta_time / GESTURE_FILTER_TIME_CONSTANT);
+    recognizer->filtered_x += (x_cob - recognizer->filtered_x) * alpha;
+    recognizer->filtered_y += (y_cob - recognizer->filtered_y) * alpha;
+    float fx = recognizer->filtered_x;
+    float fy = recognizer->filtered_y;
+    float ax = fabsf(fx);
+    float ay = fabsf(fy);
+
+    Gesture pose = GESTURE_NONE;
+    float confidence = 0.0f;
+    if (total_weight > MIN_TOTAL_WEIGHT) {
+        float major = ax > ay ? ax : ay;
+        // Centred is judged on the lateral axis, unless the player clearly leans forward or back
+        if (ax < GESTURE_CENTER_THRESHOLD && ay <= GESTURE_LEAN_THRESHOLD) {
+            pose = GESTURE_CENTER;
+            confidence = GESTURE_CENTER_MAX_CONFIDENCE * (1.0f - ax / GESTURE_CENTER_THRESHOLD);
+        } else if (major > GESTURE_LEAN_THRESHOLD) {
+            int sagittal = ay > ax * GESTURE_AXIS_MARGIN;
+            if (sagittal) pose = fy > 0 ? GESTURE_FORWARD : GESTURE_BACK;
+            else if (ax > GESTURE_LEAN_THRESHOLD) pose = fx < 0 ? GESTURE_LEFT : GESTURE_RIGHT;
+            if (pose != GESTURE_NONE) {
+                // Depth past the threshold along the chosen axis, scaled down when the lean is diagonal
+                float along = sagittal ? ay : ax;
+                float across = sagittal ? ax : ay;
+                float depth = clamp_unit((along - GESTURE_LEAN_THRESHOLD) / (GESTURE_FULL_CONFIDENCE_COB - GESTURE_LEAN_THRESHOLD));
+                confidence = depth * clamp_unit(1.0f - across / along);
+            }
+        }
+    }
+
+    if (pose == recognizer->pose) {
+        recognizer->hold_time += delta_time;
+    } else {
+        recognizer->hold_time = 0.0f;
+    }
+
+    // Flick: a lean that peaks far enough and is released quickly
+    int is_lean = (pose != GESTURE_NONE && pose != GESTURE_CENTER);
+    if (is_lean && pose == recognizer->excursion) {
+        recognizer->excursion_time += delta_time;
+        float depth = ax > ay ? ax : ay;
+        if (depth > recognizer->excursion_peak) recognizer->excursion_peak = depth;
+    } else if (pose == GESTURE_NONE && total_weight > MIN_TOTAL_WEIGHT && recognizer->excursion != GESTURE_NONE) {
+        // Passing through the band between the center and lean thresholds on the way back
+        recognizer->excursion_time += delta_time;
+    } else {
+        if (recognizer->excursion != GESTURE_NONE && pose == GESTURE_CENTER &&
+            recognizer->excursion_time <= GESTURE_FLICK_MAX_TIME &&
+            recognizer->excursion_peak >= GESTURE_FLICK_MIN_COB) {
+            recognizer->flick = recognizer->excursion;
+        }
+        recognizer->excursion = is_lean ? pose : GESTURE_NONE;
+        recognizer->excursion_time = 0.0f;
+        recognizer->excursion_peak = is_lean ? (ax > ay ? ax : ay) : 0.0f;
+    }
+
+    recognizer->pose = pose;
+    recognizer->confidence = confidence;
+}
+
+/**
+ * @brief Shared left/center/right lean menu driven by the gesture recogniser.
+ * @param choice In/out: 0 = none, 1 = left, 2 = center, 3 = right, 4 = forward.
+ * @param allow_forward Whether a forward lean selects choice 4 in this menu.
+ * @return 1 when the choice is confirmed, either by a flick or by a dwell that
+ *         shortens as the recogniser's confidence grows.
+ */
+int update_lean_menu(int* choice, int allow_forward, float delta_time) {
+    if (station->gesture.flick == GESTURE_LEFT || station->gesture.flick == GESTURE_RIGHT) {
+        *choice = (station->gesture.flick == GESTURE_LEFT) ? 1 : 3;
+        return 1;
+    }
+
+    int prev_choice = *choice;
+    float confidence = station->gesture.confidence;
+    switch (station->gesture.pose) {
+        case GESTURE_LEFT: *choice = 1; break;
+        case GESTURE_CENTER: *choice = 2; break;
+        case GESTURE_RIGHT: *choice = 3; break;
+        case GESTURE_FORWARD:
+            if (allow_forward) {
+                *choice = 4;
+                break;
+            }
+            // fall through
+        case GESTURE_BACK: {
+            // Without a forward option the menus only look at the lateral axis
+            float fx = station->gesture.filtered_x;
+            if (fabsf(fx) > GESTURE_LEAN_THRESHOLD) *choice = fx < 0 ? 1 : 3;
+            else *choice = fabsf(fx) < GESTURE_CENTER_THRESHOLD ? 2 : 0;
+            confidence = SDL_min(confidence, GESTURE_CENTER_MAX_CONFIDENCE);
+            break;
+        }
+        default: *choice = 0; break;
+    }
+
+    if (*choice != prev_choice) {
+        station->menu_select_timer = 0.0f;
+    }
+    if (*choice == 0) return 0;
+
+    station->menu_select_timer += delta_time;
+    float required = MENU_SELECT_TIME_REQUIRED - (MENU_SELECT_TIME_REQUIRED - MENU_SELECT_MIN_TIME) * confidence;
+    return station->menu_select_timer >= required;
+}
+
+// --- Step Detection ---
+void step_detector_reset(void) {
+    memset(&station->step_detector, 0, sizeof(station->step_detector));
+}
+
+void step_detector_feed(float total_weight, const struct timeval* timestamp) {
+    double now_ms = timestamp->tv_sec * 1000.0 + timestamp->tv_usec / 1000.0;
+    int raw_on = station->step_detector.on_board ? (total_weight > STEP_OFF_WEIGHT) : (total_weight > STEP_ON_WEIGHT);
+    if (raw_on == station->step_detector.on_board) {
+        station->step_detector.candidate = raw_on;
+        return;
+    }
+    if (raw_on != station->step_detector.candidate) {
+        station->step_detector.candidate = raw_on;
+        station->step_detector.candidate_since_ms = now_ms;
+    }
+    if (now_ms - station->step_detector.candidate_since_ms >= STEP_DEBOUNCE_MS) {
+        station->step_detector.on_board = raw_on;
+        if (station->step_detector.queue_count < STEP_EVENT_QUEUE_SIZE) {
+            int tail = (station->step_detector.queue_head + station->step_detector.queue_count) % STEP_EVENT_QUEUE_SIZE;
+            station->step_detector.queue[tail].type = raw_on ? STEP_ON : STEP_OFF;
+            station->step_detector.queue[tail].time = SDL_GetTicks();
+            station->step_detector.queue_count++;
+        }
+    }
+}
+
+// Pops the oldest pending edge. Returns 1 if an event was written to out_event.
+int step_detector_poll(StepEvent* out_event) {
+    if (station->step_detector.queue_count == 0) return 0;
+    *out_event = station->step_detector.queue[station->step_detector.queue_head];
+    station->step_detector.queue_head = (station->step_detector.queue_head + 1) % STEP_EVENT_QUEUE_SIZE;
+    station->step_detector.queue_count--;
+    return 1;
+}
+
+void draw_board_stats_overlay(SDL_Renderer* renderer, TTF_Font* font) {
+    char line[128];
+    SDL_Color color = {FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+    SDL_Rect panel = {20, WINDOW_HEIGHT - 260, 760, 240};
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 200);
+    render_fill_rect(renderer, &panel);
+
+    snprintf(line, sizeof(line), "Board: %.1f Hz  quality %.0f%%", board_stats_effective_rate(), board_stats_signal_quality());
+    draw_text(renderer, font, line, 40, WINDOW_HEIGHT - 250, color);
+    snprintf(line, sizeof(line), "Interval %.1f ms (jitter %.1f, max %.1f)", station->board_stats.interval_mean_ms, board_stats_jitter_ms(), station->board_stats.interval_max_ms);
+    draw_text(renderer, font, line, 40, WINDOW_HEIGHT - 200, color);
+    snprintf(line, sizeof(line), "Gaps %lu  dropped %lu  per frame %d/%d", station->board_stats.gaps, station->board_stats.dropped, station->board_stats.samples_last_frame, station->board_stats.samples_max_frame);
+    draw_text(renderer, font, line, 40, WINDOW_HEIGHT - 150, color);
+
+    // Interval histogram, one bar per bucket scaled to the fullest bucket
+    unsigned long peak = 1;
+    for (int i = 0; i < BOARD_HIST_BUCKETS; i++) {
+        if (station->board_stats.interval_hist[i] > peak) peak = station->board_stats.interval_hist[i];
+    }
+    for (int i = 0; i < BOARD_HIST_BUCKETS; i++) {
+        int bar_height = (int)(50.0f * station->board_stats.interval_hist[i] / peak);
+        SDL_Rect bar = {40 + i * 90, WINDOW_HEIGHT - 40 - bar_height, 80, bar_height};
+        SDL_SetRenderDrawColor(renderer, TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255);
+        render_fill_rect(renderer, &bar);
+    }
+}
+
+/**
  * @brief Reads data from the Wii Balance Board and calculates CoB.
  * @return 0 on success, -1 on disconnection.
  */
-int read_wii_balance_board_data(float *x_cob, float *y_cob) {
-    if (iface == NULL || fd < 0) {
-        printf("No interface or invalid fd\n");
-        *x_cob = 0; *y_cob = 0;
+int read_wii_balance_board_data(float *x_cob, float *y_cob) {
+    if (station->iface == NULL || station->fd < 0) {
+        printf("No interface or invalid fd\n");
+        *x_cob = 0; *y_cob = 0;
+        return -1;
+    }
+
+    int stalls = watchdog_take_stall(station->input_watch);
+    if (stalls) {
+        // The kernel drops unchanged values and empty reports, so a steady load sends
+        // nothing at all: silence alone is not a fault. Only a board that also fails a
+        // positive check counts towards giving up; a merely quiet one is reopened in place.
+        struct pollfd pending = {station->fd, POLLIN, 0};
+        int polled = poll(&pending, 1, 0);
+        int failing = station->board_dispatch_error || (polled > 0 && (pending.revents & (POLLERR | POLLHUP | POLLNVAL)));
+        if (failing ? (stalls > WATCHDOG_MAX_RESTARTS || board_reopen() != 0) : (polled == 0 && board_reopen() != 0)) {
+            printf("Board did not recover\n");
+            return -1;
+        }
+    }
+
+    struct pollfd fds[1];
+    fds[0].fd = station->fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+
+    // Station threads hold their lock here, so they don't wait; reports queue up until the next frame
+    int ret = poll(fds, 1, station_count > 1 ? 0 : tuning.poll_timeout_ms);
+    if (ret < 0) {
+        perror("Poll failed");
+        return -1;
+    }
+    if (ret == 0) {
+        // Measured in time, so neither the tuned poll timeout nor a non-blocking poll changes it
+        if (SDL_GetTicks() - station->last_data_ms >= POLL_TIMEOUT_THRESHOLD * POLL_TIMEOUT_MS) {
+            printf("Board timeout\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    station->last_data_ms = SDL_GetTicks();
+    int got_data = 0;
+    int samples_this_frame = 0;
+    int dispatched;
+    while ((dispatched = xwii_iface_dispatch(station->iface, &station->event, sizeof(station->event))) == 0) {
+        if (station->event.type == XWII_EVENT_GONE) station->board_dispatch_error = 1;
+        else watchdog_beat(station->input_watch); // Any event shows the board is alive
+        if (station->event.type == XWII_EVENT_BALANCE_BOARD) {
+            board_stats_record_sample(&station->event.time);
+            samples_this_frame++;
+            // Use correct mapping: TL=2, TR=0, BL=3, BR=1
+            float cells[4];
+            cells[0] = station->event.v.abs[2].x / 100.0f; // TL
+            cells[1] = station->event.v.abs[0].x / 100.0f; // TR
+            cells[2] = station->event.v.abs[3].x / 100.0f; // BL
+            cells[3] = station->event.v.abs[1].x / 100.0f; // BR
+            float total_weight = cells[0] + cells[1] + cells[2] + cells[3];
+            station->current_total_weight = total_weight * 100.0f;
+            step_detector_feed(station->current_total_weight, &station->event.time);
+            printf("BB RAW: TL=%.2f TR=%.2f BL=%.2f BR=%.2f SUM=%.2f\n", cells[0], cells[1], cells[2], cells[3], total_weight);
+            if (station->current_total_weight > MIN_TOTAL_WEIGHT) {
+                if (station->stability.active) stability_feed(cells, total_weight);
+                *x_cob = (cells[1] + cells[3] - cells[0] - cells[2]) * 100.0f;
+                *y_cob = (cells[0] + cells[1] - cells[2] - cells[3]) * 100.0f;
+                if (tuning.filter_strength > 0.0f) {
+                    // Per-sample low-pass for noisy boards
+                    float alpha = 1.0f - expf(-(BOARD_EXPECTED_INTERVAL_MS / 1000.0f) / tuning.filter_strength);
+                    station->cob_filtered_x += (*x_cob - station->cob_filtered_x) * alpha;
+                    station->cob_filtered_y += (*y_cob - station->cob_filtered_y) * alpha;
+                    *x_cob = station->cob_filtered_x;
+                    *y_cob = station->cob_filtered_y;
+                }
+                if (fabsf(*x_cob) < DEAD_ZONE) *x_cob = 0;
+                if (fabsf(*y_cob) < DEAD_ZONE) *y_cob = 0;
+                got_data = 1;
+            }
+        }
+    }
+    if (dispatched != -EAGAIN) station->board_dispatch_error = 1;
+    board_stats_end_frame(samples_this_frame);
+    if (got_data) {
+        printf("BB CoB: X=%.2f Y=%.2f Weight=%.2f\n", *x_cob, *y_cob, station->current_total_weight);
+        return 0;
+    } else {
+        *x_cob = 0; *y_cob = 0;
+        return 0;
+    }
+}
+
+// --- Limits of Stability ---
+// The player leans as far as they can in every direction while the envelope of
+// their centre of balance is traced over the middle grid. Positions are the CoB
+// normalised by body weight, so 1.0 means all weight on one edge of the board.
+
+static const char* const stability_direction_names[STABILITY_DIRECTIONS] = {"F", "FR", "R", "BR", "B", "BL", "L", "FL"};
+
+void stability_begin(void) {
+    memset(&station->stability, 0, sizeof(station->stability));
+    station->stability.active = 1;
+    station->stability.start_time = SDL_GetTicks();
+}
+
+// Called for every raw board sample with someone on the board while the test runs
+void stability_feed(const float* cells, float total_weight) {
+    float x = (cells[1] + cells[3] - cells[0] - cells[2]) / total_weight;
+    float y = (cells[0] + cells[1] - cells[2] - cells[3]) / total_weight;
+    station->stability.current = (StabilityPoint){x, y};
+    station->stability.samples++;
+    float dist_sq = x * x + y * y;
+    if (dist_sq < STABILITY_MIN_EXCURSION * STABILITY_MIN_EXCURSION) return;
+    int sector = (int)((atan2f(y, x) + (float)M_PI) * (STABILITY_SECTORS / (2.0f * (float)M_PI)));
+    if (sector >= STABILITY_SECTORS) sector = STABILITY_SECTORS - 1;
+    if (dist_sq > station->stability.extreme_dist_sq[sector]) {
+        station->stability.extreme[sector] = station->stability.current;
+        station->stability.extreme_dist_sq[sector] = dist_sq;
+        station->stability.dirty = 1;
+    }
+}
+
+static float stability_cross(StabilityPoint o, StabilityPoint a, StabilityPoint b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+static int stability_point_compare(const void* a, const void* b) {
+    const StabilityPoint* p = a;
+    const StabilityPoint* q = b;
+    if (p->x != q->x) return p->x < q->x ? -1 : 1;
+    return (p->y > q->y) - (p->y < q->y);
+}
+
+// Monotone chain over the sector extremes, followed by the area and reach
+static void stability_rebuild_hull(void) {
+    StabilityPoint points[STABILITY_SECTORS];
+    int n = 0;
+    for (int i = 0; i < STABILITY_SECTORS; i++) {
+        if (station->stability.extreme_dist_sq[i] > 0.0f) points[n++] = station->stability.extreme[i];
+    }
+    qsort(points, n, sizeof(points[0]), stability_point_compare);
+
+    StabilityPoint chain[2 * STABILITY_SECTORS];
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        while (k >= 2 && stability_cross(chain[k - 2], chain[k - 1], points[i]) <= 0.0f) k--;
+        chain[k++] = points[i];
+    }
+    for (int i = n - 2, lower = k + 1; i >= 0; i--) {
+        while (k >= lower && stability_cross(chain[k - 2], chain[k - 1], points[i]) <= 0.0f) k--;
+        chain[k++] = points[i];
+    }
+    station->stability.hull_count = n < 2 ? n : k - 1; // The chain ends where it started
+    memcpy(station->stability.hull, chain, station->stability.hull_count * sizeof(chain[0]));
+
+    float twice_area = 0.0f;
+    for (int i = 0; i < station->stability.hull_count; i++) {
+        StabilityPoint a = station->stability.hull[i], b = station->stability.hull[(i + 1) % station->stability.hull_count];
+        twice_area += a.x * b.y - b.x * a.y;
+    }
+    // The full CoB range is the square [-1, 1] x [-1, 1], area 4
+    station->stability.area = twice_area / 2.0f / 4.0f * 100.0f;
+
+    for (int d = 0; d < STABILITY_DIRECTIONS; d++) {
+        float angle = d * (2.0f * (float)M_PI / STABILITY_DIRECTIONS); // Clockwise from forward
+        float dir_x = sinf(angle), dir_y = cosf(angle), reach = 0.0f;
+        for (int i = 0; i < station->stability.hull_count; i++) {
+            reach = fmaxf(reach, station->stability.hull[i].x * dir_x + station->stability.hull[i].y * dir_y);
+        }
+        station->stability.reach[d] = reach * 100.0f;
+    }
+}
+
+/**
+ * @brief Per-frame step of the assessment: refreshes the hull and ends the test when time is up.
+ * @return 1 once the result has been on screen long enough to return to the menu.
+ */
+int stability_update(void) {
+    if (station->stability.dirty) {
+        stability_rebuild_hull();
+        station->stability.dirty = 0;
+    }
+    Uint32 now = SDL_GetTicks();
+    if (station->stability.finished_at == 0) {
+        if (now - station->stability.start_time < STABILITY_TEST_SECONDS * 1000) return 0;
+        station->stability.active = 0;
+        station->stability.finished_at = now;
+        GameEvent event = {.type = EVENT_STABILITY_RESULT};
+        event.data.stability.area = station->stability.area;
+        for (int d = 0; d < STABILITY_DIRECTIONS; d++) {
+            event.data.stability.reach[d] = (Uint8)fminf(station->stability.reach[d] + 0.5f, 255.0f);
+        }
+        event_publish(event);
+        return 0;
+    }
+    return now - station->stability.finished_at >= STABILITY_RESULT_SECONDS * 1000;
+}
+
+// Draws the envelope over the middle grid, which is the reference frame: its
+// edges are full lean in each direction.
+void draw_stability(SDL_Renderer* renderer, TTF_Font* font_title, TTF_Font* font_description) {
+    SDL_Color text_color = {FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+    float center_x = WINDOW_WIDTH / 2.0f, center_y = WINDOW_HEIGHT / 2.0f, half = MIDDLE_GRID_SIZE / 2.0f;
+    draw_middle_grid(renderer);
+
+    // The hull is convex, so it goes out as one triangle fan around its first vertex
+    int n = station->stability.hull_count;
+    SDL_Color fill = {95, 215, 11, 120};
+    if (n >= 3 && station->soft_raster_enabled) {
+        for (int i = 1; i + 1 < n; i++) {
+            const StabilityPoint* a = &station->stability.hull[0];
+            const StabilityPoint* b = &station->stability.hull[i];
+            const StabilityPoint* c = &station->stability.hull[i + 1];
+            float xs[4] = {center_x + a->x * half, center_x + b->x * half, center_x + c->x * half, center_x + c->x * half};
+            float ys[4] = {center_y - a->y * half, center_y - b->y * half, center_y - c->y * half, center_y - c->y * half};
+            soft_raster_quad(xs, ys, fill);
+        }
+    } else if (n >= 3) {
+        SDL_Vertex vertices[STABILITY_SECTORS];
+        int indices[3 * STABILITY_SECTORS];
+        int index_count = 0;
+        for (int i = 0; i < n; i++) {
+            vertices[i] = (SDL_Vertex){{center_x + station->stability.hull[i].x * half, center_y - station->stability.hull[i].y * half}, fill, {0.0f, 0.0f}};
+        }
+        for (int i = 1; i + 1 < n; i++) {
+            indices[index_count++] = 0;
+            indices[index_count++] = i;
+            indices[index_count++] = i + 1;
+        }
+        SDL_RenderGeometry(renderer, NULL, vertices, n, indices, index_count);
+    }
+
+    if (station->stability.active) {
+        SDL_SetRenderDrawColor(renderer, TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255);
+        draw_filled_circle(renderer, roundf(center_x + station->stability.current.x * half), roundf(center_y - station->stability.current.y * half), 12);
+    }
+
+    char text[64];
+    for (int d = 0; d < STABILITY_DIRECTIONS; d++) {
+        float angle = d * (2.0f * (float)M_PI / STABILITY_DIRECTIONS);
+        float radius = (d % 2) ? (half + 40.0f) * (float)M_SQRT2 : half + 60.0f; // Diagonals sit off the corners
+        int text_w, text_h;
+        snprintf(text, sizeof(text), "%s %.0f%%", stability_direction_names[d], station->stability.reach[d]);
+        text_size(font_description, text, &text_w, &text_h);
+        draw_text(renderer, font_description, text, (int)(center_x + sinf(angle) * radius) - text_w / 2,
+                  (int)(center_y - cosf(angle) * radius) - text_h / 2, text_color);
+    }
+
+    draw_centered_text(renderer, font_title, "Limits of Stability", 40, text_color);
+    if (station->stability.finished_at == 0) {
+        int remaining = STABILITY_TEST_SECONDS - (int)((SDL_GetTicks() - station->stability.start_time) / 1000);
+        snprintf(text, sizeof(text), "Lean as far as you can in every direction - %ds", remaining > 0 ? remaining : 0);
+    } else {
+        snprintf(text, sizeof(text), "Test complete");
+    }
+    draw_centered_text(renderer, font_description, text, WINDOW_HEIGHT - 110, text_color);
+    snprintf(text, sizeof(text), "Area: %.1f%%", station->stability.area);
+    draw_centered_text(renderer, font_description, text, WINDOW_HEIGHT - 60, text_color);
+}
+
+// --- Session Recording ---
+// Each Balance Hold / Coin Collector run is written as a fixed header followed by
+// one RecordingSample per gameplay frame. Closing the recording appends an index
+// with a keyframe every RECORDING_KEYFRAME_MS, so readers can map the file and
+// seek to any time with two binary searches. A finished run that beats the
+// stored best for its mode and difficulty replaces the profile's best
+// recording, which is what the ghost replays.
+
+static const char* recording_mode_name(GameType game) {
+    return game == BALANCE_HOLD ? "balance_hold" : game == COIN_COLLECTOR ? "coin_collector" : "dodge";
+}
+
+static const char* recording_difficulty_name(Difficulty difficulty) {
+    return difficulty == EASY ? "easy" : difficulty == HARD ? "hard" : "medium";
+}
+
+void format_recording_filename(char* filename, size_t size, GameType game, Difficulty difficulty, int player_index, int station, const char* kind) {
+    char base[128];
+    snprintf(base, sizeof(base), "%s_%s_%s.rec", recording_mode_name(game), recording_difficulty_name(difficulty), kind);
+    format_station_profile_filename(filename, size, base, player_index, station);
+}
+
+// Headers before version 3 end where the seed starts
+static size_t recording_header_size(Uint16 version) {
+    return version >= 3 ? sizeof(RecordingHeader) : offsetof(RecordingHeader, seed);
+}
+
+static int read_recording_header(FILE* file, RecordingHeader* header) {
+    memset(header, 0, sizeof(*header));
+    size_t base = recording_header_size(1);
+    if (fread(header, base, 1, file) != 1) return -1;
+    if (memcmp(header->magic, RECORDING_MAGIC, 4) != 0 || header->version < 1 || header->version > RECORDING_VERSION ||
+        header->sample_size != sizeof(RecordingSample)) {
+        return -1;
+    }
+    size_t rest = recording_header_size(header->version) - base;
+    if (rest && fread((Uint8*)header + base, rest, 1, file) != 1) return -1;
+    return 0;
+}
+
+/**
+ * @brief Maps a recording read-only. The index is used when the file has a
+ * complete one; otherwise every whole sample after the header is used.
+ * @return 0 on success, -1 if the file can't be mapped or isn't a recording.
+ */
+int recording_map(const char* path, RecordingView* view) {
+    memset(view, 0, sizeof(*view));
+    int file_fd = open(path, O_RDONLY);
+    if (file_fd < 0) return -1;
+    struct stat st;
+    if (fstat(file_fd, &st) != 0 || (size_t)st.st_size < recording_header_size(1)) {
+        close(file_fd);
+        return -1;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, file_fd, 0);
+    close(file_fd);
+    if (map == MAP_FAILED) return -1;
+    view->map = map;
+    view->map_size = st.st_size;
+    view->header = map;
+    if (memcmp(view->header->magic, RECORDING_MAGIC, 4) != 0 || view->header->version < 1 ||
+        view->header->version > RECORDING_VERSION || view->header->sample_size != sizeof(RecordingSample) ||
+        view->map_size < recording_header_size(view->header->version)) {
+        recording_unmap(view);
+        return -1;
+    }
+    size_t header_size = recording_header_size(view->header->version);
+    view->seed = view->header->version >= 3 ? view->header->seed : 0;
+    view->samples = (const RecordingSample*)((const Uint8*)map + header_size);
+    size_t body = view->map_size - header_size;
+    view->sample_count = body / sizeof(RecordingSample);
+    if (body >= sizeof(RecordingTrailer)) {
+        RecordingTrailer trailer;
+        memcpy(&trailer, (const Uint8*)map + view->map_size - sizeof(trailer), sizeof(trailer));
+        if (memcmp(trailer.magic, RECORDING_INDEX_MAGIC, 4) == 0 &&
+            (Uint64)trailer.sample_count * sizeof(RecordingSample) + (Uint64)trailer.keyframe_count * sizeof(RecordingKeyframe) +
+            sizeof(trailer) == body) {
+            view->sample_count = trailer.sample_count;
+            view->keyframe_count = trailer.keyframe_count;
+            view->keyframes = trailer.keyframe_count ? (const RecordingKeyframe*)(view->samples + trailer.sample_count) : NULL;
+        }
+    }
+    return 0;
+}
+
+void recording_unmap(RecordingView* view) {
+    if (view->map) munmap(view->map, view->map_size);
+    memset(view, 0, sizeof(*view));
+}
+
+/**
+ * @brief Finds the last sample at or before time_ms in O(log n): a binary search
+ * over the keyframes picks the span, a second one over that span's samples.
+ * @return The sample index; 0 if time_ms is before the first sample.
+ */
+Uint32 recording_seek(const RecordingView* view, Uint32 time_ms) {
+    Uint32 lo = 0, hi = view->sample_count;
+    if (hi == 0) return 0;
+    if (view->keyframes) {
+        Uint32 k_lo = 0, k_hi = view->keyframe_count;
+        while (k_hi - k_lo > 1) {
+            Uint32 mid = k_lo + (k_hi - k_lo) / 2;
+            if (view->keyframes[mid].time_ms <= time_ms) k_lo = mid;
+            else k_hi = mid;
+        }
+        lo = view->keyframes[k_lo].sample_index;
+        if (k_hi < view->keyframe_count) hi = view->keyframes[k_hi].sample_index;
+        if (lo >= view->sample_count || hi > view->sample_count || lo >= hi) { lo = 0; hi = view->sample_count; } // Damaged index
+    }
+    while (hi - lo > 1) {
+        Uint32 mid = lo + (hi - lo) / 2;
+        if (view->samples[mid].time_ms <= time_ms) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Prints the samples between two times and a summary of that span (--inspect)
+int inspect_recording(const char* path, float from_seconds, float to_seconds) {
+    RecordingView view;
+    if (recording_map(path, &view) != 0) {
+        fprintf(stderr, "Failed to read recording %s\n", path);
+        return -1;
+    }
+    printf("%s: %s %s, %u samples, %.1fs%s, %s\n", path, recording_mode_name((GameType)view.header->mode),
+           recording_difficulty_name((Difficulty)view.header->difficulty), view.sample_count,
+           view.header->duration_ms / 1000.0f, view.header->completed ? " (won)" : "",
+           view.keyframes ? "indexed" : "no index");
+    Uint32 from_ms = from_seconds > 0.0f ? (Uint32)(from_seconds * 1000.0f) : 0;
+    Uint32 to_ms = to_seconds > 0.0f ? (Uint32)(to_seconds * 1000.0f) : 0xFFFFFFFFu;
+    Uint32 first = recording_seek(&view, from_ms);
+    if (first < view.sample_count && view.samples[first].time_ms < from_ms) first++;
+    Uint32 count = 0;
+    float path_length = 0.0f, cob_total = 0.0f;
+    printf("time_ms x y x_cob y_cob weight score\n");
+    for (Uint32 i = first; i < view.sample_count && view.samples[i].time_ms <= to_ms; i++) {
+        const RecordingSample* sample = &view.samples[i];
+        printf("%u %d %d %d %d %u %u\n", sample->time_ms, sample->x, sample->y, sample->x_cob, sample->y_cob, sample->weight, sample->score);
+        if (count > 0) path_length += hypotf(sample->x_cob - sample[-1].x_cob, sample->y_cob - sample[-1].y_cob);
+        cob_total += hypotf(sample->x_cob, sample->y_cob);
+        count++;
+    }
+    if (count > 0) printf("Span: %u samples, CoB path %.0f, mean CoB distance %.0f\n", count, path_length, cob_total / count);
+    recording_unmap(&view);
+    return 0;
+}
+
+// The file work below runs on the recorder consumer; the game thread only
+// publishes RUN_STARTED, RUN_SAMPLE, RUN_WON and RUN_ENDED events.
+
+static void recording_close(SessionRecorder* recorder, int station, int completed, Uint32 duration_ms);
+
+static void recording_open(SessionRecorder* recorder, int station, GameType game, Difficulty difficulty, int player_index, Uint32 seed) {
+    recording_close(recorder, station, 0, 0);
+    if (!persistence_enabled) return;
+    format_recording_filename(recorder->path, sizeof(recorder->path), game, difficulty, player_index, station, "session");
+    recorder->file = fopen(recorder->path, "wb");
+    if (!recorder->file) {
+        perror("Failed to open session recording");
+        return;
+    }
+    memset(&recorder->header, 0, sizeof(recorder->header));
+    memcpy(recorder->header.magic, RECORDING_MAGIC, 4);
+    recorder->header.version = RECORDING_VERSION;
+    recorder->header.sample_size = sizeof(RecordingSample);
+    recorder->header.mode = (Uint8)game;
+    recorder->header.difficulty = (Uint8)difficulty;
+    recorder->header.player_index = (Uint8)player_index;
+    recorder->header.started_at = (Sint64)time(NULL);
+    recorder->header.seed = seed;
+    recorder->game = game;
+    recorder->difficulty = difficulty;
+    recorder->player_index = player_index;
+    recorder->sample_count = 0;
+    recorder->next_keyframe_ms = 0;
+    recorder->keyframe_count = 0;
+    fwrite(&recorder->header, sizeof(recorder->header), 1, recorder->file);
+}
+
+// Keyframes that can't be stored only make the index coarser
+static void recording_add_keyframe(SessionRecorder* recorder, Uint32 time_ms) {
+    if (recorder->keyframe_count == recorder->keyframe_capacity) {
+        Uint32 capacity = recorder->keyframe_capacity ? recorder->keyframe_capacity * 2 : 256;
+        RecordingKeyframe* grown = realloc(recorder->keyframes, capacity * sizeof(RecordingKeyframe));
+        if (!grown) return;
+        recorder->keyframes = grown;
+        recorder->keyframe_capacity = capacity;
+    }
+    recorder->keyframes[recorder->keyframe_count++] = (RecordingKeyframe){time_ms, recorder->sample_count};
+    recorder->next_keyframe_ms = time_ms + RECORDING_KEYFRAME_MS;
+}
+
+// Closes the running recording. A completed run that beats the stored best becomes the new best.
+static void recording_close(SessionRecorder* recorder, int station, int completed, Uint32 duration_ms) {
+    if (!recorder->file) return;
+    RecordingTrailer trailer = {recorder->sample_count, recorder->keyframe_count, RECORDING_INDEX_MAGIC};
+    fwrite(recorder->keyframes, sizeof(RecordingKeyframe), recorder->keyframe_count, recorder->file);
+    fwrite(&trailer, sizeof(trailer), 1, recorder->file);
+    recorder->header.completed = (Uint8)completed;
+    recorder->header.duration_ms = duration_ms;
+    fseek(recorder->file, 0, SEEK_SET);
+    fwrite(&recorder->header, sizeof(recorder->header), 1, recorder->file);
+    fclose(recorder->file);
+    recorder->file = NULL;
+    if (!completed) return;
+
+    char best_path[256];
+    format_recording_filename(best_path, sizeof(best_path), recorder->game, recorder->difficulty, recorder->player_index, station, "best");
+    FILE* best = fopen(best_path, "rb");
+    RecordingHeader best_header;
+    int is_best = 1;
+    if (best) {
+        if (read_recording_header(best, &best_header) == 0 && best_header.completed && best_header.duration_ms <= duration_ms) {
+            is_best = 0;
+        }
+        fclose(best);
+    }
+    if (is_best && rename(recorder->path, best_path) != 0) {
+        perror("Failed to store best session recording");
+    }
+}
+
+static void recorder_handle_event(const GameEvent* event) {
+    SessionRecorder* recorder = &event->origin->recorder;
+    switch (event->type) {
+        case EVENT_RUN_STARTED:
+            recording_open(recorder, event->origin->index, (GameType)event->data.run.game, (Difficulty)event->data.run.difficulty,
+                           event->player_index, event->data.run.seed);
+            break;
+        case EVENT_RUN_SAMPLE:
+            if (!recorder->file) break;
+            if (event->data.sample.time_ms >= recorder->next_keyframe_ms) recording_add_keyframe(recorder, event->data.sample.time_ms);
+            fwrite(&event->data.sample, sizeof(event->data.sample), 1, recorder->file);
+            recorder->sample_count++;
+            break;
+        case EVENT_RUN_WON:
+            recording_close(recorder, event->origin->index, 1, event->time_ms);
+            break;
+        case EVENT_RUN_ENDED:
+            recording_close(recorder, event->origin->index, 0, event->time_ms);
+            break;
+    }
+}
+
+void recorder_start(GameType game, Difficulty difficulty) {
+    event_publish((GameEvent){.type = EVENT_RUN_STARTED, .data.run = {(Uint8)game, (Uint8)difficulty, station->sim_seed}});
+}
+
+static Sint16 clamp_sample(float value) {
+    return (Sint16)(value > 32767.0f ? 32767 : (value < -32768.0f ? -32768 : value));
+}
+
+void recorder_write(Uint32 time_ms, const PlayerObject* player, float x_cob, float y_cob, float total_weight, int score) {
+    GameEvent event = {.type = EVENT_RUN_SAMPLE};
+    RecordingSample* sample = &event.data.sample;
+    sample->time_ms = time_ms;
+    sample->x = clamp_sample(player->x);
+    sample->y = clamp_sample(player->y);
+    sample->x_cob = clamp_sample(x_cob);
+    sample->y_cob = clamp_sample(y_cob);
+    sample->weight = (Uint16)(total_weight < 0 ? 0 : (total_weight > 65535.0f ? 65535 : total_weight));
+    sample->score = (Uint16)score;
+    event_publish(event);
+}
+
+// Closes any open recording as incomplete. Winning closes it through RUN_WON instead.
+void recorder_discard(void) {
+    event_publish((GameEvent){.type = EVENT_RUN_ENDED});
+}
+
+// --- Ghost Run ---
+// The ghost reads the best recording through a memory mapping, so only the
+// pages holding the samples that fall due each frame are ever read from disk.
+
+void ghost_open(GameType game, Difficulty difficulty, int player_index) {
+    ghost_close();
+    if (!station->ghost_enabled) return;
+    char path[256];
+    format_recording_filename(path, sizeof(path), game, difficulty, player_index, station_index(), "best");
+    if (recording_map(path, &station->ghost.recording) != 0) return;
+    if (!station->ghost.recording.header->completed) {
+        ghost_close();
+        return;
+    }
+    station->ghost.next = 0;
+    station->ghost.visible = 0;
+    station->ghost.trail_head = 0;
+    memset(station->ghost.trail_points, 0, sizeof(station->ghost.trail_points));
+    printf("Ghost loaded from %s (%.1fs run)\n", path, station->ghost.recording.header->duration_ms / 1000.0f);
+}
+
+void ghost_close(void) {
+    recording_unmap(&station->ghost.recording);
+    station->ghost.visible = 0;
+}
+
+// Jumps to time_ms without stepping through the samples before it. Only the
+// samples that make up the trail at that time are read.
+void ghost_seek(Uint32 time_ms) {
+    if (!station->ghost.recording.map) return;
+    Uint32 index = recording_seek(&station->ghost.recording, time_ms);
+    station->ghost.next = index >= TRAIL_LENGTH ? index - TRAIL_LENGTH + 1 : 0;
+    station->ghost.visible = 0;
+    station->ghost.trail_head = 0;
+    memset(station->ghost.trail_points, 0, sizeof(station->ghost.trail_points));
+    ghost_advance(time_ms);
+}
+
+// Consumes every sample up to time_ms and interpolates the ghost between samples.
+void ghost_advance(Uint32 time_ms) {
+    if (!station->ghost.recording.map) return;
+    if (station->ghost.visible && time_ms < station->ghost.last.time_ms) {
+        ghost_seek(time_ms); // Time went backwards
+        return;
+    }
+    const RecordingSample* samples = station->ghost.recording.samples;
+    const RecordingSample* next = NULL;
+    while (station->ghost.next < station->ghost.recording.sample_count && samples[station->ghost.next].time_ms <= time_ms) {
+        station->ghost.last = samples[station->ghost.next++];
+        station->ghost.visible = 1;
+        PlayerObject* point = &station->ghost.trail_points[station->ghost.trail_head];
+        point->x = station->ghost.last.x;
+        point->y = station->ghost.last.y;
+        station->ghost.trail_head = (station->ghost.trail_head + 1) % TRAIL_LENGTH;
+    }
+    if (!station->ghost.visible) return;
+    station->ghost.x = station->ghost.last.x;
+    station->ghost.y = station->ghost.last.y;
+    if (station->ghost.next < station->ghost.recording.sample_count) next = &samples[station->ghost.next];
+    if (next && next->time_ms > station->ghost.last.time_ms) {
+        float t = (float)(time_ms - station->ghost.last.time_ms) / (next->time_ms - station->ghost.last.time_ms);
+        station->ghost.x += (next->x - station->ghost.last.x) * t;
+        station->ghost.y += (next->y - station->ghost.last.y) * t;
+    }
+}
+
+void draw_ghost(SDL_Renderer* renderer, const Sprite* player_sprite) {
+    if (!station->ghost.recording.map || !station->ghost.visible) return;
+    SDL_Color ghost_color = {GHOST_COLOR_R, GHOST_COLOR_G, GHOST_COLOR_B, GHOST_ALPHA};
+    draw_trail(renderer, station->ghost.trail_points, station->ghost.trail_head, ghost_color, TRAIL_THICKNESS);
+    if (player_sprite) {
+        SDL_Rect ghost_rect = {roundf(station->ghost.x - GAME_OBJECT_SIZE / 2.0f), roundf(station->ghost.y - GAME_OBJECT_SIZE / 2.0f), GAME_OBJECT_SIZE, GAME_OBJECT_SIZE};
+        draw_sprite(renderer, player_sprite, &ghost_rect, GHOST_ALPHA);
+    } else {
+        SDL_SetRenderDrawColor(renderer, GHOST_COLOR_R, GHOST_COLOR_G, GHOST_COLOR_B, GHOST_ALPHA);
+        draw_filled_circle(renderer, roundf(station->ghost.x), roundf(station->ghost.y), GAME_OBJECT_SIZE / 2);
+    }
+}
+
+// --- Feedback Synthesis ---
+// Balance Hold feedback is generated directly in SDL_mixer's post-mix callback.
+// The game thread only publishes target parameters and trigger counters through
+// SDL atomics; the audio thread glides towards them sample by sample, so updates
+// are click-free and never touch a mixer channel.
+
+typedef struct {
+    int enabled;
+    int frequency;        // Output sample rate
+    float tone_phase;
+    float tone_frequency; // Smoothed copies of the published parameters
+    float tone_amplitude;
+    float tone_pan;
+    float smoothing;      // One-pole coefficient per sample
+    float beep_phase;     // 0-1 position inside the BH_BEEP_FREQUENCY gate period
+    int seen_hits;
+    int seen_resets;
+    SynthBlip blip;
+    int blip_samples_left;
+    int blip_samples_total;
+    float blip_phase;
+} SynthVoice;
+
+static SynthVoice synth_voice; // Owned by the audio thread once enabled
+
+static void synth_postmix(void* udata, Uint8* stream, int len) {
+    (void)udata;
+    watchdog_beat(audio_watch);
+    SynthVoice* v = &synth_voice;
+    float target_frequency = SDL_AtomicGet(&synth_tone_frequency_mhz) / 1000.0f;
+    float target_amplitude = SDL_AtomicGet(&synth_tone_amplitude) / 10000.0f;
+    float target_pan = SDL_AtomicGet(&synth_tone_pan) / 10000.0f;
+
+    int hits = SDL_AtomicGet(&synth_hit_count);
+    int resets = SDL_AtomicGet(&synth_reset_count);
+    if (hits != v->seen_hits || resets != v->seen_resets) {
+        v->blip = (hits != v->seen_hits) ? SYNTH_BLIP_HIT : SYNTH_BLIP_RESET;
+        v->blip_samples_total = v->frequency * SYNTH_BLIP_MS / 1000;
+        v->blip_samples_left = v->blip_samples_total;
+        v->blip_phase = 0.0f;
+        v->seen_hits = hits;
+        v->seen_resets = resets;
+    }
+
+    Sint16* samples = (Sint16*)stream;
+    int frames = len / (int)(2 * sizeof(Sint16));
+    float beep_step = 1.0f / (BH_BEEP_FREQUENCY * v->frequency);
+    for (int i = 0; i < frames; i++) {
+        v->tone_frequency += (target_frequency - v->tone_frequency) * v->smoothing;
+        v->tone_amplitude += (target_amplitude - v->tone_amplitude) * v->smoothing;
+        v->tone_pan += (target_pan - v->tone_pan) * v->smoothing;
+
+        // Beep gate: on for the first half of each BH_BEEP_FREQUENCY period
+        v->beep_phase += beep_step;
+        if (v->beep_phase >= 1.0f) v->beep_phase -= 1.0f;
+        float gate = v->beep_phase < 0.5f ? 1.0f : 0.0f;
+
+        float tone = 0.0f;
+        if (v->tone_amplitude > 0.0001f) {
+            tone = sinf(v->tone_phase) * v->tone_amplitude * gate;
+            v->tone_phase += 2.0f * (float)M_PI * v->tone_frequency / v->frequency;
+            if (v->tone_phase > 2.0f * (float)M_PI) v->tone_phase -= 2.0f * (float)M_PI;
+        }
+
+        float blip = 0.0f;
+        if (v->blip_samples_left > 0) {
+            float t = 1.0f - (float)v->blip_samples_left / v->blip_samples_total;
+            // Hit: rising chirp. Reset: short falling low tone.
+            float blip_frequency = (v->blip == SYNTH_BLIP_HIT) ? 660.0f + 660.0f * t : 220.0f - 80.0f * t;
+            blip = sinf(v->blip_phase) * SYNTH_BLIP_VOLUME * (1.0f - t);
+            v->blip_phase += 2.0f * (float)M_PI * blip_frequency / v->frequency;
+            v->blip_samples_left--;
+        }
+
+        // Equal-power pan for the hold tone, blips stay centred
+        float angle = (v->tone_pan + 1.0f) * 0.25f * (float)M_PI;
+        float left = tone * cosf(angle) + blip * 0.7071f;
+        float right = tone * sinf(angle) + blip * 0.7071f;
+
+        int l = samples[2 * i] + (int)(left * 32767.0f);
+        int r = samples[2 * i + 1] + (int)(right * 32767.0f);
+        samples[2 * i] = (Sint16)(l > 32767 ? 32767 : (l < -32768 ? -32768 : l));
+        samples[2 * i + 1] = (Sint16)(r > 32767 ? 32767 : (r < -32768 ? -32768 : r));
+    }
+}
+
+/**
+ * @brief Installs the synthesis post-mix hook.
+ * @return 0 on success, -1 if the device format isn't 16-bit stereo (samples are used instead).
+ */
+int synth_init(void) {
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    if (!Mix_QuerySpec(&frequency, &format, &channels) || format != AUDIO_S16SYS || channels != 2) {
+        fprintf(stderr, "Audio device is not 16-bit stereo, using sample feedback instead of synthesis\n");
+        return -1;
+    }
+    memset(&synth_voice, 0, sizeof(synth_voice));
+    synth_voice.frequency = frequency;
+    synth_voice.smoothing = 1.0f - expf(-1000.0f / (SYNTH_PARAM_SMOOTHING_MS * frequency));
+    synth_voice.tone_frequency = SYNTH_BASE_FREQUENCY;
+    synth_voice.enabled = 1;
+    Mix_SetPostMix(synth_postmix, NULL);
+    return 0;
+}
+
+void synth_shutdown(void) {
+    if (synth_voice.enabled) Mix_SetPostMix(NULL, NULL);
+    synth_voice.enabled = 0;
+}
+
+int synth_available(void) {
+    return synth_voice.enabled;
+}
+
+// amplitude 0-1, pan -1 (left) to 1 (right)
+void synth_set_tone(float frequency, float amplitude, float pan) {
+    if (pan < -1.0f) pan = -1.0f;
+    if (pan > 1.0f) pan = 1.0f;
+    SDL_AtomicSet(&synth_tone_frequency_mhz, (int)(frequency * 1000.0f));
+    SDL_AtomicSet(&synth_tone_amplitude, (int)(amplitude * 10000.0f));
+    SDL_AtomicSet(&synth_tone_pan, (int)(pan * 10000.0f));
+}
+
+void synth_trigger(SynthBlip blip) {
+    SDL_AtomicAdd(blip == SYNTH_BLIP_HIT ? &synth_hit_count : &synth_reset_count, 1);
+}
+
+// --- Session Resume ---
+size_t snapshot_serialize(const GameSnapshot* snapshot, Uint8* buffer, size_t size) {
+    if (size < SNAPSHOT_BUFFER_SIZE) return 0;
+    SnapshotHeader header = {SNAPSHOT_MAGIC, SNAPSHOT_VERSION, (Uint16)sizeof(GameSnapshot)};
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), snapshot, sizeof(GameSnapshot));
+    return SNAPSHOT_BUFFER_SIZE;
+}
+
+// Returns 0 on success, -1 if the buffer doesn't hold a snapshot of this build's layout.
+int snapshot_deserialize(const Uint8* buffer, size_t size, GameSnapshot* snapshot) {
+    SnapshotHeader header;
+    if (size < sizeof(header)) return -1;
+    memcpy(&header, buffer, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+        header.size != sizeof(GameSnapshot) || size < SNAPSHOT_BUFFER_SIZE) {
+        return -1;
+    }
+    memcpy(snapshot, buffer + sizeof(header), sizeof(GameSnapshot));
+    return 0;
+}
+
+void snapshot_capture(GameState state, const PlayerObject* player) {
+    GameSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.state = state;
+    snapshot.selected_game = station->selected_game;
+    snapshot.difficulty = station->current_difficulty;
+    snapshot.player_index = station->selected_player_index;
+    snapshot.coins = station->coins;
+    snapshot.current_game_target = station->current_game_target;
+    snapshot.player = *player;
+    snapshot.balance_hold_target = station->balance_hold_target;
+    snapshot.hold_timer = station->hold_timer;
+    snapshot.coin_timer = station->coin_timer;
+    snapshot.session_time_ms = station->session_time_ms;
+    snapshot.sim_rng = station->sim_rng;
+    snapshot.elapsed_ms = (station->game_paused ? station->pause_start_time : SDL_GetTicks()) - station->game_start_time;
+    memcpy(snapshot.coin_collector_coins, station->coin_collector_coins, sizeof(station->coin_collector_coins));
+    memcpy(snapshot.dodge_blocks, station->dodge_blocks, sizeof(station->dodge_blocks));
+    snapshot.block_spawn_timer = station->block_spawn_timer;
+    snapshot.current_block_speed = station->current_block_speed;
+    snapshot.dynamic_block_spawn_interval = station->dynamic_block_spawn_interval;
+    snapshot.dodge_score = station->dodge_score;
+    snapshot.dodge_high_score = station->dodge_high_score;
+    snapshot.lowest_time_to_win = station->lowest_time_to_win;
+    snapshot.total_wins = station->total_wins;
+
+    int back = (station->snapshot_front == 0) ? 1 : 0;
+    if (snapshot_serialize(&snapshot, station->snapshot_buffers[back], SNAPSHOT_BUFFER_SIZE)) {
+        station->snapshot_front = back;
+    }
+}
+
+/**
+ * @brief Restores the last complete snapshot and holds it paused behind a countdown.
+ * @return 0 on success, -1 if there is nothing valid to restore.
+ */
+int snapshot_restore(GameState* state, PlayerObject* player) {
+    GameSnapshot snapshot;
+    if (station->snapshot_front < 0 || snapshot_deserialize(station->snapshot_buffers[station->snapshot_front], SNAPSHOT_BUFFER_SIZE, &snapshot) != 0) {
+        return -1;
+    }
+    *state = (GameState)snapshot.state;
+    station->selected_game = (GameType)snapshot.selected_game;
+    station->current_difficulty = (Difficulty)snapshot.difficulty;
+    station->selected_player_index = snapshot.player_index;
+    station->coins = snapshot.coins;
+    station->current_game_target = snapshot.current_game_target;
+    *player = snapshot.player;
+    for (int i = 0; i < TRAIL_LENGTH; ++i) {
+        // Collapse the trail onto the restored position
+        station->trail_points[i] = *player;
+    }
+    station->trail_head = 0;
+    ink_trail_reset();
+    station->balance_hold_target = snapshot.balance_hold_target;
+    station->hold_timer = snapshot.hold_timer;
+    station->session_time_ms = snapshot.session_time_ms;
+    station->sim_rng = snapshot.sim_rng;
+    station->coin_timer = snapshot.coin_timer;
+    memcpy(station->coin_collector_coins, snapshot.coin_collector_coins, sizeof(station->coin_collector_coins));
+    memcpy(station->dodge_blocks, snapshot.dodge_blocks, sizeof(station->dodge_blocks));
+    station->block_spawn_timer = snapshot.block_spawn_timer;
+    station->current_block_speed = snapshot.current_block_speed;
+    station->dynamic_block_spawn_interval = snapshot.dynamic_block_spawn_interval;
+    station->dodge_score = snapshot.dodge_score;
+    station->dodge_high_score = snapshot.dodge_high_score;
+    station->lowest_time_to_win = snapshot.lowest_time_to_win;
+    station->total_wins = snapshot.total_wins;
+
+    Uint32 now = SDL_GetTicks();
+    station->game_start_time = now - snapshot.elapsed_ms;
+    station->game_paused = 1;
+    station->pause_start_time = now;
+    station->resume_countdown_active = 1;
+    station->resume_countdown_start = now;
+    return 0;
+}
+
+// --- Speculative Pre-warming ---
+// While a menu dwell is in progress the most likely next screen is prepared
+// ahead of time: its profile data is read from disk on a worker thread and
+// its labels are rasterised into the text cache a few per frame. When the
+// selection is confirmed the prepared data is committed if the prediction
+// matched, otherwise it is discarded and loaded synchronously as before.
+
+void load_profile_stats(int player_index, ProfileStats* stats) {
+    char filename[256];
+    stats->player_index = player_index;
+    format_profile_filename(filename, sizeof(filename), "score.txt", player_index);
+    stats->lowest_time = read_lowest_time(filename);
+    format_profile_filename(filename, sizeof(filename), "wins.txt", player_index);
+    stats->total_wins = read_total_wins(filename);
+    format_profile_filename(filename, sizeof(filename), "dodge_score.txt", player_index);
+    stats->dodge_high_score = read_dodge_high_score(filename);
+}
+
+int game_target_for(GameType game, Difficulty difficulty) {
+    if (game == BALANCE_HOLD) return difficulty_configs[difficulty].hold_targets;
+    if (game == COIN_COLLECTOR) return difficulty_configs[difficulty].coin_targets;
+    return 0;
+}
+
+// Only these screens commit profile stats (commit_profile_stats); the others just warm their labels
+static int prewarm_needs_stats(int state) {
+    return state == MAIN_MENU || state == GAME_DODGE;
+}
+
+// Started with its station, so the profile paths it builds are that station's
+static int prewarm_worker(void* data) {
+    station = data;
+    Prewarm* pw = &station->prewarm;
+    SDL_LockMutex(pw->mutex);
+    while (!pw->quit) {
+        if (!pw->active || pw->done_generation == pw->generation) {
+            SDL_CondWait(pw->cond, pw->mutex);
+            continue;
+        }
+        unsigned int generation = pw->generation;
+        int player_index = pw->target.player_index;
+        int needs_stats = prewarm_needs_stats(pw->target.state);
+        SDL_UnlockMutex(pw->mutex);
+
+        ProfileStats stats = {0};
+        if (needs_stats) load_profile_stats(player_index, &stats);
+
+        SDL_LockMutex(pw->mutex);
+        if (generation == pw->generation) { // Otherwise the prediction changed meanwhile
+            pw->stats = stats;
+            pw->done_generation = generation;
+        }
+    }
+    SDL_UnlockMutex(pw->mutex);
+    return 0;
+}
+
+int prewarm_init(void) {
+    station->prewarm.mutex = SDL_CreateMutex();
+    station->prewarm.cond = SDL_CreateCond();
+    if (!station->prewarm.mutex || !station->prewarm.cond) return -1;
+    station->prewarm.thread = SDL_CreateThread(prewarm_worker, "prewarm", station);
+    if (!station->prewarm.thread) {
+        fprintf(stderr, "Failed to start pre-warm thread, loading synchronously: %s\n", SDL_GetError());
+        return -1;
+    }
+    return 0;
+}
+
+void prewarm_shutdown(void) {
+    if (station->prewarm.thread) {
+        SDL_LockMutex(station->prewarm.mutex);
+        station->prewarm.quit = 1;
+        SDL_CondSignal(station->prewarm.cond);
+        SDL_UnlockMutex(station->prewarm.mutex);
+        SDL_WaitThread(station->prewarm.thread, NULL);
+        station->prewarm.thread = NULL;
+    }
+    if (station->prewarm.cond) SDL_DestroyCond(station->prewarm.cond);
+    if (station->prewarm.mutex) SDL_DestroyMutex(station->prewarm.mutex);
+    station->prewarm.cond = NULL;
+    station->prewarm.mutex = NULL;
+}
+
+void prewarm_predict(GameState next_state, int player_index, GameType game, Difficulty difficulty) {
+    PrewarmTarget target = {next_state, player_index, game, difficulty};
+    if (!station->prewarm.thread) {
+        station->prewarm.target = target;
+        station->prewarm.active = 1;
+        return;
+    }
+    SDL_LockMutex(station->prewarm.mutex);
+    if (!station->prewarm.active || memcmp(&target, &station->prewarm.target, sizeof(target)) != 0) {
+        station->prewarm.target = target;
+        station->prewarm.active = 1;
+        station->prewarm.generation++;
+        SDL_CondSignal(station->prewarm.cond);
+    }
+    SDL_UnlockMutex(station->prewarm.mutex);
+}
+
+void prewarm_cancel(void) {
+    if (!station->prewarm.active) return;
+    if (station->prewarm.mutex) SDL_LockMutex(station->prewarm.mutex);
+    station->prewarm.active = 0;
+    station->prewarm.generation++;
+    if (station->prewarm.mutex) SDL_UnlockMutex(station->prewarm.mutex);
+}
+
+// Hands over the pre-loaded profile if the prediction was right, otherwise loads it now.
+void commit_profile_stats(GameState next_state, int player_index, ProfileStats* stats) {
+    int hit = 0;
+    if (station->prewarm.thread) {
+        SDL_LockMutex(station->prewarm.mutex);
+        hit = station->prewarm.active && station->prewarm.target.state == (int)next_state && station->prewarm.target.player_index == player_index &&
+              station->prewarm.done_generation == station->prewarm.generation;
+        if (hit) *stats = station->prewarm.stats;
+        SDL_UnlockMutex(station->prewarm.mutex);
+    }
+    prewarm_cancel();
+    if (!hit) load_profile_stats(player_index, stats);
+}
+
+static void prewarm_text_label(SDL_Renderer* renderer, TTF_Font* font, const char* text, int wrap_width, int* budget) {
+    if (*budget <= 0 || !text[0]) return;
+    TextRun* run = find_text_run(font, text, wrap_width);
+    if (!run) {
+        run = get_text_run(font, text, wrap_width);
+        if (!run) return;
+        (*budget)--;
+    }
+    if (warm_text_run(renderer, run) > 0) (*budget)--;
+}
+
+// Rasterises the predicted screen's labels, at most PREWARM_TEXT_PER_FRAME new ones per call.
+void prewarm_warm_text(SDL_Renderer* renderer, TTF_Font* font_title, TTF_Font* font_description, TTF_Font* font_score) {
+    if (!station->prewarm.active) return;
+    int budget = PREWARM_TEXT_PER_FRAME;
+    int stats_ready = 0;
+    ProfileStats stats = {0};
+    if (station->prewarm.thread) {
+        SDL_LockMutex(station->prewarm.mutex);
+        stats_ready = (station->prewarm.done_generation == station->prewarm.generation);
+        stats = station->prewarm.stats;
+        SDL_UnlockMutex(station->prewarm.mutex);
+    }
+
+    char line[100];
+    int wrap = WINDOW_WIDTH - 200;
+    switch ((GameState)station->prewarm.target.state) {
+        case MAIN_MENU: {
+            const char* labels[] = {"Balance Hold", "Dodge", "Coin Collector"};
+            const char* descriptions[] = {"Lean left to select.", "Stay centered to select.", "Lean right to select."};
+            prewarm_text_label(renderer, font_title, "Select Game", wrap, &budget);
+            for (int i = 0; i < 3; i++) {
+                prewarm_text_label(renderer, font_title, labels[i], 0, &budget);
+                prewarm_text_label(renderer, font_description, descriptions[i], 0, &budget);
+            }
+            if (stats_ready) {
+                snprintf(line, sizeof(line), "Total Wins: %d", stats.total_wins);
+                prewarm_text_label(renderer, font_description, line, wrap, &budget);
+            }
+            break;
+        }
+        case DIFFICULTY_SELECTION: {
+            const char* labels[] = {"Easy", "Medium", "Hard"};
+            prewarm_text_label(renderer, font_title, "Select Difficulty", wrap, &budget);
+            for (int i = 0; i < 3; i++) prewarm_text_label(renderer, font_title, labels[i], 0, &budget);
+            break;
+        }
+        case GAME_DODGE:
+            if (stats_ready) {
+                snprintf(line, sizeof(line), "Score: %d  High Score: %d", 0, stats.dodge_high_score);
+                prewarm_text_label(renderer, font_score, line, 0, &budget);
+            }
+            break;
+        case GAME_BALANCE_HOLD:
+        case GAME_COIN_COLLECTOR:
+            snprintf(line, sizeof(line), "Player: %s", available_players[station->prewarm.target.player_index].name);
+            prewarm_text_label(renderer, font_score, line, 0, &budget);
+            snprintf(line, sizeof(line), station->prewarm.target.state == GAME_BALANCE_HOLD ? "Targets: %d/%d" : "Coins: %d/%d",
+                     0, game_target_for((GameType)station->prewarm.target.game, (Difficulty)station->prewarm.target.difficulty));
+            prewarm_text_label(renderer, font_score, line, 0, &budget);
+            if (station->prewarm.target.state == GAME_COIN_COLLECTOR && difficulty_configs[station->prewarm.target.difficulty].coin_timer > 0.0f) {
+                snprintf(line, sizeof(line), "Time Left: %.1f", CC_COIN_TIMER);
+                prewarm_text_label(renderer, font_score, line, WINDOW_WIDTH - 200, &budget);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Simulation Arithmetic ---
+// Player motion, target and block movement and the game timers go through the
+// helpers below. Built with -DFIXED_POINT_SIM (make FIXED_POINT=1) they do all
+// arithmetic in Q16.16 integers, so a recording replays to bit-identical
+// positions on every compiler and architecture. The state keeps its float
+// fields: each step converts them to fixed point and back, and both
+// conversions are exact or correctly rounded, hence platform independent.
+// The frame time is quantised to whole milliseconds, the same step the
+// session recording stores, and the CoB input to the recorded Sint16 value.
+
+// Frame time in whole milliseconds, as advanced on the session clock
+Uint32 sim_step_ms(float delta_time) {
+    return (Uint32)lroundf(delta_time * 1000.0f);
+}
+
+// Spawns and target placement draw from a per-station xorshift32 generator
+// seeded at the start of each run. The seed goes into the session recording,
+// so a replay reproduces the same layout; rand() would depend on the C library
+// and on whatever else consumed it. Confetti and the screen shake use a
+// separate generator because they run a frame-rate-dependent number of times.
+static Uint32 xorshift32(Uint32* state) {
+    Uint32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// A fresh nonzero seed; zero would keep xorshift at zero forever
+Uint32 sim_new_seed(void) {
+    Uint32 seed = (Uint32)SDL_GetPerformanceCounter() ^ (Uint32)time(NULL) * 2654435761u;
+    return seed ? seed : 1;
+}
+
+void sim_seed(Uint32 seed) {
+    station->sim_seed = seed;
+    station->sim_rng = seed ? seed : 1;
+}
+
+// Non-negative like rand(), so callers can take it modulo a range
+int sim_rand(void) {
+    return (int)(xorshift32(&station->sim_rng) >> 1);
+}
+
+int fx_rand(void) {
+    return (int)(xorshift32(&station->fx_rng) >> 1);
+}
+
+#ifdef FIXED_POINT_SIM
+typedef Sint32 Fixed; // Q16.16
+typedef Fixed SimStep;
+
+static inline Fixed fixed_from_float(float value) { return (Fixed)lroundf(value * 65536.0f); }
+static inline float fixed_to_float(Fixed value) { return (float)value / 65536.0f; }
+// Relies on arithmetic right shifts of negative values, which every supported compiler does
+static inline Fixed fixed_mul(Fixed a, Fixed b) { return (Fixed)(((Sint64)a * b) >> 16); }
+
+static inline SimStep sim_step(float delta_time) {
+    return (Fixed)(((Sint64)sim_step_ms(delta_time) << 16) / 1000);
+}
+
+// value + rate * step
+static inline float sim_advance(float value, float rate, SimStep step) {
+    return fixed_to_float(fixed_from_float(value) + fixed_mul(fixed_from_float(rate), step));
+}
+
+static inline int sim_within(float ax, float ay, float bx, float by, float radius) {
+    Sint64 dx = fixed_from_float(ax) - fixed_from_float(bx);
+    Sint64 dy = fixed_from_float(ay) - fixed_from_float(by);
+    Sint64 r = fixed_from_float(radius);
+    return dx * dx + dy * dy <= r * r;
+}
+
+// Screen position the CoB steers towards: the centre of `extent` plus cob * gain * extent
+static inline float sim_cob_target(float cob, double gain, int extent) {
+    Fixed scale = fixed_from_float((float)(gain * extent));
+    return fixed_to_float((extent << 15) + clamp_sample(cob) * scale);
+}
+
+static inline void sim_spring_step(PlayerObject* player, float target_x, float target_y, SimStep step) {
+    Fixed x = fixed_from_float(player->x), y = fixed_from_float(player->y);
+    Fixed vx = fixed_from_float(player->velocity_x), vy = fixed_from_float(player->velocity_y);
+    Fixed spring = fixed_from_float(SPRING_CONSTANT), damping = fixed_from_float(DAMPING_FACTOR);
+    Fixed force_x = fixed_mul(fixed_from_float(target_x) - x, spring) - fixed_mul(vx, damping);
+    Fixed force_y = fixed_mul(fixed_from_float(target_y) - y, spring) - fixed_mul(vy, damping);
+    vx += fixed_mul(force_x, step);
+    vy += fixed_mul(force_y, step);
+    player->x = fixed_to_float(x + fixed_mul(vx, step));
+    player->y = fixed_to_float(y + fixed_mul(vy, step));
+    player->velocity_x = fixed_to_float(vx);
+    player->velocity_y = fixed_to_float(vy);
+}
+#else
+typedef float SimStep;
+
+static inline SimStep sim_step(float delta_time) { return delta_time; }
+
+static inline float sim_advance(float value, float rate, SimStep step) { return value + rate * step; }
+
+static inline int sim_within(float ax, float ay, float bx, float by, float radius) {
+    return hypot(ax - bx, ay - by) <= radius;
+}
+
+static inline float sim_cob_target(float cob, double gain, int extent) {
+    return (extent / 2.0f) + cob * gain * extent;
+}
+
+static inline void sim_spring_step(PlayerObject* player, float target_x, float target_y, SimStep step) {
+    float force_x = (target_x - player->x) * SPRING_CONSTANT;
+    float force_y = (target_y - player->y) * SPRING_CONSTANT;
+    force_x -= player->velocity_x * DAMPING_FACTOR;
+    force_y -= player->velocity_y * DAMPING_FACTOR;
+    player->velocity_x += force_x * step;
+    player->velocity_y += force_y * step;
+    player->x += player->velocity_x * step;
+    player->y += player->velocity_y * step;
+}
+#endif
+
+// --- Game Logic Functions ---
+void init_player(PlayerObject *player) {
+    player->x = WINDOW_WIDTH / 2.0f;
+    player->y = WINDOW_HEIGHT / 2.0f;
+    player->velocity_x = 0.0f;
+    player->velocity_y = 0.0f;
+    for (int i = 0; i < TRAIL_LENGTH; ++i) {
+        // Initialize trail points to player's starting position
+        station->trail_points[i].x = player->x;
+        station->trail_points[i].y = player->y;
+    }
+    station->trail_head = 0;
+    ink_trail_reset();
+}
+
+void init_balance_hold_game(PlayerObject *player, TargetObject *target) {
+    init_player(player);
+    target->x = (float)(sim_rand() % (WINDOW_WIDTH - GAME_OBJECT_SIZE * 2)) + GAME_OBJECT_SIZE;
+    target->y = (float)(sim_rand() % (WINDOW_HEIGHT - GAME_OBJECT_SIZE * 2)) + GAME_OBJECT_SIZE;
+    float movement_speed = difficulty_configs[station->current_difficulty].target_speed;
+    target->velocity_x = (sim_rand() % 2 == 0) ? movement_speed : -movement_speed;
+    target->velocity_y = (sim_rand() % 2 == 0) ? movement_speed : -movement_speed;
+    station->game_start_time = SDL_GetTicks();
+    station->hold_timer = 0.0f;
+    station->beeps_played = 0;
+}
+
+void init_coin_collector_game(PlayerObject *player) {
+    init_player(player);
+    for (int i = 0; i < station->current_game_target; ++i) {
+        station->coin_collector_coins[i].active = 0;
+    }
+    
+    // Spawn first coin far from player and not at edges
+    spawn_coin(0, player);
+
+    station->game_start_time = SDL_GetTicks();
+    station->coins = 0;
+    // Only timed difficulties use the coin timer
+    if (difficulty_configs[station->current_difficulty].coin_timer > 0.0f) {
+        station->coin_timer = difficulty_configs[station->current_difficulty].coin_timer;
+    }
+}
+
+void init_dodge_game(PlayerObject *player) {
+    init_player(player);
+    for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
+        station->dodge_blocks[i].active = 0;
+    }
+    station->block_spawn_timer = 0;
+    station->current_block_speed = BLOCK_INITIAL_SPEED;
+    station->dodge_score = 0;
+    station->game_start_time = SDL_GetTicks();
+}
+
+void spawn_dodge_block() {
+    for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
+        if (!station->dodge_blocks[i].active) {
+            station->dodge_blocks[i].active = 1;
+            station->dodge_blocks[i].x = WINDOW_WIDTH + BLOCK_WIDTH;
+            station->dodge_blocks[i].y = (float)(sim_rand() % (WINDOW_HEIGHT - BLOCK_HEIGHT));
+            station->dodge_blocks[i].speed = station->current_block_speed;
+            break;
+        }
+    }
+}
+
+// Checks if the player is within a specified radius of the target's center.
+int is_in_zone(PlayerObject player, TargetObject target, int zone_radius) {
+    return sim_within(player.x, player.y, target.x, target.y, zone_radius);
+}
+
+// --- Mode Variants ---
+// Each (mode, difficulty) pair gets its own update function, stamped out by
+// the macros below from one always-inline body. The difficulty is a constant
+// index into difficulty_configs, so the compiler folds the parameters and
+// drops branches like the untimed coin timer from each variant.
+
+// Places coin `index` at a random spot away from the edges and the player.
+void spawn_coin(int index, const PlayerObject* player) {
+    for (;;) {
+        float new_coin_x = (float)(sim_rand() % (WINDOW_WIDTH - COIN_SAFE_MARGIN * 2)) + COIN_SAFE_MARGIN;
+        float new_coin_y = (float)(sim_rand() % (WINDOW_HEIGHT - COIN_SAFE_MARGIN * 2)) + COIN_SAFE_MARGIN;
+        if (!sim_within(new_coin_x, new_coin_y, player->x, player->y, COIN_SPAWN_MIN_DIST_PLAYER)) {
+            station->coin_collector_coins[index].active = 1;
+            station->coin_collector_coins[index].x = new_coin_x;
+            station->coin_collector_coins[index].y = new_coin_y;
+            return;
+        }
+    }
+}
+
+static inline __attribute__((always_inline))
+ModeOutcome update_balance_hold(const DifficultyConfig* config, PlayerObject* player, float x_cob, float delta_time, ModeFrame* frame) {
+    SimStep step = sim_step(delta_time);
+    if (config->target_speed != 0.0f) {
+        station->balance_hold_target.x = sim_advance(station->balance_hold_target.x, station->balance_hold_target.velocity_x, step);
+        station->balance_hold_target.y = sim_advance(station->balance_hold_target.y, station->balance_hold_target.velocity_y, step);
+        // Bounce off walls
+        if (station->balance_hold_target.x < BH_GRACE_ZONE_RADIUS || station->balance_hold_target.x > WINDOW_WIDTH - BH_GRACE_ZONE_RADIUS) {
+            station->balance_hold_target.velocity_x *= -1;
+        }
+        if (station->balance_hold_target.y < BH_GRACE_ZONE_RADIUS || station->balance_hold_target.y > WINDOW_HEIGHT - BH_GRACE_ZONE_RADIUS) {
+            station->balance_hold_target.velocity_y *= -1;
+        }
+    }
+
+    // Score counting logic
+    int in_hold_zone = is_in_zone(*player, station->balance_hold_target, BH_HOLD_RADIUS);
+    if (in_hold_zone) {
+        station->hold_timer = sim_advance(station->hold_timer, 1.0f, step);
+    } else {
+        // Only signal the reset once, when a hold in progress is lost
+        if (station->hold_timer > 0) event_publish((GameEvent){.type = EVENT_HOLD_RESET});
+        station->hold_timer = 0;
+        station->beeps_played = 0;
+    }
+
+    float hold_progress = station->hold_timer / BH_HOLD_TIME_REQUIRED;
+    if (hold_progress > 1.0f) hold_progress = 1.0f;
+    frame->hold_progress = hold_progress;
+
+    // Continuous biofeedback: pitch follows hold progress, pan follows the CoB
+    synth_set_tone(SYNTH_BASE_FREQUENCY + (SYNTH_TOP_FREQUENCY - SYNTH_BASE_FREQUENCY) * hold_progress,
+                   in_hold_zone ? SYNTH_TONE_VOLUME : 0.0f, 2.0f * x_cob * COB_SCALE_GENERAL);
+
+    station->pulse_timer += delta_time;
+    frame->pulse_scale = 1.0f + 0.3f * sinf(station->pulse_timer * BH_TARGET_PULSE_SPEED);
+
+    if (station->hold_timer >= BH_HOLD_TIME_REQUIRED) {
+        station->coins++;
+        event_publish((GameEvent){.type = EVENT_TARGET_HIT, .data.score.count = station->coins});
+        if (station->coins >= config->hold_targets) return MODE_WON;
+        init_balance_hold_game(player, &station->balance_hold_target);
+    }
+    return MODE_RUNNING;
+}
+
+static inline __attribute__((always_inline))
+ModeOutcome update_coin_collector(const DifficultyConfig* config, PlayerObject* player, float x_cob, float delta_time, ModeFrame* frame) {
+    (void)x_cob;
+    (void)frame;
+    if (config->coin_timer > 0.0f) {
+        station->coin_timer = sim_advance(station->coin_timer, -1.0f, sim_step(delta_time));
+        if (station->coin_timer <= 0) return MODE_TIME_UP;
+    }
+
+    for (int i = 0; i < config->coin_targets; ++i) {
+        if (!station->coin_collector_coins[i].active) continue;
+        // Adjust coin hitbox size to make it easier to collect
+        if (is_in_zone(*player, (TargetObject){station->coin_collector_coins[i].x, station->coin_collector_coins[i].y, 0, 0}, STARTING_COIN_SIZE * 1.2)) {
+            station->coin_collector_coins[i].active = 0;
+            station->coins++;
+            event_publish((GameEvent){.type = EVENT_COIN_COLLECTED, .data.score.count = station->coins});
+            if (station->coins >= config->coin_targets) return MODE_WON;
+            spawn_coin(i + 1, player);
+            if (config->coin_timer > 0.0f) station->coin_timer = config->coin_timer;
+        }
+    }
+    return MODE_RUNNING;
+}
+
+#define DEFINE_MODE_UPDATE(mode, difficulty) \
+    static ModeOutcome update_##mode##_##difficulty(PlayerObject* player, float x_cob, float delta_time, ModeFrame* frame) { \
+        return update_##mode(&difficulty_configs[difficulty], player, x_cob, delta_time, frame); \
+    }
+#define DEFINE_MODE_UPDATES(mode) \
+    DEFINE_MODE_UPDATE(mode, EASY) \
+    DEFINE_MODE_UPDATE(mode, MEDIUM) \
+    DEFINE_MODE_UPDATE(mode, HARD)
+
+DEFINE_MODE_UPDATES(balance_hold)
+DEFINE_MODE_UPDATES(coin_collector)
+
+static const ModeUpdateFn mode_updates[2][3] = {
+    {update_balance_hold_EASY, update_balance_hold_MEDIUM, update_balance_hold_HARD},
+    {update_coin_collector_EASY, update_coin_collector_MEDIUM, update_coin_collector_HARD},
+};
+
+// Returns the specialised update for a game screen, or NULL for screens without one.
+ModeUpdateFn mode_update_for(GameState state, Difficulty difficulty) {
+    if (state != GAME_BALANCE_HOLD && state != GAME_COIN_COLLECTOR) return NULL;
+    return mode_updates[state == GAME_COIN_COLLECTOR][difficulty];
+}
+
+// Music calls from the simulation. They only try mixer_lock and skip the call
+// while it is busy, so a device reopen that hangs in the driver, or a sound
+// effect being started, never holds up the frame; the per-frame "start the loop
+// if nothing plays" checks catch up afterwards.
+static int music_lock(void) {
+    if (SDL_TryLockMutex(mixer_lock) != 0) return -1;
+    if (!audio_open) {
+        SDL_UnlockMutex(mixer_lock);
+        return -1;
+    }
+    return 0;
+}
+
+// Mix_PlayMusic behind mixer_lock. Returns -1 only if the mixer refused the track.
+int music_play(Mix_Music* music, int loops) {
+    if (music_lock() != 0) return 0;
+    int result = Mix_PlayMusic(music, loops);
+    SDL_UnlockMutex(mixer_lock);
+    return result;
+}
+
+// Reports music as playing while the mixer is unavailable, so callers don't keep restarting it
+int music_playing(void) {
+    if (music_lock() != 0) return 1;
+    int playing = Mix_PlayingMusic();
+    SDL_UnlockMutex(mixer_lock);
+    return playing;
+}
+
+void music_halt(void) {
+    if (music_lock() != 0) return;
+    Mix_HaltMusic();
+    SDL_UnlockMutex(mixer_lock);
+}
+
+/**
+ * @brief Callback function to play main music after an intro track finishes.
+ * Runs on the mixer's own thread, so it must not take mixer_lock.
+ */
+void music_intro_finished_callback() {
+    if (!Mix_PlayingMusic() && main_loop_music) {
+        if (Mix_PlayMusic(main_loop_music, -1) == -1) {
+            fprintf(stderr, "Failed to play main_loop.wav after intro: %s\n", Mix_GetError());
+        }
+    }
+}
+
+// Update player position with physics simulation
+void update_player_position(PlayerObject* player, float target_x, float target_y, float delta_time) {
+    sim_spring_step(player, target_x, target_y, sim_step(delta_time));
+    if (player->x < GAME_OBJECT_SIZE/2) { player->x = GAME_OBJECT_SIZE/2; player->velocity_x = 0; }
+    if (player->x > WINDOW_WIDTH - GAME_OBJECT_SIZE/2) { player->x = WINDOW_WIDTH - GAME_OBJECT_SIZE/2; player->velocity_x = 0; }
+    if (player->y < GAME_OBJECT_SIZE/2) { player->y = GAME_OBJECT_SIZE/2; player->velocity_y = 0; }
+    if (player->y > WINDOW_HEIGHT - GAME_OBJECT_SIZE/2) { player->y = WINDOW_HEIGHT - GAME_OBJECT_SIZE/2; player->velocity_y = 0; }
+    station->trail_points[station->trail_head] = *player;
+    station->trail_head = (station->trail_head + 1) % TRAIL_LENGTH;
+}
+
+// --- Device Tuning ---
+// Settings that depend on the unit (render headroom, audio stability, board
+// cadence) live in TUNING_FILE rather than in #defines. The file is plain
+// key=value lines; missing keys keep the compiled-in defaults. `--autotune`
+// benchmarks the unit and writes the file.
+
+static const char* quality_names[] = {"low", "medium", "high"};
+static const char* trail_style_names[] = {"lines", "ink"};
+
+static int clamp_int(int value, int low, int high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+void tuning_set_defaults(Tuning* t) {
+    t->target_fps = TARGET_FPS;
+    t->poll_timeout_ms = POLL_TIMEOUT_MS;
+    t->trail_length = TRAIL_LENGTH;
+    t->trail_style = TRAIL_STYLE_LINES;
+    t->audio_buffer = AUDIO_BUFFER_SAMPLES;
+    t->quality = QUALITY_HIGH;
+    t->render_scale = 1.0f;
+    t->filter_strength = 0.0f;
+    t->vsync = 1;
+}
+
+// Trail length follows the quality tier unless the file sets it explicitly.
+static int quality_trail_length(int quality) {
+    return quality == QUALITY_LOW ? TRAIL_LENGTH / 3 : (quality == QUALITY_MEDIUM ? TRAIL_LENGTH * 2 / 3 : TRAIL_LENGTH);
+}
+
+// Likewise the trail style: the low tier gets the constant-cost ink trail.
+static int quality_trail_style(int quality) {
+    return quality == QUALITY_LOW ? TRAIL_STYLE_INK : TRAIL_STYLE_LINES;
+}
+
+/**
+ * @brief Loads the tuning profile over the defaults.
+ * @return 0 if the file was read, -1 if it is missing (defaults stay in place).
+ */
+int load_tuning(const char* filename, Tuning* t) {
+    tuning_set_defaults(t);
+    FILE* file = fopen(filename, "r");
+    if (!file) return -1;
+
+    char line[128];
+    int trail_set = 0, style_set = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char key[64], value[64];
+        if (line[0] == '#' || sscanf(line, " %63[^= ] = %63s", key, value) != 2) continue;
+        if (strcmp(key, "target_fps") == 0) t->target_fps = clamp_int(atoi(value), 20, 240);
+        else if (strcmp(key, "poll_timeout_ms") == 0) t->poll_timeout_ms = clamp_int(atoi(value), 1, 1000);
+        else if (strcmp(key, "trail_length") == 0) { t->trail_length = clamp_int(atoi(value), 2, TRAIL_LENGTH); trail_set = 1; }
+        else if (strcmp(key, "trail_style") == 0) {
+            for (int i = 0; i < (int)SDL_arraysize(trail_style_names); i++) {
+                if (strcmp(value, trail_style_names[i]) == 0) { t->trail_style = i; style_set = 1; }
+            }
+        }
+        else if (strcmp(key, "audio_buffer") == 0) t->audio_buffer = clamp_int(atoi(value), 256, 8192);
+        else if (strcmp(key, "render_scale") == 0) t->render_scale = fminf(fmaxf(atof(value), 0.25f), 1.0f);
+        else if (strcmp(key, "filter_strength") == 0) t->filter_strength = fminf(fmaxf(atof(value), 0.0f), 0.5f);
+        else if (strcmp(key, "vsync") == 0) t->vsync = atoi(value) != 0;
+        else if (strcmp(key, "quality") == 0) {
+            for (int i = 0; i < (int)SDL_arraysize(quality_names); i++) {
+                if (strcmp(value, quality_names[i]) == 0) t->quality = i;
+            }
+        }
+        else fprintf(stderr, "Unknown tuning key '%s' in %s\n", key, filename);
+    }
+    fclose(file);
+    if (!trail_set) t->trail_length = quality_trail_length(t->quality);
+    if (!style_set) t->trail_style = quality_trail_style(t->quality);
+    return 0;
+}
+
+int save_tuning(const char* filename, const Tuning* t, const char* comment) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        perror("Failed to write tuning profile");
+        return -1;
+    }
+    fprintf(file, "# Written by --autotune. %s\n", comment);
+    fprintf(file, "target_fps = %d\n", t->target_fps);
+    fprintf(file, "poll_timeout_ms = %d\n", t->poll_timeout_ms);
+    fprintf(file, "trail_length = %d\n", t->trail_length);
+    fprintf(file, "trail_style = %s\n", trail_style_names[t->trail_style]);
+    fprintf(file, "audio_buffer = %d\n", t->audio_buffer);
+    fprintf(file, "quality = %s\n", quality_names[t->quality]);
+    fprintf(file, "render_scale = %.2f\n", t->render_scale);
+    fprintf(file, "filter_strength = %.3f\n", t->filter_strength);
+    fprintf(file, "vsync = %d\n", t->vsync);
+    fclose(file);
+    return 0;
+}
+
+// A busy gameplay frame: gradient, grid, trail, targets, player and text.
+static void autotune_draw_scene(SDL_Renderer* renderer, TTF_Font* font, int frame) {
+    static PlayerObject points[TRAIL_LENGTH];
+    SDL_Color start_color = {200, 255, 200, 255}, end_color = {100, 200, 100, 255};
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    soft_raster_begin_frame(renderer);
+    draw_gradient_background(renderer, start_color, end_color);
+    for (int i = 0; i < TRAIL_LENGTH; i++) {
+        float t = (frame - (TRAIL_LENGTH - 1 - i)) * 0.05f;
+        points[i].x = WINDOW_WIDTH / 2 + cosf(t) * 300.0f;
+        points[i].y = WINDOW_HEIGHT / 2 + sinf(t * 1.3f) * 250.0f;
+    }
+    SDL_Color trail_color = {TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255};
+    draw_trail(renderer, points, 0, trail_color, TRAIL_THICKNESS);
+    draw_middle_grid(renderer);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 50);
+    draw_filled_circle(renderer, WINDOW_WIDTH / 3, WINDOW_HEIGHT / 3, BH_GRACE_ZONE_RADIUS);
+    SDL_SetRenderDrawColor(renderer, 95, 215, 11, 255);
+    draw_outlined_circle(renderer, WINDOW_WIDTH / 3, WINDOW_HEIGHT / 3, BH_HOLD_RADIUS, 5);
+    SDL_SetRenderDrawColor(renderer, TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255);
+    draw_filled_circle(renderer, points[TRAIL_LENGTH - 1].x, points[TRAIL_LENGTH - 1].y, GAME_OBJECT_SIZE / 2);
+    char text[50];
+    snprintf(text, sizeof(text), "Targets: %d/%d", frame % 10, 10);
+    draw_text(renderer, font, text, 50, 50, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+    draw_hold_timer_bar(renderer, (WINDOW_WIDTH - BH_HOLD_BAR_WIDTH) / 2, 50, BH_HOLD_BAR_WIDTH, BH_HOLD_BAR_HEIGHT, (frame % 100) / 100.0f);
+    soft_raster_present(renderer);
+}
+
+// Frames per second the scene sustains at the given render scale, without vsync.
+static float autotune_measure_fps(SDL_Renderer* renderer, TTF_Font* font, float scale) {
+    SDL_Texture* target = NULL;
+    if (scale < 1.0f) {
+        target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH * scale, WINDOW_HEIGHT * scale);
+        if (!target) return 0.0f;
+    }
+    int frames = 0;
+    Uint32 start = SDL_GetTicks();
+    while (SDL_GetTicks() - start < AUTOTUNE_RENDER_MS) {
+        if (target) {
+            SDL_SetRenderTarget(renderer, target);
+            SDL_RenderSetScale(renderer, scale, scale);
+        }
+        autotune_draw_scene(renderer, font, frames);
+        if (target) {
+            SDL_SetRenderTarget(renderer, NULL);
+            SDL_RenderCopy(renderer, target, NULL, NULL);
+        }
+        SDL_RenderPresent(renderer);
+        frames++;
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {}
+    }
+    if (target) SDL_DestroyTexture(target);
+    return frames * 1000.0f / (SDL_GetTicks() - start);
+}
+
+// Set before the probe is installed (Mix_SetPostMix takes the audio lock) and
+// then only touched by the audio thread, except the counts the main thread reads
+static Uint64 autotune_last_callback = 0;
+static double autotune_period_ticks = 0;
+static SDL_atomic_t autotune_late_callbacks;
+static SDL_atomic_t autotune_callbacks;
+
+// Post-mix hook that counts callbacks arriving much later than one buffer period.
+static void autotune_audio_probe(void* udata, Uint8* stream, int len) {
+    (void)udata; (void)stream; (void)len;
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (autotune_last_callback && SDL_AtomicGet(&autotune_callbacks) > AUTOTUNE_AUDIO_WARMUP &&
+        (now - autotune_last_callback) > autotune_period_ticks * AUTOTUNE_LATE_FACTOR) {
+        SDL_AtomicAdd(&autotune_late_callbacks, 1);
+    }
+    autotune_last_callback = now;
+    SDL_AtomicAdd(&autotune_callbacks, 1);
+}
+
+// Late audio callbacks at this buffer size while the scene renders, or -1 if audio fails to open.
+static int autotune_measure_audio(SDL_Renderer* renderer, TTF_Font* font, int buffer) {
+    Mix_CloseAudio();
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, buffer) < 0) return -1;
+    int frequency;
+    Uint16 format;
+    int channels;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    autotune_period_ticks = (double)buffer / frequency * SDL_GetPerformanceFrequency();
+    autotune_last_callback = 0;
+    SDL_AtomicSet(&autotune_late_callbacks, 0);
+    SDL_AtomicSet(&autotune_callbacks, 0);
+    Mix_SetPostMix(autotune_audio_probe, NULL);
+    Uint32 start = SDL_GetTicks();
+    for (int frame = 0; SDL_GetTicks() - start < AUTOTUNE_AUDIO_MS; frame++) {
+        autotune_draw_scene(renderer, font, frame);
+        SDL_RenderPresent(renderer);
+    }
+    Mix_SetPostMix(NULL, NULL);
+    return SDL_AtomicGet(&autotune_late_callbacks);
+}
+
+/**
+ * @brief Benchmarks this unit and writes TUNING_FILE.
+ *
+ * Picks the highest render scale and quality tier the renderer sustains, the
+ * smallest audio buffer without late callbacks under render load, and the board
+ * poll timeout and input filtering from the measured sample cadence.
+ * @return 0 on success, -1 if the profile could not be written.
+ */
+int run_autotune(SDL_Renderer* renderer, TTF_Font* font) {
+    Tuning result;
+    tuning_set_defaults(&result);
+    char summary[256];
+
+    // Render throughput: full scale first, then cheaper internal resolutions
+    const float scales[] = {1.0f, 0.75f, 0.5f};
+    float fps = 0.0f;
+    for (int i = 0; i < (int)SDL_arraysize(scales); i++) {
+        if (scales[i] < 1.0f && (station->soft_raster_enabled || !SDL_RenderTargetSupported(renderer))) break;
+        fps = autotune_measure_fps(renderer, font, scales[i]);
+        printf("Autotune: render scale %.2f -> %.1f fps\n", scales[i], fps);
+        result.render_scale = scales[i];
+        if (fps >= TARGET_FPS * AUTOTUNE_FPS_HEADROOM) break;
+    }
+    result.quality = fps >= TARGET_FPS * 2.0f ? QUALITY_HIGH : (fps >= TARGET_FPS * AUTOTUNE_FPS_HEADROOM ? QUALITY_MEDIUM : QUALITY_LOW);
+    result.trail_length = quality_trail_length(result.quality);
+    result.trail_style = quality_trail_style(result.quality);
+    // Vsync would halve a unit that can't keep up to 30 fps; cap with the frame limiter instead
+    result.vsync = fps >= TARGET_FPS;
+    result.target_fps = fps >= TARGET_FPS ? TARGET_FPS : clamp_int((int)fps, 20, TARGET_FPS);
+
+    // Audio: smallest buffer that stays on time while rendering
+    const int buffers[] = {512, 1024, 2048, 4096};
+    synth_shutdown();
+    for (int i = 0; i < (int)SDL_arraysize(buffers); i++) {
+        int late = autotune_measure_audio(renderer, font, buffers[i]);
+        printf("Autotune: audio buffer %d -> %d late callbacks\n", buffers[i], late);
+        result.audio_buffer = buffers[i];
+        if (late == 0) break;
+    }
+
+    // Board cadence: short poll timeouts for a steady board, input filtering for a noisy one
+    Uint32 wait_start = SDL_GetTicks();
+    while (!station->iface && SDL_GetTicks() - wait_start < AUTOTUNE_BOARD_WAIT_MS) {
+        if (init_xwiimote_non_blocking() != 0) SDL_Delay(500);
+    }
+    if (station->iface) {
+        float x, y;
+        Uint32 start = SDL_GetTicks();
+        while (SDL_GetTicks() - start < AUTOTUNE_BOARD_MS) {
+            if (read_wii_balance_board_data(&x, &y) != 0) break;
+        }
+        float rate = board_stats_effective_rate();
+        float jitter = board_stats_jitter_ms();
+        printf("Autotune: board %.1f Hz, jitter %.1f ms, quality %.0f%%\n", rate, jitter, board_stats_signal_quality());
+        if (rate > 0) {
+            result.poll_timeout_ms = clamp_int((int)(2.0f * 1000.0f / rate + jitter), 5, POLL_TIMEOUT_MS);
+        }
+        result.filter_strength = board_stats_signal_quality() < 90.0f ? 0.05f : (jitter > BOARD_EXPECTED_INTERVAL_MS ? 0.02f : 0.0f);
+    } else {
+        printf("Autotune: no balance board found, keeping board defaults\n");
+    }
+
+    snprintf(summary, sizeof(summary), "Measured %.1f fps at scale %.2f.", fps, result.render_scale);
+    if (save_tuning(TUNING_FILE, &result, summary) != 0) return -1;
+    printf("Autotune: wrote %s (quality %s, scale %.2f, audio buffer %d, poll %d ms)\n", TUNING_FILE,
+           quality_names[result.quality], result.render_scale, result.audio_buffer, result.poll_timeout_ms);
+    return 0;
+}
+
+// --- Replay Benchmark ---
+// `--bench <recording>...` replays session recordings headlessly through the
+// normal update and render path, as fast as the device allows, and reports
+// frame-time statistics. It is the training load for the PGO build and the
+// yardstick for comparing builds.
+
+int bench_start(char** paths, int count) {
+    memset(&bench, 0, sizeof(bench));
+    bench.paths = paths;
+    bench.path_count = count;
+    bench.frame_capacity = 4096;
+    bench.frame_ms = malloc(sizeof(float) * bench.frame_capacity);
+    if (!bench.frame_ms) return -1;
+    bench.active = 1;
+    persistence_enabled = 0; // Replays must not touch the players' profiles
+    return 0;
+}
+
+// Opens the next readable recording. Returns -1 when all have been played.
+int bench_open_next(GameType* game, Difficulty* difficulty, int* player_index) {
+    recording_unmap(&bench.recording);
+    while (bench.next_path < bench.path_count) {
+        const char* path = bench.paths[bench.next_path++];
+        if (recording_map(path, &bench.recording) == 0 &&
+            (bench.recording.header->mode == BALANCE_HOLD || bench.recording.header->mode == COIN_COLLECTOR)) {
+            const RecordingHeader* header = bench.recording.header;
+            *game = (GameType)header->mode;
+            *difficulty = (Difficulty)header->difficulty;
+            *player_index = header->player_index < num_players ? header->player_index : 0;
+            bench.next_sample = 0;
+            bench.last_sample_ms = 0;
+            bench.win_frames = 0;
+            bench.recordings_played++;
+            printf("Bench: replaying %s\n", path);
+            return 0;
+        }
+        fprintf(stderr, "Bench: skipping unreadable recording %s\n", path);
+        recording_unmap(&bench.recording);
+    }
+    return -1;
+}
+
+// Feeds the next recorded sample as board input. Returns -1 at the end of the recording.
+int bench_next_input(float* x_cob, float* y_cob, float* delta_time) {
+    if (bench.next_sample >= bench.recording.sample_count) return -1;
+    RecordingSample sample = bench.recording.samples[bench.next_sample++];
+    *x_cob = sample.x_cob;
+    *y_cob = sample.y_cob;
+    station->current_total_weight = sample.weight;
+    *delta_time = (sample.time_ms - bench.last_sample_ms) / 1000.0f;
+    bench.last_sample_ms = sample.time_ms;
+    bench.expected = sample;
+    return 0;
+}
+
+// Compares the replayed player position with the recorded one. Only a
+// fixed-point build replaying a fixed-point recording is expected to match.
+void bench_check_frame(const PlayerObject* player) {
+    if (clamp_sample(player->x) != bench.expected.x || clamp_sample(player->y) != bench.expected.y) bench.diverged_frames++;
+}
+
+void bench_record_frame(Uint64 start_counter) {
+    if (bench.frame_count == bench.frame_capacity) {
+        float* grown = realloc(bench.frame_ms, sizeof(float) * bench.frame_capacity * 2);
+        if (!grown) return;
+        bench.frame_ms = grown;
+        bench.frame_capacity *= 2;
+    }
+    bench.frame_ms[bench.frame_count++] = (float)((SDL_GetPerformanceCounter() - start_counter) * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+/**
+ * @brief Prints one summary line; `make compare` reads the "BENCH" lines.
+ * @return 0, or -1 if no recording was replayed (the run measured nothing).
+ */
+int bench_report(void) {
+    int result = (bench.recordings_played > 0 && bench.frame_count > 0) ? 0 : -1;
+    if (bench.frame_count == 0) {
+        fprintf(stderr, "Bench: no frames were replayed\n");
+    } else {
+        double total = 0;
+        for (int i = 0; i < bench.frame_count; i++) total += bench.frame_ms[i];
+        qsort(bench.frame_ms, bench.frame_count, sizeof(float), compare_floats);
+        #define BENCH_PERCENTILE(p) bench.frame_ms[(int)((bench.frame_count - 1) * (p))]
+        printf("BENCH recordings=%d frames=%d mean_ms=%.3f p50_ms=%.3f p95_ms=%.3f p99_ms=%.3f max_ms=%.3f\n",
+               bench.recordings_played, bench.frame_count, total / bench.frame_count,
+               BENCH_PERCENTILE(0.50), BENCH_PERCENTILE(0.95), BENCH_PERCENTILE(0.99), bench.frame_ms[bench.frame_count - 1]);
+        #undef BENCH_PERCENTILE
+#ifdef FIXED_POINT_SIM
+        printf("Bench: %d of %d replayed frames diverged from the recordings\n", bench.diverged_frames, bench.frame_count);
+#endif
+    }
+    if (bench.recordings_played == 0) fprintf(stderr, "Bench: none of the %d recordings could be replayed\n", bench.path_count);
+    recording_unmap(&bench.recording);
+    free(bench.frame_ms);
+    memset(&bench, 0, sizeof(bench));
+    return result;
+}
+
+// --- Event Bus ---
+// Gameplay reports what happened as fixed-size GameEvent records instead of
+// playing sounds and writing files inline. Each consumer (audio, persistence,
+// recorder, metrics, telemetry) has its own bounded lock-free queue and thread
+// and subscribes to the event types it cares about, so publishing costs the
+// game thread one enqueue per interested consumer and never blocks on I/O or
+// the mixer lock. Samples are dropped and counted once a queue is nearly full;
+// the last EVENT_QUEUE_RESERVE cells are kept for the other events, and losing
+// one of those is reported the first time it happens.
+
+int station_index(void) {
+    return station ? station->index : 0;
+}
+
+static void event_queue_init(EventQueue* queue) {
+    for (int i = 0; i < EVENT_QUEUE_CAPACITY; i++) SDL_AtomicSet(&queue->cells[i].sequence, i);
+    SDL_AtomicSet(&queue->tail, 0);
+    queue->head = 0;
+    SDL_AtomicSet(&queue->sleeping, 0);
+    SDL_AtomicSet(&queue->dropped, 0);
+    SDL_AtomicSet(&queue->dropped_control, 0);
+}
+
+// Producers claim a position by advancing tail, copy the event into its cell
+// and then mark the cell filled by setting its sequence to position + 1. The
+// consumer frees a cell by setting its sequence to the position a lap later.
+// Returns -1 if the queue is full, or if fewer than reserve cells would be left.
+static int event_queue_push(EventQueue* queue, const GameEvent* event, unsigned int reserve) {
+    unsigned int pos = (unsigned int)SDL_AtomicGet(&queue->tail);
+    for (;;) {
+        EventCell* cell = &queue->cells[pos & (EVENT_QUEUE_CAPACITY - 1)];
+        int lag = (int)((unsigned int)SDL_AtomicGet(&cell->sequence) - pos);
+        if (lag == 0) {
+            // The cell reserve positions ahead is free too only if the consumer has already emptied it
+            EventCell* spare = &queue->cells[(pos + reserve) & (EVENT_QUEUE_CAPACITY - 1)];
+            if (reserve && (int)((unsigned int)SDL_AtomicGet(&spare->sequence) - (pos + reserve)) < 0) return -1;
+            if (SDL_AtomicCAS(&queue->tail, (int)pos, (int)(pos + 1))) {
+                cell->event = *event;
+                SDL_AtomicSet(&cell->sequence, (int)(pos + 1));
+                return 0;
+            }
+        } else if (lag < 0) {
+            return -1; // The consumer is a full lap behind
+        }
+        pos = (unsigned int)SDL_AtomicGet(&queue->tail); // Another producer got there first
+    }
+}
+
+static int event_queue_ready(EventQueue* queue) {
+    EventCell* cell = &queue->cells[queue->head & (EVENT_QUEUE_CAPACITY - 1)];
+    return (unsigned int)SDL_AtomicGet(&cell->sequence) == queue->head + 1;
+}
+
+// Consumer thread only
+static int event_queue_pop(EventQueue* queue, GameEvent* event) {
+    if (!event_queue_ready(queue)) return -1;
+    EventCell* cell = &queue->cells[queue->head & (EVENT_QUEUE_CAPACITY - 1)];
+    *event = cell->event;
+    SDL_AtomicSet(&cell->sequence, (int)(queue->head + EVENT_QUEUE_CAPACITY));
+    queue->head++;
+    return 0;
+}
+
+static void audio_handle_event(const GameEvent* event) {
+    // The audio keeper may be reopening the device
+    SDL_LockMutex(mixer_lock);
+    if (!audio_open) {
+        SDL_UnlockMutex(mixer_lock);
+        return;
+    }
+    switch (event->type) {
+        case EVENT_TARGET_HIT:
+            if (synth_available()) synth_trigger(SYNTH_BLIP_HIT);
+            else if (target_sound) Mix_PlayChannel(-1, target_sound, 0);
+            break;
+        case EVENT_HOLD_RESET:
+            if (synth_available()) synth_trigger(SYNTH_BLIP_RESET);
+            else if (reset_sound) Mix_PlayChannel(-1, reset_sound, 0);
+            break;
+        case EVENT_COIN_COLLECTED:
+            Mix_PlayChannel(-1, coin_sound, 0);
+            break;
+        case EVENT_BLOCK_HIT:
+            if (synth_available()) synth_trigger(SYNTH_BLIP_RESET);
+            else if (reset_sound) Mix_PlayChannel(-1, reset_sound, 0);
+            break;
+        case EVENT_MENU_SELECT:
+            Mix_PlayChannel(-1, select_sound, 0);
+            break;
+        case EVENT_RUN_WON:
+            Mix_HaltChannel(-1);
+            Mix_PlayChannel(-1, win_sound, 0);
+            break;
+    }
+    SDL_UnlockMutex(mixer_lock);
+}
+
+static void persistence_handle_event(const GameEvent* event) {
+    char filename[256];
+    if (event->player_index < 0) return;
+    if (event->type == EVENT_RUN_WON) {
+        if (event->data.won.new_best) {
+            format_station_profile_filename(filename, sizeof(filename), "score.txt", event->player_index, event->origin->index);
+            write_lowest_time(filename, event->data.won.win_time);
+        }
+        format_station_profile_filename(filename, sizeof(filename), "wins.txt", event->player_index, event->origin->index);
+        write_total_wins(filename, event->data.won.total_wins);
+    } else if (event->type == EVENT_BLOCK_PASSED && event->data.score.new_high_score) {
+        format_station_profile_filename(filename, sizeof(filename), "dodge_score.txt", event->player_index, event->origin->index);
+        write_dodge_high_score(filename, event->data.score.count);
+    } else if (event->type == EVENT_STABILITY_RESULT) {
+        // One line per assessment so progress can be followed over sessions
+        format_station_profile_filename(filename, sizeof(filename), "stability.log", event->player_index, event->origin->index);
+        FILE* file = fopen(filename, "a");
+        if (!file) { perror("Failed to write stability result"); return; }
+        fprintf(file, "%ld area=%.1f", (long)time(NULL), event->data.stability.area);
+        for (int d = 0; d < STABILITY_DIRECTIONS; d++) {
+            fprintf(file, " %s=%d", stability_direction_names[d], event->data.stability.reach[d]);
+        }
+        fputc('\n', file);
+        fclose(file);
+    }
+}
+
+static void metrics_handle_event(const GameEvent* event) {
+    EventMetrics* metrics = &event->origin->metrics;
+    metrics->counts[event->type]++;
+    if (event->type == EVENT_RUN_WON) metrics->win_time_total += event->data.won.win_time;
+}
+
+static const char* const game_state_names[] = {
+    "connecting", "transitioning", "player selection", "main menu", "difficulty selection",
+    "balance hold", "coin collector", "dodge", "winning", "stability test"
+};
+
+static void telemetry_handle_event(const GameEvent* event) {
+    char prefix[24] = "";
+    if (station_count > 1) snprintf(prefix, sizeof(prefix), "Station %d: ", event->origin->index + 1);
+    switch (event->type) {
+        case EVENT_STATE_CHANGE:
+            if (event->data.state.cause == STATE_CAUSE_TIME_UP) {
+                printf("%sTime's up! Returning to menu.\n", prefix);
+            } else if (event->data.state.cause == STATE_CAUSE_INACTIVITY) {
+                printf("%sInactivity timeout. Returning to connecting screen.\n", prefix);
+            } else {
+                printf("%sState: %s -> %s\n", prefix, game_state_names[event->data.state.from], game_state_names[event->data.state.to]);
+            }
+            break;
+        case EVENT_DISCONNECT:
+            if (event->data.disconnect.resumable) {
+                printf("%sBoard lost mid-game. Waiting %d seconds for a reconnect to resume.\n", prefix, RESUME_GRACE_SECONDS);
+            } else {
+                printf("%sBoard lost.\n", prefix);
+            }
+            break;
+        case EVENT_RUN_STARTED:
+            printf("%sRun started: %s, %s\n", prefix, recording_mode_name((GameType)event->data.run.game),
+                   recording_difficulty_name((Difficulty)event->data.run.difficulty));
+            break;
+        case EVENT_RUN_WON:
+            printf("%sRun won in %.2fs%s, %d wins in total\n", prefix, event->data.won.win_time,
+                   event->data.won.new_best ? " (new best)" : "", event->data.won.total_wins);
+            break;
+        case EVENT_STABILITY_RESULT:
+            printf("%sStability envelope: area %.1f%%, reach", prefix, event->data.stability.area);
+            for (int d = 0; d < STABILITY_DIRECTIONS; d++) {
+                printf(" %s %d%%", stability_direction_names[d], event->data.stability.reach[d]);
+            }
+            printf("\n");
+            break;
+    }
+}
+
+#define EVENT_BIT(type) (1u << (type))
+
+enum { EVENT_CONSUMER_COUNT = 5 };
+EventConsumer event_consumers[EVENT_CONSUMER_COUNT] = {
+    {"audio", EVENT_BIT(EVENT_TARGET_HIT) | EVENT_BIT(EVENT_HOLD_RESET) | EVENT_BIT(EVENT_COIN_COLLECTED) |
+              EVENT_BIT(EVENT_BLOCK_HIT) | EVENT_BIT(EVENT_MENU_SELECT) | EVENT_BIT(EVENT_RUN_WON), audio_handle_event},
+    {"persistence", EVENT_BIT(EVENT_RUN_WON) | EVENT_BIT(EVENT_BLOCK_PASSED) | EVENT_BIT(EVENT_STABILITY_RESULT),
+                    persistence_handle_event},
+    {"recorder", EVENT_BIT(EVENT_RUN_STARTED) | EVENT_BIT(EVENT_RUN_SAMPLE) | EVENT_BIT(EVENT_RUN_WON) |
+                 EVENT_BIT(EVENT_RUN_ENDED), recorder_handle_event},
+    {"metrics", (EVENT_BIT(EVENT_TYPE_COUNT) - 1) & ~EVENT_BIT(EVENT_RUN_SAMPLE), metrics_handle_event},
+    {"telemetry", EVENT_BIT(EVENT_STATE_CHANGE) | EVENT_BIT(EVENT_DISCONNECT) | EVENT_BIT(EVENT_RUN_STARTED) |
+                  EVENT_BIT(EVENT_RUN_WON) | EVENT_BIT(EVENT_STABILITY_RESULT), telemetry_handle_event},
+};
+
+static int event_consumer_thread(void* data) {
+    EventConsumer* consumer = data;
+    EventQueue* queue = &consumer->queue;
+    GameEvent event;
+    for (;;) {
+        while (event_queue_pop(queue, &event) == 0) {
+            consumer->handle(&event);
+            watchdog_beat(consumer->watch);
+        }
+        // A blocked write can't be interrupted and gameplay never waits on it, so a stall is only reported
+        if (watchdog_take_stall(consumer->watch)) printf("Event bus: %s consumer is running again\n", consumer->name);
+        watchdog_beat(consumer->watch);
+        if (SDL_AtomicGet(&consumer->quit)) {
+            // Publishers have stopped; handle anything that arrived after the last pop
+            while (event_queue_pop(queue, &event) == 0) consumer->handle(&event);
+            break;
+        }
+        // Announce the wait before the final check so a push in between still wakes us
+        SDL_AtomicSet(&queue->sleeping, 1);
+        if (!event_queue_ready(queue)) SDL_SemWaitTimeout(queue->wake, EVENT_BUS_IDLE_MS);
+        SDL_AtomicSet(&queue->sleeping, 0);
+    }
+    return 0;
+}
+
+/**
+ * @brief Starts one thread per event consumer. A consumer whose thread can't be
+ * started handles its events on the publishing thread instead.
+ * @return 0 on success, -1 if any consumer runs inline.
+ */
+int event_bus_start(void) {
+    int result = 0;
+    for (int i = 0; i < EVENT_CONSUMER_COUNT; i++) {
+        EventConsumer* consumer = &event_consumers[i];
+        event_queue_init(&consumer->queue);
+        SDL_AtomicSet(&consumer->quit, 0);
+        consumer->queue.wake = SDL_CreateSemaphore(0);
+        consumer->watch = watchdog_register(consumer->name, WATCHDOG_IO_MS);
+        consumer->thread = consumer->queue.wake ? SDL_CreateThread(event_consumer_thread, consumer->name, consumer) : NULL;
+        if (!consumer->thread) {
+            fprintf(stderr, "Event bus: %s consumer runs inline: %s\n", consumer->name, SDL_GetError());
+            result = -1;
+        } else {
+            watchdog_arm(consumer->watch);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Lets every consumer drain its queue, stops the threads and reports the metrics.
+ * Call once all stations have stopped publishing.
+ */
+void event_bus_stop(void) {
+    for (int i = 0; i < EVENT_CONSUMER_COUNT; i++) {
+        EventConsumer* consumer = &event_consumers[i];
+        watchdog_disarm(consumer->watch); // Flushing may take longer than a batch
+        if (consumer->thread) {
+            SDL_AtomicSet(&consumer->quit, 1);
+            SDL_SemPost(consumer->queue.wake);
+            SDL_WaitThread(consumer->thread, NULL);
+            consumer->thread = NULL;
+        }
+        if (consumer->queue.wake) SDL_DestroySemaphore(consumer->queue.wake);
+        consumer->queue.wake = NULL;
+        int dropped = SDL_AtomicGet(&consumer->queue.dropped);
+        int dropped_control = SDL_AtomicGet(&consumer->queue.dropped_control);
+        if (dropped || dropped_control) {
+            fprintf(stderr, "Event bus: %s queue was full, %d samples and %d other events dropped\n", consumer->name, dropped, dropped_control);
+        }
+    }
+    for (int i = 0; i < station_count; i++) {
+        if (!stations[i]) continue;
+        const EventMetrics* metrics = &stations[i]->metrics;
+        int wins = metrics->counts[EVENT_RUN_WON];
+        printf("Events, station %d: %d runs, %d wins (mean %.1fs), %d targets, %d coins, %d hold resets, %d blocks passed, %d disconnects\n",
+               i + 1, metrics->counts[EVENT_RUN_STARTED], wins, wins ? metrics->win_time_total / wins : 0.0f,
+               metrics->counts[EVENT_TARGET_HIT], metrics->counts[EVENT_COIN_COLLECTED], metrics->counts[EVENT_HOLD_RESET],
+               metrics->counts[EVENT_BLOCK_PASSED], metrics->counts[EVENT_DISCONNECT]);
+    }
+}
+
+/**
+ * @brief Stamps the event with the calling station, profile and session time and
+ * enqueues it for every subscribed consumer. Never blocks.
+ */
+void event_publish(GameEvent event) {
+    event.origin = station;
+    event.player_index = (Sint8)station->selected_player_index;
+    event.time_ms = station->session_time_ms;
+    Uint32 bit = EVENT_BIT(event.type);
+    for (int i = 0; i < EVENT_CONSUMER_COUNT; i++) {
+        EventConsumer* consumer = &event_consumers[i];
+        if (!(consumer->subscriptions & bit)) continue;
+        if (!consumer->thread) {
+            consumer->handle(&event);
+            continue;
+        }
+        EventQueue* queue = &consumer->queue;
+        int sample = event.type == EVENT_RUN_SAMPLE;
+        if (event_queue_push(queue, &event, sample ? EVENT_QUEUE_RESERVE : 0) != 0) {
+            if (sample) {
+                SDL_AtomicAdd(&queue->dropped, 1);
+            } else {
+                // Rare and it loses a sound, a profile write or a recording boundary, so say so now
+                if (SDL_AtomicAdd(&queue->dropped_control, 1) == 0) {
+                    fprintf(stderr, "Event bus: %s queue is full, dropping events other than samples\n", consumer->name);
+                }
+            }
+        } else if (SDL_AtomicGet(&queue->sleeping) && SDL_AtomicCAS(&queue->sleeping, 1, 0)) {
+            SDL_SemPost(queue->wake);
+        }
+    }
+}
+
+// --- Watchdog ---
+// Each station's board and drawing, the audio device and the event consumers
+// beat a Watch. A watchdog thread flags any armed watch that misses its
+// deadline, and the owner restarts just that subsystem on its own thread: a
+// station's simulation reopens its failing board, the main thread rebuilds the
+// render targets of a station whose frame hung, and the audio keeper thread
+// reopens a dead audio device. Everything else keeps running meanwhile. Each
+// restart grants a new deadline; after WATCHDOG_MAX_RESTARTS without a
+// heartbeat the owner falls back to its normal failure path (e.g. the board
+// disconnect screen).
+
+/**
+ * @brief Adds a watch, disarmed. Call before the subsystem starts beating.
+ * @return The slot, or -1 if all are taken (every watchdog call accepts -1).
+ */
+int watchdog_register(const char* name, Uint32 deadline_ms) {
+    int slot = SDL_AtomicAdd(&watch_count, 1);
+    if (slot >= WATCHDOG_MAX_WATCHES) {
+        SDL_AtomicAdd(&watch_count, -1);
+        fprintf(stderr, "Watchdog: no slot left for %s\n", name);
         return -1;
     }
+    Watch* watch = &watches[slot];
+    if (station_count > 1 && station) snprintf(watch->name, sizeof(watch->name), "%s (station %d)", name, station_index() + 1);
+    else snprintf(watch->name, sizeof(watch->name), "%s", name);
+    watch->deadline_ms = deadline_ms;
+    return slot;
+}
 
-    struct pollfd fds[1];
-    fds[0].fd = fd;
-    fds[0].events = POLLIN;
-    fds[0].revents = 0;
+void watchdog_arm(int watch) {
+    if (watch < 0) return;
+    watchdog_beat(watch);
+    SDL_AtomicSet(&watches[watch].stalled, 0);
+    SDL_AtomicSet(&watches[watch].armed, 1);
+}
 
-    int ret = poll(fds, 1, POLL_TIMEOUT_MS);
-    if (ret < 0) {
-        perror("Poll failed");
+void watchdog_disarm(int watch) {
+    if (watch >= 0) SDL_AtomicSet(&watches[watch].armed, 0);
+}
+
+void watchdog_beat(int watch) {
+    if (watch < 0) return;
+    SDL_AtomicSet(&watches[watch].last_beat, (int)SDL_GetTicks());
+    if (SDL_AtomicGet(&watches[watch].restarts)) SDL_AtomicSet(&watches[watch].restarts, 0);
+}
+
+/**
+ * @brief Claims a stall flagged by the watchdog thread.
+ * @return 0 if there is none, otherwise the number of stalls since the last heartbeat.
+ */
+int watchdog_take_stall(int watch) {
+    if (watch < 0 || !SDL_AtomicCAS(&watches[watch].stalled, 1, 0)) return 0;
+    return SDL_AtomicGet(&watches[watch].restarts);
+}
+
+static int watchdog_thread_main(void* data) {
+    (void)data;
+    while (!SDL_AtomicGet(&watchdog_quit)) {
+        SDL_SemWaitTimeout(watchdog_wake, WATCHDOG_INTERVAL_MS);
+        Uint32 now = SDL_GetTicks();
+        int count = SDL_min(SDL_AtomicGet(&watch_count), WATCHDOG_MAX_WATCHES);
+        for (int i = 0; i < count; i++) {
+            Watch* watch = &watches[i];
+            // A flagged watch waits for its owner to act
+            if (!SDL_AtomicGet(&watch->armed) || SDL_AtomicGet(&watch->stalled)) continue;
+            Uint32 silent = now - (Uint32)SDL_AtomicGet(&watch->last_beat);
+            if ((Sint32)silent <= (Sint32)watch->deadline_ms) continue;
+            SDL_AtomicSet(&watch->last_beat, (int)now); // The restart gets a full deadline of its own
+            SDL_AtomicAdd(&watch->restarts, 1);
+            SDL_AtomicAdd(&watch->stalls, 1);
+            SDL_AtomicSet(&watch->stalled, 1);
+            fprintf(stderr, "Watchdog: %s stalled for %u ms\n", watch->name, silent);
+        }
+    }
+    return 0;
+}
+
+int watchdog_start(void) {
+    SDL_AtomicSet(&watchdog_quit, 0);
+    watchdog_wake = SDL_CreateSemaphore(0);
+    watchdog_thread = watchdog_wake ? SDL_CreateThread(watchdog_thread_main, "watchdog", NULL) : NULL;
+    if (!watchdog_thread) {
+        fprintf(stderr, "Watchdog could not be started: %s\n", SDL_GetError());
         return -1;
     }
-    if (ret == 0) {
-        poll_timeout_count++;
-        if (poll_timeout_count >= POLL_TIMEOUT_THRESHOLD) {
-            printf("Board timeout\n");
-            return -1;
+    return 0;
+}
+
+void watchdog_stop(void) {
+    if (watchdog_thread) {
+        SDL_AtomicSet(&watchdog_quit, 1);
+        SDL_SemPost(watchdog_wake);
+        SDL_WaitThread(watchdog_thread, NULL);
+        watchdog_thread = NULL;
+    }
+    if (watchdog_wake) SDL_DestroySemaphore(watchdog_wake);
+    watchdog_wake = NULL;
+    int count = SDL_min(SDL_AtomicGet(&watch_count), WATCHDOG_MAX_WATCHES);
+    for (int i = 0; i < count; i++) {
+        int stalls = SDL_AtomicGet(&watches[i].stalls);
+        if (stalls) printf("Watchdog: %s stalled %d time%s\n", watches[i].name, stalls, stalls == 1 ? "" : "s");
+    }
+}
+
+// Post-mix hook while synthesis is off, so the mixer callback still beats
+static void audio_heartbeat_postmix(void* udata, Uint8* stream, int len) {
+    (void)udata; (void)stream; (void)len;
+    watchdog_beat(audio_watch);
+}
+
+/**
+ * @brief Closes and reopens the audio device. Runs on the audio keeper thread,
+ * so a driver that hangs in the close holds up neither rendering nor the
+ * watchdog. Sound effects wait on mixer_lock and music calls are skipped
+ * meanwhile. Loaded chunks stay valid because the device is reopened
+ * in the same format.
+ * @return 0 on success, -1 if the device could not be reopened.
+ */
+int audio_restart(void) {
+    SDL_LockMutex(mixer_lock);
+    int music_was_playing = audio_open && Mix_PlayingMusic();
+    Mix_HookMusicFinished(NULL); // Halting for the close must not queue the next track
+    synth_shutdown();
+    Mix_CloseAudio();
+    audio_open = Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, tuning.audio_buffer) == 0;
+    if (audio_open) {
+        if (station_count > 1 || synth_init() != 0) {
+            // Synthesis was available at startup, so the fallback samples were never loaded.
+            // Stations may be loading through the asset cache at the same time.
+            SDL_LockMutex(shared_asset_lock);
+            if (!target_sound) target_sound = load_shared_chunk("target.wav");
+            if (!reset_sound) reset_sound = load_shared_chunk("reset.wav");
+            SDL_UnlockMutex(shared_asset_lock);
+            Mix_SetPostMix(audio_heartbeat_postmix, NULL);
         }
-        return 0;
+        Mix_HookMusicFinished(music_intro_finished_callback);
+        // Which track was playing isn't tracked; the menu loop is the usual one
+        if (music_was_playing && main_loop_music) Mix_PlayMusic(main_loop_music, -1);
+    }
+    SDL_UnlockMutex(mixer_lock);
+    if (!audio_open) {
+        fprintf(stderr, "Failed to reopen audio: %s\n", Mix_GetError());
+        return -1;
     }
+    printf("Audio device reopened\n");
+    return 0;
+}
 
-    poll_timeout_count = 0;
-    int got_data = 0;
-    while (xwii_iface_dispatch(iface, &event, sizeof(event)) == 0) {
-        if (event.type == XWII_EVENT_BALANCE_BOARD) {
-            // Use correct mapping: TL=2, TR=0, BL=3, BR=1
-            float cells[4];
-            cells[0] = event.v.abs[2].x / 100.0f; // TL
-            cells[1] = event.v.abs[0].x / 100.0f; // TR
-            cells[2] = event.v.abs[3].x / 100.0f; // BL
-            cells[3] = event.v.abs[1].x / 100.0f; // BR
-            float total_weight = cells[0] + cells[1] + cells[2] + cells[3];
-            current_total_weight = total_weight * 100.0f;
-            printf("BB RAW: TL=%.2f TR=%.2f BL=%.2f BR=%.2f SUM=%.2f\n", cells[0], cells[1], cells[2], cells[3], total_weight);
-            if (current_total_weight > MIN_TOTAL_WEIGHT) {
-                *x_cob = (cells[1] + cells[3] - cells[0] - cells[2]) * 100.0f;
-                *y_cob = (cells[0] + cells[1] - cells[2] - cells[3]) * 100.0f;
-                if (fabsf(*x_cob) < DEAD_ZONE) *x_cob = 0;
-                if (fabsf(*y_cob) < DEAD_ZONE) *y_cob = 0;
-                got_data = 1;
-            }
+static int audio_keeper_main(void* data) {
+    (void)data;
+    while (!SDL_AtomicGet(&audio_keeper_quit)) {
+        SDL_SemWaitTimeout(audio_keeper_wake, WATCHDOG_INTERVAL_MS);
+        int stalls = watchdog_take_stall(audio_watch);
+        if (stalls > WATCHDOG_MAX_RESTARTS) {
+            fprintf(stderr, "Audio device did not recover, continuing without sound\n");
+            watchdog_disarm(audio_watch);
+        } else if (stalls) {
+            audio_restart();
         }
     }
-    if (got_data) {
-        printf("BB CoB: X=%.2f Y=%.2f Weight=%.2f\n", *x_cob, *y_cob, current_total_weight);
-        return 0;
-    } else {
-        *x_cob = 0; *y_cob = 0;
-        return 0;
+    return 0;
+}
+
+/**
+ * @brief Starts the thread that owns audio recovery. Without it a stalled device is only reported.
+ * @return 0 on success, -1 if the thread could not be started.
+ */
+int audio_keeper_start(void) {
+    SDL_AtomicSet(&audio_keeper_quit, 0);
+    audio_keeper_wake = SDL_CreateSemaphore(0);
+    audio_keeper_thread = audio_keeper_wake ? SDL_CreateThread(audio_keeper_main, "audio_keeper", NULL) : NULL;
+    if (!audio_keeper_thread) {
+        fprintf(stderr, "Audio keeper could not be started: %s\n", SDL_GetError());
+        return -1;
     }
+    return 0;
 }
 
-// --- Game Logic Functions ---
-void init_player(PlayerObject *player) {
-    player->x = WINDOW_WIDTH / 2.0f;
-    player->y = WINDOW_HEIGHT / 2.0f;
-    player->velocity_x = 0.0f;
-    player->velocity_y = 0.0f;
-    for (int i = 0; i < TRAIL_LENGTH; ++i) {
-        // Initialize trail points to player's starting position
-        trail_points[i].x = player->x;
-        trail_points[i].y = player->y;
+void audio_keeper_stop(void) {
+    if (audio_keeper_thread) {
+        SDL_AtomicSet(&audio_keeper_quit, 1);
+        SDL_SemPost(audio_keeper_wake);
+        SDL_WaitThread(audio_keeper_thread, NULL);
+        audio_keeper_thread = NULL;
     }
-    trail_head = 0;
+    if (audio_keeper_wake) SDL_DestroySemaphore(audio_keeper_wake);
+    audio_keeper_wake = NULL;
 }
 
-void init_balance_hold_game(PlayerObject *player, TargetObject *target) {
-    init_player(player);
-    target->x = (float)(rand() % (WINDOW_WIDTH - GAME_OBJECT_SIZE * 2)) + GAME_OBJECT_SIZE;
-    target->y = (float)(rand() % (WINDOW_HEIGHT - GAME_OBJECT_SIZE * 2)) + GAME_OBJECT_SIZE;
-    float movement_speed;
-    switch(current_difficulty) {
-        case EASY: movement_speed = BH_TARGET_MOVEMENT_SPEED_EASY; break;
-        case MEDIUM: movement_speed = BH_TARGET_MOVEMENT_SPEED_MEDIUM; break;
-        case HARD: default: movement_speed = BH_TARGET_MOVEMENT_SPEED_HARD; break;
+// --- Shared Asset Cache ---
+// Decoded assets (sound PCM, image pixels, the font file) are published in
+// POSIX shared memory so that concurrent game processes on one host keep a
+// single copy. Segments are named by an FNV-1a hash of the source file (plus
+// the mixer format for sounds), so a changed file gets a new segment. The
+// first process to load an asset decodes it and publishes it; the others map
+// the data read-only. The header page holds a reference count and the last
+// process to detach unlinks the segment. Publishing, attaching and unlinking
+// all happen under one flock()ed lock, so a segment found without its magic
+// was left by a publisher that died, and is removed. If shared memory is
+// unavailable, assets are loaded privately as before.
+
+Uint64 fnv1a64(const void* data, size_t size, Uint64 hash) {
+    const Uint8* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
     }
-    target->velocity_x = (rand() % 2 == 0) ? movement_speed : -movement_speed;
-    target->velocity_y = (rand() % 2 == 0) ? movement_speed : -movement_speed;
-    game_start_time = SDL_GetTicks();
-    hold_timer = 0.0f;
-    beeps_played = 0;
+    return hash;
 }
 
-void init_coin_collector_game(PlayerObject *player) {
-    init_player(player);
-    for (int i = 0; i < current_game_target; ++i) {
-        coin_collector_coins[i].active = 0;
+static size_t asset_cache_page_size(void) {
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? (size_t)page : 4096;
+}
+
+// Takes the cross-process cache lock. Returns 0 with the lock held, -1 if the cache is unusable.
+static int asset_cache_lock(void) {
+    if (asset_cache_lock_fd < 0) asset_cache_lock_fd = shm_open(ASSET_CACHE_LOCK, O_RDWR | O_CREAT, 0600);
+    if (asset_cache_lock_fd < 0) return -1;
+    while (flock(asset_cache_lock_fd, LOCK_EX) != 0) {
+        if (errno != EINTR) return -1;
     }
-    
-    // Spawn first coin far from player and not at edges
-    int spawned = 0;
-    while (!spawned) {
-        float new_coin_x = (float)(rand() % (WINDOW_WIDTH - COIN_SAFE_MARGIN * 2)) + COIN_SAFE_MARGIN;
-        float new_coin_y = (float)(rand() % (WINDOW_HEIGHT - COIN_SAFE_MARGIN * 2)) + COIN_SAFE_MARGIN;
-        
-        float dist_x = new_coin_x - player->x;
-        float dist_y = new_coin_y - player->y;
-        float distance = hypot(dist_x, dist_y);
+    return 0;
+}
+
+static void asset_cache_unlock(void) {
+    flock(asset_cache_lock_fd, LOCK_UN);
+}
+
+// Checks a description read from a segment or cache file against the bytes actually there
+static int asset_info_valid(char kind, const AssetInfo* info, size_t available) {
+    if (info->size > available) return 0;
+    if (kind != 'i') return 1;
+    return info->w > 0 && info->h > 0 && info->pitch >= info->w * 4 && (Uint64)info->pitch * info->h <= info->size;
+}
 
-        if (distance > COIN_SPAWN_MIN_DIST_PLAYER) {
-            coin_collector_coins[0].active = 1;
-            coin_collector_coins[0].x = new_coin_x;
-            coin_collector_coins[0].y = new_coin_y;
-            spawned = 1;
+// Maps an opened segment and records it. Called with the cache lock held.
+// Returns the data, or NULL if the segment is unusable; a segment left
+// incomplete or corrupt by another process is unlinked.
+static const void* asset_cache_map(int shm_fd, const char* name, char kind, int creating, const AssetInfo* info, const void* data, AssetInfo* info_out) {
+    if (asset_segment_count == ASSET_CACHE_MAX_SEGMENTS) return NULL;
+    size_t page = asset_cache_page_size();
+    if (creating && ftruncate(shm_fd, page + info->size) != 0) return NULL;
+    struct stat st;
+    if (fstat(shm_fd, &st) != 0) return NULL;
+    if ((size_t)st.st_size < page) {
+        // Its publisher died before sizing it
+        if (!creating) shm_unlink(name);
+        return NULL;
+    }
+    AssetHeader* header = mmap(NULL, page, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (header == MAP_FAILED) return NULL;
+
+    if (creating) {
+        void* pixels = mmap(NULL, info->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, page);
+        if (pixels == MAP_FAILED) {
+            munmap(header, page);
+            return NULL;
+        }
+        memcpy(pixels, data, info->size);
+        mprotect(pixels, info->size, PROT_READ);
+        header->info = *info;
+        __atomic_store_n(&header->refcount, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&header->magic, ASSET_CACHE_MAGIC, __ATOMIC_RELEASE);
+        data = pixels;
+    } else {
+        // Segments are only created under the lock, so one without magic will never be finished
+        if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != ASSET_CACHE_MAGIC ||
+            !asset_info_valid(kind, &header->info, (size_t)st.st_size - page)) {
+            fprintf(stderr, "Removing incomplete shared asset %s\n", name);
+            munmap(header, page);
+            shm_unlink(name);
+            return NULL;
+        }
+        __atomic_add_fetch(&header->refcount, 1, __ATOMIC_ACQ_REL);
+        data = mmap(NULL, header->info.size, PROT_READ, MAP_SHARED, shm_fd, page);
+        if (data == MAP_FAILED) {
+            __atomic_sub_fetch(&header->refcount, 1, __ATOMIC_ACQ_REL);
+            munmap(header, page);
+            return NULL;
         }
     }
 
-    game_start_time = SDL_GetTicks();
-    coins = 0;
-    // Only initialize timer in hard mode
-    if (current_difficulty == HARD) {
-        coin_timer = CC_COIN_TIMER;
+    AssetSegment* segment = &asset_segments[asset_segment_count++];
+    snprintf(segment->name, sizeof(segment->name), "%s", name);
+    segment->header = header;
+    segment->data = data;
+    segment->size = header->info.size;
+    segment->dev = st.st_dev;
+    segment->ino = st.st_ino;
+    if (info_out) *info_out = header->info;
+    return data;
+}
+
+static void asset_cache_name(char* name, size_t size, char kind, Uint64 key) {
+    snprintf(name, size, "%s%c-%016llx", ASSET_CACHE_PREFIX, kind, (unsigned long long)key);
+}
+
+/**
+ * @brief Maps an already published asset.
+ * @return Read-only data, or NULL if no process has published it yet.
+ */
+static const void* asset_cache_attach_locked(char kind, const char* name, AssetInfo* info_out) {
+    int shm_fd = shm_open(name, O_RDWR, 0);
+    if (shm_fd < 0) return NULL;
+    const void* data = asset_cache_map(shm_fd, name, kind, 0, NULL, NULL, info_out);
+    close(shm_fd);
+    return data;
+}
+
+const void* asset_cache_attach(char kind, Uint64 key, AssetInfo* info_out) {
+    char name[64];
+    asset_cache_name(name, sizeof(name), kind, key);
+    if (asset_cache_lock() != 0) return NULL;
+    const void* data = asset_cache_attach_locked(kind, name, info_out);
+    asset_cache_unlock();
+    return data;
+}
+
+/**
+ * @brief Publishes a decoded asset, or attaches to the copy another process published first.
+ * @return The shared read-only copy (described by info_out), or NULL if the caller should keep its own.
+ */
+const void* asset_cache_publish(char kind, Uint64 key, const AssetInfo* info, const void* data, AssetInfo* info_out) {
+    char name[64];
+    asset_cache_name(name, sizeof(name), kind, key);
+    if (asset_cache_lock() != 0) return NULL;
+    // Another process may have published it since this one looked; a stale segment is removed here
+    const void* shared = asset_cache_attach_locked(kind, name, info_out);
+    int shm_fd = shared ? -1 : shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm_fd >= 0) {
+        shared = asset_cache_map(shm_fd, name, kind, 1, info, data, info_out);
+        if (!shared) {
+            fprintf(stderr, "Could not publish %s to shared memory: %s\n", name, strerror(errno));
+            shm_unlink(name);
+        }
+        close(shm_fd);
     }
+    asset_cache_unlock();
+    return shared;
 }
 
-void init_dodge_game(PlayerObject *player) {
-    init_player(player);
-    for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
-        dodge_blocks[i].active = 0;
+// Unlinks a segment this process mapped, unless its name now belongs to a newer segment.
+static void asset_cache_unlink(const AssetSegment* segment) {
+    int shm_fd = shm_open(segment->name, O_RDONLY, 0);
+    if (shm_fd < 0) return;
+    struct stat st;
+    if (fstat(shm_fd, &st) == 0 && st.st_dev == segment->dev && st.st_ino == segment->ino) shm_unlink(segment->name);
+    close(shm_fd);
+}
+
+// Detaches from every segment; the last process attached to a segment removes it.
+void asset_cache_release_all(void) {
+    size_t page = asset_cache_page_size();
+    // Without the lock a segment is only detached; the next process reuses it
+    int locked = asset_segment_count > 0 && asset_cache_lock() == 0;
+    for (int i = 0; i < asset_segment_count; i++) {
+        AssetSegment* segment = &asset_segments[i];
+        munmap((void*)segment->data, segment->size);
+        if (__atomic_sub_fetch(&segment->header->refcount, 1, __ATOMIC_ACQ_REL) == 0 && locked) asset_cache_unlink(segment);
+        munmap(segment->header, page);
     }
-    block_spawn_timer = 0;
-    current_block_speed = BLOCK_INITIAL_SPEED;
-    dodge_score = 0;
-    game_start_time = SDL_GetTicks();
+    asset_segment_count = 0;
+    if (locked) asset_cache_unlock();
+    if (asset_cache_lock_fd >= 0) close(asset_cache_lock_fd);
+    asset_cache_lock_fd = -1;
 }
 
-void spawn_dodge_block() {
-    for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
-        if (!dodge_blocks[i].active) {
-            dodge_blocks[i].active = 1;
-            dodge_blocks[i].x = WINDOW_WIDTH + BLOCK_WIDTH;
-            dodge_blocks[i].y = (float)(rand() % (WINDOW_HEIGHT - BLOCK_HEIGHT));
-            dodge_blocks[i].speed = current_block_speed;
-            break;
+// Returns a file's contents and their FNV-1a hash. The caller frees the bytes with SDL_free.
+static void* asset_cache_read_source(const char* path, size_t* size, Uint64* key) {
+    void* bytes = SDL_LoadFile(path, size);
+    if (bytes) *key = fnv1a64(bytes, *size, ASSET_CACHE_FNV_OFFSET);
+    return bytes;
+}
+
+// Decoded asset from the disk cache (AssetInfo, then the data), published to
+// shared memory for the other processes when possible.
+static const void* asset_cache_load_disk(char kind, Uint64 key, AssetInfo* info_out) {
+    size_t size;
+    const Uint8* payload = render_cache_map(kind, key, &size);
+    AssetInfo info;
+    if (!payload || size < sizeof(info)) return NULL;
+    memcpy(&info, payload, sizeof(info));
+    if (info.size != size - sizeof(info) || !asset_info_valid(kind, &info, info.size)) return NULL;
+    const void* shared = asset_cache_publish(kind, key, &info, payload + sizeof(info), info_out);
+    if (shared) return shared;
+    *info_out = info;
+    return payload + sizeof(info);
+}
+
+static void asset_cache_store_disk(char kind, Uint64 key, const AssetInfo* info, const void* data) {
+    const void* parts[2] = {info, data};
+    size_t sizes[2] = {sizeof(*info), info->size};
+    render_cache_store(kind, key, parts, sizes, 2);
+}
+
+/**
+ * @brief Loads a sound effect, sharing its decoded PCM with other processes.
+ */
+Mix_Chunk* load_shared_chunk(const char* path) {
+    size_t size;
+    Uint64 key;
+    void* bytes = asset_cache_read_source(path, &size, &key);
+    if (!bytes) return NULL;
+    // PCM is stored in the mixer's output format, so that is part of the key
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    int spec[3] = {frequency, format, channels};
+    key = fnv1a64(spec, sizeof(spec), key);
+
+    AssetInfo info;
+    const void* pcm = asset_cache_attach('a', key, &info);
+    if (!pcm) pcm = asset_cache_load_disk('a', key, &info);
+    Mix_Chunk* chunk = NULL;
+    if (!pcm) {
+        chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(bytes, (int)size), 1);
+        if (chunk) {
+            AssetInfo decoded = {0, 0, 0, chunk->alen};
+            asset_cache_store_disk('a', key, &decoded, chunk->abuf);
+            pcm = asset_cache_publish('a', key, &decoded, chunk->abuf, &info);
         }
     }
+    SDL_free(bytes);
+    if (pcm) {
+        // Mix_FreeChunk leaves QuickLoad memory alone, so the mapping stays owned by the cache
+        if (chunk) Mix_FreeChunk(chunk);
+        chunk = Mix_QuickLoad_RAW((Uint8*)pcm, info.size);
+    }
+    return chunk;
 }
 
-// Checks if the player is within a specified radius of the target's center.
-int is_in_zone(PlayerObject player, TargetObject target, int zone_radius) {
-    float dx = player.x - target.x;
-    float dy = player.y - target.y;
-    float distance = hypot(dx, dy);
-    return distance <= zone_radius;
+/**
+ * @brief Decodes an image to ARGB8888, sharing the pixels with other processes.
+ * The returned surface is read-only when it is backed by shared memory.
+ */
+SDL_Surface* load_shared_image(const char* path) {
+    size_t size;
+    Uint64 key;
+    void* bytes = asset_cache_read_source(path, &size, &key);
+    if (!bytes) return NULL;
+
+    AssetInfo info;
+    const void* pixels = asset_cache_attach('i', key, &info);
+    if (!pixels) pixels = asset_cache_load_disk('i', key, &info);
+    SDL_Surface* surface = NULL;
+    if (!pixels) {
+        SDL_Surface* loaded = IMG_Load_RW(SDL_RWFromConstMem(bytes, (int)size), 1);
+        surface = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0) : NULL;
+        if (loaded) SDL_FreeSurface(loaded);
+        if (surface) {
+            AssetInfo decoded = {surface->w, surface->h, surface->pitch, (Uint32)(surface->pitch * surface->h)};
+            asset_cache_store_disk('i', key, &decoded, surface->pixels);
+            pixels = asset_cache_publish('i', key, &decoded, surface->pixels, &info);
+        }
+    }
+    SDL_free(bytes);
+    if (pixels) {
+        if (surface) SDL_FreeSurface(surface);
+        surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)pixels, info.w, info.h, 32, info.pitch, SDL_PIXELFORMAT_ARGB8888);
+    }
+    return surface;
 }
 
 /**
- * @brief Callback function to play main music after an intro track finishes.
+ * @brief Loads a whole file (the font), sharing the bytes with other processes.
+ * @return The bytes; *owned is set if the caller must SDL_free them.
  */
-void music_intro_finished_callback() {
-    if (!Mix_PlayingMusic() && main_loop_music) {
-        if (Mix_PlayMusic(main_loop_music, -1) == -1) {
-            fprintf(stderr, "Failed to play main_loop.wav after intro: %s\n", Mix_GetError());
-        }
+const void* load_shared_file(const char* path, size_t* size, int* owned) {
+    Uint64 key;
+    void* bytes = asset_cache_read_source(path, size, &key);
+    *owned = 0;
+    if (!bytes) return NULL;
+    AssetInfo info, raw = {0, 0, 0, (Uint32)*size};
+    const void* shared = asset_cache_publish('f', key, &raw, bytes, &info);
+    if (!shared) {
+        *owned = 1;
+        return bytes;
     }
+    SDL_free(bytes);
+    *size = info.size;
+    return shared;
 }
 
-// Update player position with physics simulation
-void update_player_position(PlayerObject* player, float target_x, float target_y, float delta_time) {
-    float force_x = (target_x - player->x) * SPRING_CONSTANT;
-    float force_y = (target_y - player->y) * SPRING_CONSTANT;
-    force_x -= player->velocity_x * DAMPING_FACTOR;
-    force_y -= player->velocity_y * DAMPING_FACTOR;
-    player->velocity_x += force_x * delta_time;
-    player->velocity_y += force_y * delta_time;
-    player->x += player->velocity_x * delta_time;
-    player->y += player->velocity_y * delta_time;
-    if (player->x < GAME_OBJECT_SIZE/2) { player->x = GAME_OBJECT_SIZE/2; player->velocity_x = 0; }
-    if (player->x > WINDOW_WIDTH - GAME_OBJECT_SIZE/2) { player->x = WINDOW_WIDTH - GAME_OBJECT_SIZE/2; player->velocity_x = 0; }
-    if (player->y < GAME_OBJECT_SIZE/2) { player->y = GAME_OBJECT_SIZE/2; player->velocity_y = 0; }
-    if (player->y > WINDOW_HEIGHT - GAME_OBJECT_SIZE/2) { player->y = WINDOW_HEIGHT - GAME_OBJECT_SIZE/2; player->velocity_y = 0; }
-    trail_points[trail_head] = *player;
-    trail_head = (trail_head + 1) % TRAIL_LENGTH;
+// Content hash of a source file, the base of every cache key derived from it
+int asset_source_key(const char* path, Uint64* key) {
+    size_t size;
+    void* bytes = asset_cache_read_source(path, &size, key);
+    if (!bytes) return -1;
+    SDL_free(bytes);
+    return 0;
 }
 
-// --- Main Program ---
-int main(int argc, char* argv[]) {
-    SDL_Window* window = NULL;
-    SDL_Renderer* renderer = NULL;
-    TTF_Font* font_score = NULL;
-    TTF_Font* font_tutorial = NULL;
-    TTF_Font* font_menu_title = NULL;
-    TTF_Font* font_menu_description = NULL;
-    
-    // Declaring all variables at the beginning of main() to fix the compilation error
-    int quit = 0;
-    SDL_Event event_sdl;
-    PlayerObject player;
-    TargetObject target;
-    float x_cob = 0.0, y_cob = 0.0;
-    GameState state = CONNECTING;
-    Uint32 last_frame_time = 0;
-    Uint32 last_input_time = 0;
-    float pulse_timer = 0.0f;
-    SDL_Color start_color, end_color, textColor;
-    SDL_Rect viewport_rect;
-    int text_w, text_h;
+// --- Render Resource Disk Cache ---
+// Shared memory is gone after a reboot, so decoded assets and generated render
+// resources (the packed sprite atlas, the distance field atlas) are also kept
+// in RENDER_CACHE_DIR. Each file is named by its kind and a hash of everything
+// it was generated from: source file contents, sizes, renderer limits and
+// generation constants. A changed input simply misses and writes a new file.
+// Files are mapped copy-on-write, so a resource that keeps growing at run time
+// can be used in place. Files are written under a temporary name and renamed,
+// so a power cut never leaves a truncated file under a valid name.
+
+static void render_cache_path(char* path, size_t size, char kind, Uint64 key) {
+    snprintf(path, size, "%s/%c-%016llx.bin", RENDER_CACHE_DIR, kind, (unsigned long long)key);
+}
 
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
-        fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError()); return 1;
+/**
+ * @brief Maps a cached resource. The mapping lasts until render_cache_release_all().
+ * Callers hold shared_asset_lock once stations run.
+ * @return The writable (copy-on-write) payload, or NULL on a miss.
+ */
+void* render_cache_map(char kind, Uint64 key, size_t* size_out) {
+    if (render_cache_map_count == RENDER_CACHE_MAX_FILES) return NULL;
+    char path[128];
+    render_cache_path(path, sizeof(path), kind, key);
+    int file_fd = open(path, O_RDONLY);
+    if (file_fd < 0) return NULL;
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(file_fd, &st) == 0 && (size_t)st.st_size >= sizeof(RenderCacheHeader)) {
+        map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_fd, 0);
     }
-    if (TTF_Init() == -1) {
-        fprintf(stderr, "SDL_ttf could not initialize! TTF_Error: %s\n", TTF_GetError()); SDL_Quit(); return 1;
+    close(file_fd);
+    if (map == MAP_FAILED) return NULL;
+    const RenderCacheHeader* header = map;
+    if (header->magic != RENDER_CACHE_MAGIC || header->version != RENDER_CACHE_VERSION || header->kind != (Uint16)kind ||
+        header->key != key || header->size != (Uint64)st.st_size - sizeof(RenderCacheHeader)) {
+        munmap(map, st.st_size);
+        return NULL;
     }
-    if (Mix_Init(MIX_INIT_MP3 | MIX_INIT_OGG) != (MIX_INIT_MP3 | MIX_INIT_OGG)) {
-        fprintf(stderr, "SDL_mixer could not initialize! Mix_Error: %s\n", Mix_GetError());
+    render_cache_maps[render_cache_map_count++] = (RenderCacheMapping){map, (size_t)st.st_size};
+    *size_out = header->size;
+    return (Uint8*)map + sizeof(RenderCacheHeader);
+}
+
+/**
+ * @brief Writes a resource to the cache as the concatenation of count parts.
+ * @return 0 on success, -1 if it could not be written (the cache is only an optimisation).
+ */
+int render_cache_store(char kind, Uint64 key, const void* const* parts, const size_t* sizes, int count) {
+    if (mkdir(RENDER_CACHE_DIR, 0755) != 0 && errno != EEXIST) {
+        perror("Failed to create " RENDER_CACHE_DIR);
+        return -1;
     }
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        fprintf(stderr, "SDL_mixer could not open audio! Mix_Error: %s\n", Mix_GetError());
+    char path[128], temp_path[160];
+    render_cache_path(path, sizeof(path), kind, key);
+    // Stations of one process may write the same resource at once
+    snprintf(temp_path, sizeof(temp_path), "%s.%d.%lu.tmp", path, (int)getpid(), (unsigned long)SDL_ThreadID());
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        perror("Failed to write render cache");
+        return -1;
     }
-    if (IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) == 0) {
-        fprintf(stderr, "SDL_image could not initialize! IMG_Error: %s\n", IMG_GetError());
-        Mix_CloseAudio(); TTF_Quit(); SDL_Quit(); return 1;
+    RenderCacheHeader header = {RENDER_CACHE_MAGIC, RENDER_CACHE_VERSION, (Uint16)kind, key, 0};
+    for (int i = 0; i < count; i++) header.size += sizes[i];
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < count && ok; i++) ok = sizes[i] == 0 || fwrite(parts[i], sizes[i], 1, file) == 1;
+    // Flush to the disk before the rename makes the file visible
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) != 0) ok = 0;
+    if (!ok || rename(temp_path, path) != 0) {
+        perror("Failed to write render cache");
+        unlink(temp_path);
+        return -1;
     }
+    return 0;
+}
 
-    coin_sound = Mix_LoadWAV("coin.mp3");
-    win_sound = Mix_LoadWAV("win.mp3");
-    select_sound = Mix_LoadWAV("select.mp3");
-    target_sound = Mix_LoadWAV("target.wav");
-    reset_sound = Mix_LoadWAV("reset.wav"); // NEW: Load reset sound
-    connection_intro_music = Mix_LoadMUS("connection_intro.wav");
-    connection_main_music = Mix_LoadMUS("connection_main.wav");
-    transition_music = Mix_LoadMUS("transition.wav");
-    main_intro_music = Mix_LoadMUS("main_intro.wav");
-    main_loop_music = Mix_LoadMUS("main_loop.wav");
+void render_cache_release_all(void) {
+    for (int i = 0; i < render_cache_map_count; i++) munmap(render_cache_maps[i].map, render_cache_maps[i].size);
+    render_cache_map_count = 0;
+}
 
-    if (!coin_sound || !win_sound || !select_sound || !target_sound || !reset_sound || !connection_intro_music || !connection_main_music || !transition_music || !main_intro_music || !main_loop_music) {
-        fprintf(stderr, "One or more audio files failed to load. Please check file paths. Mix_Error: %s\n", Mix_GetError());
+// --- Stations ---
+// With --stations N one process drives N board-and-display stations. Each
+// station's simulation runs on its own thread, pinned to its own core. The
+// main thread owns every window, renderer and the SDL event queue: it hands
+// each station its keyboard events and draws all of them, taking a station's
+// lock while it reads that station's state. Sounds, tuning, decoded images and
+// the font file are loaded once and shared read-only.
+
+// Reserves a board device path for this station. Returns 0 if no other station has it.
+int board_claim(const char* path) {
+    int result = -1, free_slot = -1, taken = 0;
+    SDL_LockMutex(shared_asset_lock);
+    for (int i = 0; i < MAX_STATIONS; i++) {
+        if (claimed_boards[i][0] && strcmp(claimed_boards[i], path) == 0) taken = 1;
+        else if (!claimed_boards[i][0] && free_slot < 0) free_slot = i;
+    }
+    if (!taken && free_slot >= 0) {
+        snprintf(claimed_boards[free_slot], sizeof(claimed_boards[free_slot]), "%s", path);
+        station->claimed_board = free_slot;
+        result = 0;
     }
+    SDL_UnlockMutex(shared_asset_lock);
+    return result;
+}
 
-    // Set callback for intro music ending
-    Mix_HookMusicFinished(music_intro_finished_callback);
+void board_release(void) {
+    if (station->claimed_board < 0) return;
+    SDL_LockMutex(shared_asset_lock);
+    claimed_boards[station->claimed_board][0] = '\0';
+    SDL_UnlockMutex(shared_asset_lock);
+    station->claimed_board = -1;
+}
 
-    if (connection_intro_music && Mix_PlayMusic(connection_intro_music, 0) == -1) {
-        fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
+// Returns the decoded ARGB8888 image, loading it on first use. Callers hold
+// shared_asset_lock, since blitting from a surface updates its blit mapping.
+SDL_Surface* shared_image(const char* path) {
+    for (int i = 0; i < shared_image_count; i++) {
+        if (strcmp(shared_images[i].path, path) == 0) return shared_images[i].surface;
     }
+    if (shared_image_count == MAX_SPRITES) {
+        fprintf(stderr, "Shared image cache full, cannot load %s\n", path);
+        return NULL;
+    }
+    SDL_Surface* surface = load_shared_image(path);
+    if (!surface) return NULL;
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    SharedImage* image = &shared_images[shared_image_count++];
+    snprintf(image->path, sizeof(image->path), "%s", path);
+    image->surface = surface;
+    return surface;
+}
 
-    window = SDL_CreateWindow("Wii Fit Balance Game", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_FULLSCREEN_DESKTOP | SDL_WINDOW_SHOWN);
-    if (!window) { fprintf(stderr, "Window could not be created! SDL_Error: %s\n", SDL_GetError()); goto cleanup; }
-    // Enable vsync for smoother rendering
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) { fprintf(stderr, "Renderer could not be created! SDL_Error: %s\n", SDL_GetError()); goto cleanup; }
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    SDL_ShowCursor(SDL_DISABLE);
+void cleanup_shared_images(void) {
+    for (int i = 0; i < shared_image_count; i++) SDL_FreeSurface(shared_images[i].surface);
+    shared_image_count = 0;
+}
 
-    boardpower_texture = IMG_LoadTexture(renderer, "boardpower.png");
-    coin_texture = IMG_LoadTexture(renderer, "coin.png");
-    for (int i = 0; i < num_players; i++) {
-        player_textures[i] = IMG_LoadTexture(renderer, available_players[i].image_path);
-        if (!player_textures[i]) {
-            fprintf(stderr, "Failed to load player texture: %s. IMG_Error: %s\n", available_players[i].image_path, IMG_GetError());
+// Opens FONT_FILE at the given size from the shared copy of its bytes.
+TTF_Font* open_shared_font(int size) {
+    // FreeType's library handle is not thread-safe, so faces are created one at a time
+    SDL_LockMutex(shared_asset_lock);
+    TTF_Font* font = shared_font_data ? TTF_OpenFontRW(SDL_RWFromConstMem(shared_font_data, (int)shared_font_size), 1, size)
+                                      : TTF_OpenFont(FONT_FILE, size);
+    SDL_UnlockMutex(shared_asset_lock);
+    return font;
+}
+
+void close_shared_font(TTF_Font* font) {
+    if (!font) return;
+    SDL_LockMutex(shared_asset_lock);
+    TTF_CloseFont(font);
+    SDL_UnlockMutex(shared_asset_lock);
+}
+
+// Pins the calling simulation thread to its own core. Core 0 is left to the
+// main thread, which draws every station, unless there are too few cores.
+static void station_pin_to_core(int index) {
+    int cpus = SDL_max(SDL_GetCPUCount(), 1);
+    int core = cpus > station_count ? index + 1 : index % cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err) fprintf(stderr, "Station %d: could not pin to core %d: %s\n", index + 1, core, strerror(err));
+}
+
+// Applies one SDL event to the current station. Main thread, station locked.
+static void station_handle_event(const SDL_Event* event_sdl) {
+    if (event_sdl->type == SDL_QUIT) station->quit = 1;
+    if (event_sdl->type == SDL_RENDER_TARGETS_RESET) {
+        station->hud_layer.valid = 0;
+        ink_trail_reset();
+    }
+    if (event_sdl->type == SDL_RENDER_DEVICE_RESET) {
+        // Both are recreated on their next draw
+        cleanup_hud_layer();
+        cleanup_ink_trail();
+    }
+    if (event_sdl->type == SDL_KEYDOWN) {
+        if (event_sdl->key.keysym.sym == SDLK_ESCAPE) station->quit = 1;
+        if (event_sdl->key.keysym.sym == SDLK_F1) station->show_board_stats = !station->show_board_stats;
+        if (event_sdl->key.keysym.sym == SDLK_F2) {
+            station->ghost_enabled = !station->ghost_enabled;
+            if (!station->ghost_enabled) ghost_close();
         }
     }
-    if (!boardpower_texture || !coin_texture) {
-        fprintf(stderr, "Failed to load one or more image textures. IMG_Error: %s\n", IMG_GetError());
+}
+
+// Main thread: hands a key press to the station whose window has focus, and
+// window-less events such as SDL_QUIT and render resets to every station.
+void station_route_event(const SDL_Event* event_sdl) {
+    Uint32 window_id = event_sdl->type == SDL_KEYDOWN ? event_sdl->key.windowID : 0;
+    for (int i = 0; i < station_count; i++) {
+        Station* s = stations[i];
+        if (!s || !s->window || (window_id && SDL_GetWindowID(s->window) != window_id)) continue;
+        station = s;
+        SDL_LockMutex(s->lock);
+        station_handle_event(event_sdl);
+        SDL_UnlockMutex(s->lock);
     }
+}
 
-    font_score = TTF_OpenFont("shingom.otf", TITLE_FONT_SIZE);
-    font_tutorial = TTF_OpenFont("shingom.otf", TUTORIAL_FONT_SIZE);
-    font_menu_title = TTF_OpenFont("shingom.otf", MENU_TITLE_FONT_SIZE);
-    font_menu_description = TTF_OpenFont("shingom.otf", MENU_DESCRIPTION_FONT_SIZE);
-    if (!font_score || !font_tutorial || !font_menu_title || !font_menu_description) {
-        fprintf(stderr, "Failed to load font 'shingom.otf'! TTF_Error: %s\n", TTF_GetError());
+// Waits out the rest of the frame against a running deadline, so the
+// whole-millisecond SDL_Delay doesn't round 16.67 ms frames down to 16 ms.
+static void frame_limit(Uint64* next_frame_counter) {
+    Uint64 counter_frequency = SDL_GetPerformanceFrequency();
+    Uint64 now_counter = SDL_GetPerformanceCounter();
+    *next_frame_counter += counter_frequency / tuning.target_fps;
+    if (*next_frame_counter > now_counter) {
+        SDL_Delay((Uint32)((*next_frame_counter - now_counter) * 1000 / counter_frequency));
+    } else {
+        *next_frame_counter = now_counter; // Behind schedule: don't race to catch up
     }
+}
 
-    // Initialize with default player (will be updated when player is selected)
-    lowest_time_to_win = -1.0f;
-    total_wins = 0;
-    last_frame_time = SDL_GetTicks();
-    last_input_time = SDL_GetTicks();
-    connection_start_time = SDL_GetTicks();
-    init_player(&player);
+// --- Main Program ---
+/**
+ * @brief Advances the current station by one frame: board input, gestures and
+ * the game itself. Runs on the station's simulation thread with its lock held,
+ * or on the main thread when it is the only station.
+ * @return Non-zero once the station should quit.
+ */
+int station_update(void) {
+    Uint32 current_time = SDL_GetTicks();
+    float delta_time = (float)(current_time - station->last_frame_time) / 1000.0f;
+    station->last_frame_time = current_time;
+
+    if (station->state != station->published_state) {
+        event_publish((GameEvent){.type = EVENT_STATE_CHANGE, .data.state = {(Uint8)station->published_state, (Uint8)station->state, (Uint8)station->state_cause}});
+        station->published_state = station->state;
+        station->state_cause = STATE_CAUSE_NONE;
+    }
 
-    while (!quit) {
-        Uint32 frame_start = SDL_GetTicks();
-        
-        Uint32 current_time = SDL_GetTicks();
-        float delta_time = (float)(current_time - last_frame_time) / 1000.0f;
-        last_frame_time = current_time;
+    station->hold_progress = 0.0f;
+    station->pulse_scale = 1.0f;
+    station->render_offset_x = 0;
+    station->render_offset_y = 0;
+
+    // --- Game Logic based on State ---
+    // DEBUG: Print CoB and weight every frame
+    printf("DEBUG: x_cob=%.2f y_cob=%.2f total_weight=%.2f\n", station->x_cob, station->y_cob, station->current_total_weight);
+    if (bench.active) {
+        // Drive the game from the next recorded sample instead of the board
+        station->last_input_time = current_time;
+        if ((station->state == GAME_BALANCE_HOLD || station->state == GAME_COIN_COLLECTOR) && bench_next_input(&station->x_cob, &station->y_cob, &delta_time) != 0) {
+            reset_game_state();
+            station->state = MAIN_MENU;
+        } else if (station->state == WINNING && ++bench.win_frames > BENCH_WIN_FRAMES) {
+            reset_game_state();
+            station->state = MAIN_MENU;
+        }
+        if (station->state != GAME_BALANCE_HOLD && station->state != GAME_COIN_COLLECTOR && station->state != WINNING) {
+            if (bench_open_next(&station->selected_game, &station->current_difficulty, &station->selected_player_index) != 0) {
+                station->quit = 1;
+                return station->quit;
+            }
+            station->state = (station->selected_game == BALANCE_HOLD) ? GAME_BALANCE_HOLD : GAME_COIN_COLLECTOR;
+            station->current_game_target = game_target_for(station->selected_game, station->current_difficulty);
+            sim_seed(bench.recording.seed); // Same targets and coins as the recorded run
+            if (station->state == GAME_BALANCE_HOLD) init_balance_hold_game(&station->player, &station->balance_hold_target);
+            else init_coin_collector_game(&station->player);
+            station->coins = 0;
+            station->session_time_ms = 0;
+            ghost_open(station->selected_game, station->current_difficulty, station->selected_player_index);
+            bench_next_input(&station->x_cob, &station->y_cob, &delta_time);
+        }
+        if (station->state == WINNING) delta_time = 1.0f / TARGET_FPS;
+    } else if (station->state != CONNECTING && read_wii_balance_board_data(&station->x_cob, &station->y_cob) != 0) {
+        // Disconnection detected - keep the last snapshot so a quick reconnect can continue the game
+        if ((station->state == GAME_BALANCE_HOLD || station->state == GAME_COIN_COLLECTOR || station->state == GAME_DODGE) && station->snapshot_front >= 0) {
+            station->resume_available = 1;
+            station->resume_deadline = SDL_GetTicks() + RESUME_GRACE_SECONDS * 1000;
+        }
+        event_publish((GameEvent){.type = EVENT_DISCONNECT, .data.disconnect.resumable = (Uint8)station->resume_available});
+        reset_game_state();
+        station->state = CONNECTING;
+        station->connection_start_time = SDL_GetTicks(); // Reset connection timer
+        if (connection_intro_music && music_play(connection_intro_music, 0) == -1) {
+             fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
+        }
+        return station->quit;
+    }
 
-        while (SDL_PollEvent(&event_sdl) != 0) {
-            if (event_sdl.type == SDL_QUIT) quit = 1;
-            if (event_sdl.type == SDL_KEYDOWN) {
-                if (event_sdl.key.keysym.sym == SDLK_ESCAPE) quit = 1;
+    // React to step-on/step-off edges as soon as they are confirmed
+    StepEvent step_event;
+    while (step_detector_poll(&step_event)) {
+        int in_game = (station->state == GAME_BALANCE_HOLD || station->state == GAME_COIN_COLLECTOR || station->state == GAME_DODGE);
+        if (step_event.type == STEP_OFF) {
+            if (in_game && !station->game_paused) {
+                printf("Player stepped off. Pausing.\n");
+                station->game_paused = 1;
+                station->pause_start_time = step_event.time;
+            }
+        } else {
+            station->last_input_time = step_event.time;
+            station->menu_select_timer = 0.0f;
+            if (station->game_paused && !station->resume_countdown_active) {
+                printf("Player stepped back on. Resuming.\n");
+                // Don't count the paused time towards the win time
+                station->game_start_time += step_event.time - station->pause_start_time;
+                station->game_paused = 0;
             }
         }
+    }
+    if (station->resume_countdown_active && current_time - station->resume_countdown_start >= RESUME_COUNTDOWN_SECONDS * 1000) {
+        station->resume_countdown_active = 0;
+        // Stay in the normal pause if the station->player hasn't stepped back on yet
+        if (station->step_detector.on_board) {
+            station->game_start_time += current_time - station->pause_start_time;
+            station->game_paused = 0;
+        }
+    }
+    if (station->game_paused && station->state != GAME_BALANCE_HOLD && station->state != GAME_COIN_COLLECTOR && station->state != GAME_DODGE) {
+        station->game_paused = 0;
+    }
 
-        float hold_progress = 0.0f;
-        float pulse_scale = 1.0f;
-        int render_offset_x = 0;
-        int render_offset_y = 0;
+    if (station->state != CONNECTING) {
+        gesture_update(&station->gesture, station->x_cob, station->y_cob, station->current_total_weight, delta_time);
+    }
 
-        // --- Game Logic based on State ---
-        // DEBUG: Print CoB and weight every frame
-        printf("DEBUG: x_cob=%.2f y_cob=%.2f total_weight=%.2f\n", x_cob, y_cob, current_total_weight);
-        if (state != CONNECTING && read_wii_balance_board_data(&x_cob, &y_cob) != 0) {
-            // Disconnection detected
+    // Handle inactivity timeout - measured from the moment the station->player stepped off
+    if (station->state != CONNECTING && station->state != TRANSITIONING && !station->step_detector.on_board) {
+        if (current_time - station->last_input_time > INACTIVITY_TIMEOUT_SECONDS * 1000) {
+            station->state_cause = STATE_CAUSE_INACTIVITY;
             reset_game_state();
-            state = CONNECTING;
-            connection_start_time = SDL_GetTicks(); // Reset connection timer
-            if (connection_intro_music && Mix_PlayMusic(connection_intro_music, 0) == -1) {
+            station->state = CONNECTING;
+            station->connection_start_time = SDL_GetTicks(); // Reset connection timer
+            if (connection_intro_music && music_play(connection_intro_music, 0) == -1) {
                  fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
             }
-            continue;
         }
+    } else {
+        station->last_input_time = current_time;
+    }
 
-        // Handle inactivity timeout - check for minimal weight or activity
-        if (state != CONNECTING && state != TRANSITIONING && current_total_weight < MIN_TOTAL_WEIGHT) {
-            if (current_time - last_input_time > INACTIVITY_TIMEOUT_SECONDS * 1000) {
-                printf("Inactivity timeout. Returning to connecting screen.\n");
-                reset_game_state();
-                state = CONNECTING;
-                connection_start_time = SDL_GetTicks(); // Reset connection timer
-                if (connection_intro_music && Mix_PlayMusic(connection_intro_music, 0) == -1) {
-                     fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
+    switch (station->state) {
+        case CONNECTING:
+            if (music_playing() == 0) {
+                if (connection_intro_music && music_play(connection_intro_music, 0) == -1) {
+                    fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
                 }
             }
-        } else {
-            last_input_time = current_time;
-        }
-
-        switch (state) {
-            case CONNECTING:
-                if (Mix_PlayingMusic() == 0) {
-                    if (connection_intro_music && Mix_PlayMusic(connection_intro_music, 0) == -1) {
-                        fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
+            if (station->resume_available && (Sint32)(SDL_GetTicks() - station->resume_deadline) > 0) {
+                printf("Resume grace period expired. Discarding interrupted game.\n");
+                station->resume_available = 0;
+                station->snapshot_front = -1;
+                recorder_discard();
+                ghost_close();
+            }
+            if (init_xwiimote_non_blocking() == 0) {
+                if (station->resume_available) {
+                    station->resume_available = 0;
+                    if (snapshot_restore(&station->state, &station->player) == 0) {
+                        printf("Board reconnected. Resuming interrupted game.\n");
+                        music_halt();
+                        break;
                     }
                 }
-                if (init_xwiimote_non_blocking() == 0) {
-                    state = TRANSITIONING;
-                    Mix_HaltMusic();
-                    if (transition_music && Mix_PlayMusic(transition_music, 0) == -1) {
-                         fprintf(stderr, "Failed to play transition.wav: %s\n", Mix_GetError());
-                    }
-                    transition_start_time = SDL_GetTicks();
+                station->state = TRANSITIONING;
+                music_halt();
+                if (transition_music && music_play(transition_music, 0) == -1) {
+                     fprintf(stderr, "Failed to play transition.wav: %s\n", Mix_GetError());
                 }
-                break;
+                station->transition_start_time = SDL_GetTicks();
+            }
+            break;
 
-            case TRANSITIONING:
-                {
-                    float elapsed = (float)(SDL_GetTicks() - transition_start_time) / 1000.0f;
-                    if (elapsed >= TRANSITION_DURATION) {
-                        state = PLAYER_SELECTION; // Go to player selection after transition
-                        Mix_HaltMusic();
-                        if (main_intro_music && Mix_PlayMusic(main_intro_music, 0) == -1) {
-                            fprintf(stderr, "Failed to play main_intro.wav: %s\n", Mix_GetError());
-                        }
-                    } else {
-                        float shake_progress = elapsed / TRANSITION_DURATION;
-                        shake_intensity = (shake_progress < 0.5f) ? (shake_progress * 2.0f * 20.0f) : ((1.0f - shake_progress) * 2.0f * 20.0f);
-                        render_offset_x = (rand() % (int)(shake_intensity + 1)) - (shake_intensity / 2);
-                        render_offset_y = (rand() % (int)(shake_intensity + 1)) - (shake_intensity / 2);
+        case TRANSITIONING:
+            {
+                float elapsed = (float)(SDL_GetTicks() - station->transition_start_time) / 1000.0f;
+                if (elapsed >= TRANSITION_DURATION) {
+                    station->state = PLAYER_SELECTION; // Go to station->player selection after transition
+                    music_halt();
+                    if (main_intro_music && music_play(main_intro_music, 0) == -1) {
+                        fprintf(stderr, "Failed to play main_intro.wav: %s\n", Mix_GetError());
                     }
+                } else {
+                    float shake_progress = elapsed / TRANSITION_DURATION;
+                    station->shake_intensity = (shake_progress < 0.5f) ? (shake_progress * 2.0f * 20.0f) : ((1.0f - shake_progress) * 2.0f * 20.0f);
+                    station->render_offset_x = (fx_rand() % (int)(station->shake_intensity + 1)) - (station->shake_intensity / 2);
+                    station->render_offset_y = (fx_rand() % (int)(station->shake_intensity + 1)) - (station->shake_intensity / 2);
                 }
-                break;
+            }
+            break;
 
-            case PLAYER_SELECTION:
-                if (!Mix_PlayingMusic()) {
-                    if (main_loop_music && Mix_PlayMusic(main_loop_music, -1) == -1) {
-                        fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
-                    }
-                }
-                int prev_player_selection_choice = player_selection_choice;
-                player_selection_choice = 0;
-                if (current_total_weight > MIN_TOTAL_WEIGHT) {
-                    if (x_cob < -200) player_selection_choice = 1; // Left
-                    else if (fabsf(x_cob) < 150) player_selection_choice = 2; // Center
-                    else if (x_cob > 200) player_selection_choice = 3; // Right
+        case PLAYER_SELECTION:
+            if (!music_playing()) {
+                if (main_loop_music && music_play(main_loop_music, -1) == -1) {
+                    fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
                 }
+            }
+            if (update_lean_menu(&station->player_selection_choice, 0, delta_time)) {
+                station->selected_player_index = station->player_selection_choice - 1;
+                // Reset and load profile-specific save data (pre-loaded during the dwell when possible)
+                ProfileStats profile_stats;
+                commit_profile_stats(MAIN_MENU, station->selected_player_index, &profile_stats);
+                station->lowest_time_to_win = profile_stats.lowest_time;
+                station->total_wins = profile_stats.total_wins;
+                station->dodge_high_score = 0; // Reset dodge score until game is selected
+                printf("Loaded profile for %s: best_time=%.2f, total_wins=%d\n", 
+                       available_players[station->selected_player_index].name, station->lowest_time_to_win, station->total_wins);
+                station->state = MAIN_MENU;
+                station->menu_select_timer = 0.0f;
+                gesture_reset(&station->gesture);
+                event_publish((GameEvent){.type = EVENT_MENU_SELECT});
+            } else if (station->player_selection_choice != 0) {
+                prewarm_predict(MAIN_MENU, station->player_selection_choice - 1, NO_GAME_SELECTED, EASY);
+            } else {
+                prewarm_cancel();
+            }
+            break;
 
-                if (player_selection_choice != prev_player_selection_choice) {
-                    menu_select_timer = 0.0f;
-                }
-                if (player_selection_choice != 0) {
-                    menu_select_timer += delta_time;
+        case MAIN_MENU:
+            if (!music_playing()) {
+                if (main_loop_music && music_play(main_loop_music, -1) == -1) {
+                    fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
                 }
+            }
 
-                if (menu_select_timer >= MENU_SELECT_TIME_REQUIRED) {
-                    selected_player_index = player_selection_choice - 1;
-                    // Reset and load profile-specific save data
-                    lowest_time_to_win = read_lowest_time(get_profile_filename("score.txt", selected_player_index));
-                    total_wins = read_total_wins(get_profile_filename("wins.txt", selected_player_index));
-                    dodge_high_score = 0; // Reset dodge score until game is selected
-                    printf("Loaded profile for %s: best_time=%.2f, total_wins=%d\n", 
-                           available_players[selected_player_index].name, lowest_time_to_win, total_wins);
-                    state = MAIN_MENU;
-                    menu_select_timer = 0.0f;
-                    Mix_PlayChannel(-1, select_sound, 0);
+            {
+                static const GameType lean_games[] = {NO_GAME_SELECTED, BALANCE_HOLD, DODGE, COIN_COLLECTOR};
+                int game_choice = station->stability_selected ? 4 : 0;
+                for (int i = 1; i < 4; i++) {
+                    if (lean_games[i] == station->selected_game) game_choice = i;
                 }
-                break;
-
-            case MAIN_MENU:
-                if (!Mix_PlayingMusic()) {
-                    if (main_loop_music && Mix_PlayMusic(main_loop_music, -1) == -1) {
-                        fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
-                    }
+                int confirmed = update_lean_menu(&game_choice, 1, delta_time);
+                station->stability_selected = (game_choice == 4);
+                station->selected_game = station->stability_selected ? NO_GAME_SELECTED : lean_games[game_choice];
+                if (!confirmed) {
+                    if (station->selected_game == NO_GAME_SELECTED) prewarm_cancel();
+                    else prewarm_predict(station->selected_game == DODGE ? GAME_DODGE : DIFFICULTY_SELECTION, station->selected_player_index, station->selected_game, EASY);
+                    break;
                 }
-
-                GameType prev_selected_game = selected_game;
-                selected_game = NO_GAME_SELECTED;
-                if (current_total_weight > MIN_TOTAL_WEIGHT) {
-                    if (x_cob < -200) selected_game = BALANCE_HOLD;
-                    else if (fabsf(x_cob) < 150) selected_game = DODGE;
-                    else if (x_cob > 200) selected_game = COIN_COLLECTOR;
+                if (station->stability_selected) {
+                    prewarm_cancel();
+                    station->stability_selected = 0;
+                    station->state = GAME_STABILITY;
+                    stability_begin();
+                } else if (station->selected_game == DODGE) {
+                    station->state = GAME_DODGE;
+                    ProfileStats profile_stats;
+                    commit_profile_stats(GAME_DODGE, station->selected_player_index, &profile_stats);
+                    station->dodge_high_score = profile_stats.dodge_high_score;
+                    sim_seed(sim_new_seed());
+                    init_dodge_game(&station->player);
+                } else {
+                    prewarm_cancel();
+                    station->state = DIFFICULTY_SELECTION;
                 }
+                station->menu_select_timer = 0.0f;
+                gesture_reset(&station->gesture);
+                event_publish((GameEvent){.type = EVENT_MENU_SELECT});
+            }
+            break;
 
-                if (selected_game != prev_selected_game) {
-                    menu_select_timer = 0.0f;
-                }
-                if (selected_game != NO_GAME_SELECTED) {
-                    menu_select_timer += delta_time;
+        case DIFFICULTY_SELECTION:
+            if (!music_playing()) {
+                if (main_loop_music && music_play(main_loop_music, -1) == -1) {
+                    fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
                 }
+            }
 
-                if (menu_select_timer >= MENU_SELECT_TIME_REQUIRED) {
-                    if (selected_game == DODGE) {
-                        state = GAME_DODGE;
-                        dodge_high_score = read_dodge_high_score(get_profile_filename("dodge_score.txt", selected_player_index));
-                        init_dodge_game(&player);
-                    } else {
-                        state = DIFFICULTY_SELECTION;
-                    }
-                    menu_select_timer = 0.0f;
-                    Mix_PlayChannel(-1, select_sound, 0);
+            if (update_lean_menu(&station->difficulty_selection, 0, delta_time)) {
+                switch(station->difficulty_selection) {
+                    case 1: station->current_difficulty = EASY; break;
+                    case 2: station->current_difficulty = MEDIUM; break;
+                    case 3: station->current_difficulty = HARD; break;
                 }
-                break;
-
-            case DIFFICULTY_SELECTION:
-                if (!Mix_PlayingMusic()) {
-                    if (main_loop_music && Mix_PlayMusic(main_loop_music, -1) == -1) {
-                        fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
-                    }
+                prewarm_cancel();
+                if (station->selected_game == BALANCE_HOLD) {
+                    station->state = GAME_BALANCE_HOLD;
+                    station->current_game_target = game_target_for(BALANCE_HOLD, station->current_difficulty);
+                    sim_seed(sim_new_seed());
+                    init_balance_hold_game(&station->player, &station->balance_hold_target); // Use the new target for Balance Hold
+                    station->coins = 0; // Reset coins for a new game
+                    station->session_time_ms = 0;
+                    recorder_start(BALANCE_HOLD, station->current_difficulty);
+                    ghost_open(BALANCE_HOLD, station->current_difficulty, station->selected_player_index);
+                } else if (station->selected_game == COIN_COLLECTOR) {
+                    station->state = GAME_COIN_COLLECTOR;
+                    station->current_game_target = game_target_for(COIN_COLLECTOR, station->current_difficulty);
+                    sim_seed(sim_new_seed());
+                    init_coin_collector_game(&station->player);
+                    station->coins = 0; // Reset coins for a new game
+                    station->session_time_ms = 0;
+                    recorder_start(COIN_COLLECTOR, station->current_difficulty);
+                    ghost_open(COIN_COLLECTOR, station->current_difficulty, station->selected_player_index);
+                } else if (station->selected_game == DODGE) {
+                    station->state = GAME_DODGE;
+                    sim_seed(sim_new_seed());
+                    init_dodge_game(&station->player);
                 }
+                station->menu_select_timer = 0.0f;
+                gesture_reset(&station->gesture);
+                event_publish((GameEvent){.type = EVENT_MENU_SELECT});
+            } else if (station->difficulty_selection != 0) {
+                GameState next_state = (station->selected_game == BALANCE_HOLD) ? GAME_BALANCE_HOLD :
+                                       (station->selected_game == COIN_COLLECTOR) ? GAME_COIN_COLLECTOR : GAME_DODGE;
+                prewarm_predict(next_state, station->selected_player_index, station->selected_game, (Difficulty)(station->difficulty_selection - 1));
+            } else {
+                prewarm_cancel();
+            }
+            break;
 
-                int prev_difficulty_selection = difficulty_selection;
-                difficulty_selection = 0;
-                if (current_total_weight > MIN_TOTAL_WEIGHT) {
-                    if (x_cob < -200) difficulty_selection = 1;
-                    else if (fabsf(x_cob) < 150) difficulty_selection = 2;
-                    else if (x_cob > 200) difficulty_selection = 3;
-                }
+        case GAME_BALANCE_HOLD:
+        case GAME_COIN_COLLECTOR:
+            if (station->game_paused) break;
+            // Calculate target position for movement using COB_SCALE_GENERAL
+            float target_x_general = sim_cob_target(station->x_cob, COB_SCALE_GENERAL, WINDOW_WIDTH);
+            float target_y_general = sim_cob_target(station->y_cob, -COB_SCALE_GENERAL, WINDOW_HEIGHT);
 
-                if (difficulty_selection != prev_difficulty_selection) {
-                    menu_select_timer = 0.0f;
+            if (!music_playing()) {
+                if (main_loop_music && music_play(main_loop_music, -1) == -1) {
+                    fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
                 }
-                if (difficulty_selection != 0) {
-                    menu_select_timer += delta_time;
+            }
+            // Update station->player movement
+            update_player_position(&station->player, target_x_general, target_y_general, delta_time);
+
+            // Record this frame and move the ghost along the best run
+            station->session_time_ms += sim_step_ms(delta_time);
+            recorder_write(station->session_time_ms, &station->player, station->x_cob, station->y_cob, station->current_total_weight, station->coins);
+            if (bench.active) bench_check_frame(&station->player);
+            ghost_advance(station->session_time_ms);
+
+            {
+                ModeFrame frame = {station->hold_progress, station->pulse_scale};
+                ModeOutcome outcome = mode_update_for(station->state, station->current_difficulty)(&station->player, station->x_cob, delta_time, &frame);
+                station->hold_progress = frame.hold_progress;
+                station->pulse_scale = frame.pulse_scale;
+                if (outcome == MODE_TIME_UP) {
+                    // Game over, return to menu
+                    station->state_cause = STATE_CAUSE_TIME_UP;
+                    reset_game_state();
+                    station->state = MAIN_MENU;
+                    return station->quit;
                 }
+                if (outcome == MODE_WON) station->state = WINNING;
+            }
+
+            if (station->state == WINNING) {
+                station->win_message_start_time = SDL_GetTicks();
+                float win_time = (float)(station->win_message_start_time - station->game_start_time) / 1000.0f;
+                int new_best = (station->lowest_time_to_win == -1.0f || win_time < station->lowest_time_to_win);
+                if (new_best) station->lowest_time_to_win = win_time;
+                station->total_wins++; // NEW: Increment total wins
+                // Win sound, score and wins files and the recording are handled by the consumers
+                event_publish((GameEvent){.type = EVENT_RUN_WON, .data.won = {win_time, station->total_wins, (Uint8)new_best}});
+                ghost_close();
+                init_confetti(station->player.x, station->player.y);
+            }
+            break;
 
-                if (menu_select_timer >= MENU_SELECT_TIME_REQUIRED) {
-                    switch(difficulty_selection) {
-                        case 1: current_difficulty = EASY; break;
-                        case 2: current_difficulty = MEDIUM; break;
-                        case 3: current_difficulty = HARD; break;
+        case GAME_DODGE:
+            if (station->state != GAME_DODGE || station->game_paused) break;
+            
+            // Calculate target position for movement using COB_SCALE_DODGE
+            float target_x_dodge = sim_cob_target(station->x_cob, COB_SCALE_DODGE, WINDOW_WIDTH);
+            float target_y_dodge = sim_cob_target(station->y_cob, -COB_SCALE_DODGE, WINDOW_HEIGHT);
+            SimStep dodge_step = sim_step(delta_time);
+
+            // Only update station->player movement if there's actual input
+            if (station->current_total_weight > MIN_TOTAL_WEIGHT && (fabsf(station->x_cob) > DEAD_ZONE || fabsf(station->y_cob) > DEAD_ZONE)) {
+                update_player_position(&station->player, target_x_dodge, target_y_dodge, delta_time);
+            }
+            
+            // Enhanced Dodge mode logic
+            for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
+                if (station->dodge_blocks[i].active) {
+                    station->dodge_blocks[i].x = sim_advance(station->dodge_blocks[i].x, -station->dodge_blocks[i].speed, dodge_step);
+                    if (station->dodge_blocks[i].x + BLOCK_WIDTH < 0) {
+                        station->dodge_blocks[i].active = 0;
+                        station->dodge_score++;
+                        int new_high_score = station->dodge_score > station->dodge_high_score;
+                        if (new_high_score) station->dodge_high_score = station->dodge_score;
+                        event_publish((GameEvent){.type = EVENT_BLOCK_PASSED, .data.score = {station->dodge_score, new_high_score}});
                     }
-                    if (selected_game == BALANCE_HOLD) {
-                        state = GAME_BALANCE_HOLD;
-                        current_game_target = (current_difficulty == EASY) ? 10 : (current_difficulty == HARD) ? 25 : 15;
-                        init_balance_hold_game(&player, &balance_hold_target); // Use the new target for Balance Hold
-                        coins = 0; // Reset coins for a new game
-                    } else if (selected_game == COIN_COLLECTOR) {
-                        state = GAME_COIN_COLLECTOR;
-                        current_game_target = (current_difficulty == EASY) ? 15 : (current_difficulty == HARD) ? 30 : 20;
-                        init_coin_collector_game(&player);
-                        coins = 0; // Reset coins for a new game
-                    } else if (selected_game == DODGE) {
-                        state = GAME_DODGE;
-                        init_dodge_game(&player);
+                    SDL_Rect block_rect = {
+                        (int)station->dodge_blocks[i].x,
+                        (int)station->dodge_blocks[i].y,
+                        BLOCK_WIDTH,
+                        BLOCK_HEIGHT
+                    };
+                    SDL_Rect player_rect = {
+                        (int)(station->player.x - GAME_OBJECT_SIZE / 2),
+                        (int)(station->player.y - GAME_OBJECT_SIZE / 2),
+                        GAME_OBJECT_SIZE,
+                        GAME_OBJECT_SIZE
+                    };
+                    if (SDL_HasIntersection(&block_rect, &player_rect)) {
+                        station->state = WINNING;
+                        event_publish((GameEvent){.type = EVENT_BLOCK_HIT});
+                        break;
                     }
-                    menu_select_timer = 0.0f;
-                    Mix_PlayChannel(-1, select_sound, 0);
                 }
-                break;
+            }
+            station->block_spawn_timer = sim_advance(station->block_spawn_timer, 1.0f, dodge_step);
+            if (station->block_spawn_timer >= station->dynamic_block_spawn_interval) {
+                spawn_dodge_block();
+                station->block_spawn_timer = 0;
+            }
+            station->current_block_speed = sim_advance(station->current_block_speed, BLOCK_SPEED_INCREMENT, dodge_step);
+            station->dynamic_block_spawn_interval = fmax(0.5f, sim_advance(station->dynamic_block_spawn_interval, -0.01f, dodge_step));
+            break;
 
-            case GAME_BALANCE_HOLD:
-            case GAME_COIN_COLLECTOR:
-                // Calculate target position for movement using COB_SCALE_GENERAL
-                float target_x_general = (WINDOW_WIDTH / 2.0f) + x_cob * COB_SCALE_GENERAL * WINDOW_WIDTH;
-                float target_y_general = (WINDOW_HEIGHT / 2.0f) + y_cob * -COB_SCALE_GENERAL * WINDOW_HEIGHT;
+        case GAME_STABILITY:
+            if (!music_playing()) {
+                if (main_loop_music && music_play(main_loop_music, -1) == -1) {
+                    fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
+                }
+            }
+            if (stability_update()) {
+                station->state = MAIN_MENU;
+                station->menu_select_timer = 0.0f;
+                gesture_reset(&station->gesture);
+            }
+            break;
 
-                if (!Mix_PlayingMusic()) {
-                    if (main_loop_music && Mix_PlayMusic(main_loop_music, -1) == -1) {
-                        fprintf(stderr, "Failed to play main_loop.wav: %s\n", Mix_GetError());
+        case WINNING:
+            update_confetti(delta_time);
+            
+            if (SDL_GetTicks() - station->win_message_start_time > WIN_ANIMATION_DURATION) {
+                // Handle game-specific cleanup
+                if (station->dodge_score > 0) {
+                    station->block_spawn_timer = 0;
+                    station->current_block_speed = BLOCK_INITIAL_SPEED;
+                    station->dynamic_block_spawn_interval = BLOCK_SPAWN_INTERVAL;
+                    for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
+                        station->dodge_blocks[i].active = 0;
                     }
+                    station->dodge_score = 0;
                 }
-                // Update player movement
-                update_player_position(&player, target_x_general, target_y_general, delta_time);
-
-                if (state == GAME_BALANCE_HOLD) {
-                    // Update target position based on difficulty
-                    balance_hold_target.x += balance_hold_target.velocity_x * delta_time;
-                    balance_hold_target.y += balance_hold_target.velocity_y * delta_time;
-                    // Bounce off walls
-                    if (balance_hold_target.x < BH_GRACE_ZONE_RADIUS || balance_hold_target.x > WINDOW_WIDTH - BH_GRACE_ZONE_RADIUS) {
-                        balance_hold_target.velocity_x *= -1;
-                    }
-                    if (balance_hold_target.y < BH_GRACE_ZONE_RADIUS || balance_hold_target.y > WINDOW_HEIGHT - BH_GRACE_ZONE_RADIUS) {
-                        balance_hold_target.velocity_y *= -1;
-                    }
+                
+                reset_game_state();
+                // Reset profile-specific data when returning to station->player selection
+                station->lowest_time_to_win = -1.0f;
+                station->total_wins = 0;
+                station->dodge_high_score = 0;
+                station->selected_player_index = -1;
+                station->state = PLAYER_SELECTION;
+                init_player(&station->player);
+            }
+            break;
+    }
 
-                    // Score counting logic
-                    if (is_in_zone(player, balance_hold_target, BH_HOLD_RADIUS)) {
-                        hold_timer += delta_time;
-                    } else {
-                        hold_timer = 0;
-                        beeps_played = 0;
-                        Mix_PlayChannel(-1, reset_sound, 0);
-                    }
-                    
-                    hold_progress = hold_timer / BH_HOLD_TIME_REQUIRED;
-                    if (hold_progress > 1.0f) hold_progress = 1.0f;
-                    
-                    if (hold_timer >= BH_HOLD_TIME_REQUIRED) {
-                        coins++;
-                        if (target_sound) Mix_PlayChannel(-1, target_sound, 0);
-                        if (coins >= current_game_target) {
-                            state = WINNING;
-                        } else {
-                            init_balance_hold_game(&player, &balance_hold_target);
-                        }
-                    }
+    // Silence the hold tone whenever Balance Hold isn't actively being played
+    if (station->state != GAME_BALANCE_HOLD || station->game_paused) {
+        synth_set_tone(SYNTH_BASE_FREQUENCY, 0.0f, 0.0f);
+    }
 
-                    pulse_timer += delta_time;
-                    pulse_scale = 1.0f + 0.3f * sinf(pulse_timer * BH_TARGET_PULSE_SPEED);
-                } else { // GAME_COIN_COLLECTOR
-                    // Only check timer in hard mode
-                    if (current_difficulty == HARD) {
-                        coin_timer -= delta_time;
-                        if (coin_timer <= 0) {
-                            // Game over, return to menu
-                            printf("Time's up! Returning to menu.\n");
-                            reset_game_state();
-                            state = MAIN_MENU;
-                            continue;
-                        }
-                    }
+    // Keep the resume snapshot current while a game is being played
+    if (station->state == GAME_BALANCE_HOLD || station->state == GAME_COIN_COLLECTOR || station->state == GAME_DODGE) {
+        snapshot_capture(station->state, &station->player);
+    }
 
-                    for (int i = 0; i < current_game_target; ++i) {
-                        if (coin_collector_coins[i].active) {
-                             // Adjust coin hitbox size to make it easier to collect
-                             if (is_in_zone(player, (TargetObject){coin_collector_coins[i].x, coin_collector_coins[i].y, 0, 0}, STARTING_COIN_SIZE * 1.2)) {
-                                coin_collector_coins[i].active = 0;
-                                coins++;
-                                Mix_PlayChannel(-1, coin_sound, 0);
-                                if (coins < current_game_target) {
-                                    int next_coin_index = (i + 1);
-                                    // Spawn next coin far from player and not at edges
-                                    int spawned_next_coin = 0;
-                                    while (!spawned_next_coin) {
-                                        float new_coin_x = (float)(rand() % (WINDOW_WIDTH - COIN_SAFE_MARGIN * 2)) + COIN_SAFE_MARGIN;
-                                        float new_coin_y = (float)(rand() % (WINDOW_HEIGHT - COIN_SAFE_MARGIN * 2)) + COIN_SAFE_MARGIN;
-                                        
-                                        float dist_x = new_coin_x - player.x;
-                                        float dist_y = new_coin_y - player.y;
-                                        float distance = hypot(dist_x, dist_y);
-
-                                        if (distance > COIN_SPAWN_MIN_DIST_PLAYER) {
-                                            coin_collector_coins[next_coin_index].active = 1;
-                                            coin_collector_coins[next_coin_index].x = new_coin_x;
-                                            coin_collector_coins[next_coin_index].y = new_coin_y;
-                                            spawned_next_coin = 1;
-                                        }
-                                    }
-
-                                    if (current_difficulty == HARD) {
-                                        coin_timer = CC_COIN_TIMER; // Reset timer only in hard mode
-                                    }
-                                } else {
-                                    state = WINNING;
-                                }
-                            }
-                        }
-                    }
-                }
+    // --- Performance Optimizations ---
+    // Optimized debug output
+    if (++station->debug_frame_counter >= DEBUG_INTERVAL) {
+        snprintf(station->debug_buffer, sizeof(station->debug_buffer),
+                "DEBUG: x_cob=%.2f y_cob=%.2f weight=%.2f fps=%.1f\n",
+                station->x_cob, station->y_cob, station->current_total_weight, 1000.0f / delta_time);
+        fputs(station->debug_buffer, stdout);
+        if (station->iface) {
+            char stats_buffer[256];
+            board_stats_format(stats_buffer, sizeof(stats_buffer));
+            printf("BOARD: %s\n", stats_buffer);
+        }
+        station->debug_frame_counter = 0;
+    }
 
-                if (state == WINNING) {
-                    Mix_HaltChannel(-1);
-                    Mix_PlayChannel(-1, win_sound, 0);
-                    win_message_start_time = SDL_GetTicks();
-                    float win_time = (float)(win_message_start_time - game_start_time) / 1000.0f;
-                    if (lowest_time_to_win == -1.0f || win_time < lowest_time_to_win) {
-                        lowest_time_to_win = win_time;
-                        write_lowest_time(get_profile_filename("score.txt", selected_player_index), lowest_time_to_win);
-                    }
-                    total_wins++; // NEW: Increment total wins
-                    write_total_wins(get_profile_filename("wins.txt", selected_player_index), total_wins); // NEW: Save total wins
-                    init_confetti(player.x, player.y);
+    return station->quit;
+}
+
+/**
+ * @brief Draws the current station's frame into its renderer, without presenting
+ * it. Main thread only, with the station's lock held.
+ * @return 1 if a frame was drawn, 0 while the window is minimized.
+ */
+int station_draw(void) {
+    SDL_Renderer* renderer = station->renderer;
+    SDL_Texture* scene_target = station->scene_target;
+    TTF_Font* font_score = station->font_score;
+    TTF_Font* font_tutorial = station->font_tutorial;
+    TTF_Font* font_menu_title = station->font_menu_title;
+    TTF_Font* font_menu_description = station->font_menu_description;
+    SDL_Color start_color, end_color, textColor;
+    SDL_Rect viewport_rect;
+    int text_w, text_h;
+
+    watchdog_beat(station->render_watch);
+    if (watchdog_take_stall(station->render_watch)) {
+        // A frame that hung in the driver may have lost its targets; rebuild them as after a device reset
+        cleanup_hud_layer();
+        cleanup_ink_trail();
+    }
+
+    // Use the rest of the dwell to prepare the screen the player is heading to
+    if (station->state == PLAYER_SELECTION || station->state == MAIN_MENU || station->state == DIFFICULTY_SELECTION) {
+        prewarm_warm_text(renderer, font_menu_title, font_menu_description, font_score);
+    }
+
+    // Render only if the window is visible
+    if (SDL_GetWindowFlags(station->window) & SDL_WINDOW_MINIMIZED) return 0;
+    if (scene_target) {
+        SDL_SetRenderTarget(renderer, scene_target);
+        SDL_RenderSetScale(renderer, tuning.render_scale, tuning.render_scale);
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    soft_raster_begin_frame(renderer);
+
+    if (station->state == GAME_BALANCE_HOLD) { start_color = (SDL_Color){200, 255, 200, 255}; end_color = (SDL_Color){100, 200, 100, 255}; } // Green Gradient
+    else if (station->state == GAME_COIN_COLLECTOR) { start_color = (SDL_Color){255, 255, 255, 255}; end_color = (SDL_Color){173, 216, 230, 255}; } // Blue/White Gradient
+    else if (station->state == GAME_DODGE) { start_color = (SDL_Color){40, 40, 40, 255}; end_color = (SDL_Color){0, 0, 0, 255}; } // Black Gradient
+    else { start_color = (SDL_Color){240, 240, 240, 255}; end_color = (SDL_Color){200, 200, 200, 255}; } // Default gray gradient
+    draw_gradient_background(renderer, start_color, end_color);
+
+    viewport_rect = (station->state == TRANSITIONING) ? (SDL_Rect){station->render_offset_x, station->render_offset_y, WINDOW_WIDTH, WINDOW_HEIGHT} : (SDL_Rect){0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_RenderSetViewport(renderer, &viewport_rect);
+
+    switch(station->state) {
+        case CONNECTING:
+            textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            // Adjust connecting text and image positions
+            if (station->boardpower_sprite) {
+                int img_width = BOARDPOWER_WIDTH;
+                int img_height = BOARDPOWER_HEIGHT;
+                int img_x = (WINDOW_WIDTH - img_width) / 2;
+                int img_y = (WINDOW_HEIGHT / 2) - 250; // Updated y position for image
+                SDL_Rect rect = {img_x, img_y, img_width, img_height};
+                draw_sprite(renderer, station->boardpower_sprite, &rect, 255);
+            }
+
+            // Draw connecting text below the image
+            draw_centered_text(renderer, font_tutorial, "Connecting to Wii Balance Board...", (WINDOW_HEIGHT / 2) + 250, textColor);
+            if (station->resume_available) {
+                draw_centered_text(renderer, font_menu_description, "Reconnect the board to continue your game", (WINDOW_HEIGHT / 2) + 340, textColor);
+            }
+            break;
+        case TRANSITIONING:
+            // Background shake is handled by viewport
+            break;
+        case PLAYER_SELECTION:
+            textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_centered_text(renderer, font_menu_title, "Select Player", 150, textColor);
+            if (!station->step_detector.on_board) {
+                draw_centered_text(renderer, font_menu_description, "Step on the board to begin", 250, textColor);
+            }
+
+            int base_y = WINDOW_HEIGHT / 2 + 100;
+            int positions[] = {WINDOW_WIDTH / 4, WINDOW_WIDTH / 2, WINDOW_WIDTH * 3 / 4};
+            const char* instructions[] = {"Lean Left", "Stay Centered", "Lean Right"};
+
+            for (int i = 0; i < num_players; i++) {
+                int text_width, text_height;
+
+                if (station->player_sprites[i]) {
+                    SDL_Rect img_rect = {positions[i] - PLAYER_PORTRAIT_SIZE / 2, base_y - 200, PLAYER_PORTRAIT_SIZE, PLAYER_PORTRAIT_SIZE};
+                    draw_sprite(renderer, station->player_sprites[i], &img_rect, 255);
                 }
-                break;
 
-            case GAME_DODGE:
-                if (state != GAME_DODGE) break;
-                
-                // Calculate target position for movement using COB_SCALE_DODGE
-                float target_x_dodge = (WINDOW_WIDTH / 2.0f) + x_cob * COB_SCALE_DODGE * WINDOW_WIDTH;
-                float target_y_dodge = (WINDOW_HEIGHT / 2.0f) + y_cob * -COB_SCALE_DODGE * WINDOW_HEIGHT;
+                text_size(font_menu_title, available_players[i].name, &text_width, &text_height);
+                int x_pos = positions[i] - (text_width / 2);
 
-                // Only update player movement if there's actual input
-                if (current_total_weight > MIN_TOTAL_WEIGHT && (fabsf(x_cob) > DEAD_ZONE || fabsf(y_cob) > DEAD_ZONE)) {
-                    update_player_position(&player, target_x_dodge, target_y_dodge, delta_time);
+                if (station->player_selection_choice == (i + 1)) {
+                    textColor = (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(station->menu_select_timer * 10))};
+                } else {
+                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
                 }
+                draw_text(renderer, font_menu_title, available_players[i].name, x_pos, base_y, textColor);
+
+                text_size(font_menu_description, instructions[i], &text_w, &text_h);
+                x_pos = positions[i] - (text_w / 2);
+                draw_text(renderer, font_menu_description, instructions[i], x_pos, base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+            }
+            break;
+        case MAIN_MENU:
+            textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_centered_text(renderer, font_menu_title, "Select Game", 150, textColor);
+
+            int menu_base_y = WINDOW_HEIGHT / 2;
+            int menu_x_left = WINDOW_WIDTH / 4;
+            int menu_x_center = WINDOW_WIDTH / 2;
+            int menu_x_right = WINDOW_WIDTH * 3 / 4;
+            
+            // Balance Hold Option
+            text_size(font_menu_title, "Balance Hold", &text_w, &text_h);
+            textColor = (station->selected_game == BALANCE_HOLD) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(station->menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_text(renderer, font_menu_title, "Balance Hold", menu_x_left - text_w/2, menu_base_y, textColor);
+            text_size(font_menu_description, "Lean left to select.", &text_w, &text_h);
+            draw_text(renderer, font_menu_description, "Lean left to select.", menu_x_left - text_w/2, menu_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+
+            // Dodge Option
+            text_size(font_menu_title, "Dodge", &text_w, &text_h);
+            textColor = (station->selected_game == DODGE) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(station->menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_text(renderer, font_menu_title, "Dodge", menu_x_center - text_w/2, menu_base_y, textColor);
+            text_size(font_menu_description, "Stay centered to select.", &text_w, &text_h);
+            draw_text(renderer, font_menu_description, "Stay centered to select.", menu_x_center - text_w/2, menu_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+
+            // Coin Collector Option
+            text_size(font_menu_title, "Coin Collector", &text_w, &text_h);
+            textColor = (station->selected_game == COIN_COLLECTOR) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(station->menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_text(renderer, font_menu_title, "Coin Collector", menu_x_right - text_w/2, menu_base_y, textColor);
+            text_size(font_menu_description, "Lean right to select.", &text_w, &text_h);
+            draw_text(renderer, font_menu_description, "Lean right to select.", menu_x_right - text_w/2, menu_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+
+            // Limits of Stability Option
+            textColor = station->stability_selected ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(station->menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_centered_text(renderer, font_menu_description, "Lean forward for the Limits of Stability test.", menu_base_y - 150, textColor);
+
+            // NEW: Display total wins
+            char total_wins_text[50];
+            snprintf(total_wins_text, 50, "Total Wins: %d", station->total_wins);
+            draw_centered_text(renderer, font_menu_description, total_wins_text, menu_base_y + 200, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+            break;
+        case DIFFICULTY_SELECTION:
+            textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_centered_text(renderer, font_menu_title, "Select Difficulty", 150, textColor);
+
+            int diff_base_y = WINDOW_HEIGHT / 2;
+            int diff_positions[] = {WINDOW_WIDTH / 4, WINDOW_WIDTH / 2, WINDOW_WIDTH * 3 / 4};
+            const char* difficulties[] = {"Easy", "Medium", "Hard"};
+            const char* diff_instructions[] = {"Lean Left", "Stay Centered", "Lean Right"};
+
+            for (int i = 0; i < 3; i++) {
+                int text_width, text_height;
+                text_size(font_menu_title, difficulties[i], &text_width, &text_height);
+                int x_pos = diff_positions[i] - (text_width / 2);
+                
+                textColor = (station->difficulty_selection == (i + 1)) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(station->menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
                 
-                // Enhanced Dodge mode logic
-                for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
-                    if (dodge_blocks[i].active) {
-                        dodge_blocks[i].x -= dodge_blocks[i].speed * delta_time;
-                        if (dodge_blocks[i].x + BLOCK_WIDTH < 0) {
-                            dodge_blocks[i].active = 0;
-                            dodge_score++;
-                            if (dodge_score > dodge_high_score) {
-                                dodge_high_score = dodge_score;
-                                write_dodge_high_score(get_profile_filename("dodge_score.txt", selected_player_index), dodge_high_score);
-                            }
-                        }
-                        SDL_Rect block_rect = {
-                            (int)dodge_blocks[i].x,
-                            (int)dodge_blocks[i].y,
-                            BLOCK_WIDTH,
-                            BLOCK_HEIGHT
-                        };
-                        SDL_Rect player_rect = {
-                            (int)(player.x - GAME_OBJECT_SIZE / 2),
-                            (int)(player.y - GAME_OBJECT_SIZE / 2),
-                            GAME_OBJECT_SIZE,
-                            GAME_OBJECT_SIZE
-                        };
-                        if (SDL_HasIntersection(&block_rect, &player_rect)) {
-                            state = WINNING;
-                            Mix_PlayChannel(-1, reset_sound, 0);
-                            break;
-                        }
+                // Draw the difficulty text centered at its position
+                draw_text(renderer, font_menu_title, difficulties[i], x_pos, diff_base_y, textColor);
+                
+                // Draw the instruction text below, also centered
+                text_size(font_menu_description, diff_instructions[i], &text_width, &text_height);
+                x_pos = diff_positions[i] - (text_width / 2);
+                draw_text(renderer, font_menu_description, diff_instructions[i], x_pos, diff_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
+            }
+            break;
+        case GAME_BALANCE_HOLD:
+        case GAME_COIN_COLLECTOR:
+            draw_ghost(renderer, station->selected_player_index != -1 ? station->player_sprites[station->selected_player_index] : NULL);
+            draw_line_trail(renderer); // MODIFIED: Call the new line trail function
+            draw_middle_grid(renderer);
+
+            if (station->state == GAME_BALANCE_HOLD) {
+                // Draw the larger, semi-transparent "grace zone" circle
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 50); // Semi-transparent white
+                draw_filled_circle(renderer, roundf(station->balance_hold_target.x), roundf(station->balance_hold_target.y), BH_GRACE_ZONE_RADIUS);
+
+                // Draw the solid inner target circle
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                draw_filled_circle(renderer, roundf(station->balance_hold_target.x), roundf(station->balance_hold_target.y), roundf(BH_HOLD_RADIUS * station->pulse_scale));
+
+                // Draw a pulsating outline that shows hold progress
+                SDL_SetRenderDrawColor(renderer, 95, 215, 11, 255); // Changed to solid green
+                draw_outlined_circle(renderer, roundf(station->balance_hold_target.x), roundf(station->balance_hold_target.y), roundf(BH_HOLD_RADIUS * (1.0f + 0.5f * station->hold_progress)), 5);
+
+
+            } else { // GAME_COIN_COLLECTOR
+                for (int i = 0; i < station->current_game_target; ++i) {
+                    if (station->coin_collector_coins[i].active) {
+                         SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255); // Gold color for coins
+                         SDL_Rect coin_rect = {roundf(station->coin_collector_coins[i].x - STARTING_COIN_SIZE/2), roundf(station->coin_collector_coins[i].y - STARTING_COIN_SIZE/2), STARTING_COIN_SIZE, STARTING_COIN_SIZE};
+                         if (station->coin_sprite) {
+                             draw_sprite(renderer, station->coin_sprite, &coin_rect, 255);
+                         } else {
+                             SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255);
+                             draw_filled_circle(renderer, roundf(station->coin_collector_coins[i].x), roundf(station->coin_collector_coins[i].y), STARTING_COIN_SIZE/2);
+                         }
                     }
                 }
-                block_spawn_timer += delta_time;
-                if (block_spawn_timer >= dynamic_block_spawn_interval) {
-                    spawn_dodge_block();
-                    block_spawn_timer = 0;
-                }
-                current_block_speed += BLOCK_SPEED_INCREMENT * delta_time;
-                dynamic_block_spawn_interval = fmax(0.5f, dynamic_block_spawn_interval - (0.01f * delta_time));
-                break;
+            }
 
-            case WINNING:
-                update_confetti(delta_time);
-                
-                if (SDL_GetTicks() - win_message_start_time > WIN_ANIMATION_DURATION) {
-                    // Handle game-specific cleanup
-                    if (dodge_score > 0) {
-                        block_spawn_timer = 0;
-                        current_block_speed = BLOCK_INITIAL_SPEED;
-                        dynamic_block_spawn_interval = BLOCK_SPAWN_INTERVAL;
-                        for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
-                            dodge_blocks[i].active = 0;
-                        }
-                        dodge_score = 0;
-                    }
-                    
-                    reset_game_state();
-                    // Reset profile-specific data when returning to player selection
-                    lowest_time_to_win = -1.0f;
-                    total_wins = 0;
-                    dodge_high_score = 0;
-                    selected_player_index = -1;
-                    state = PLAYER_SELECTION;
-                    init_player(&player);
+            // Draw Player
+            if (station->selected_player_index != -1 && station->player_sprites[station->selected_player_index]) {
+                SDL_Rect player_rect = {roundf(station->player.x - GAME_OBJECT_SIZE / 2.0f), roundf(station->player.y - GAME_OBJECT_SIZE / 2.0f), GAME_OBJECT_SIZE, GAME_OBJECT_SIZE};
+                draw_sprite(renderer, station->player_sprites[station->selected_player_index], &player_rect, 255);
+            } else {
+                // MODIFIED: Draw station->player with the new color #D45351
+                SDL_SetRenderDrawColor(renderer, TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255);
+                draw_filled_circle(renderer, roundf(station->player.x), roundf(station->player.y), GAME_OBJECT_SIZE / 2);
+            }
+
+            {
+                HudValues hud = {station->state, station->selected_player_index, station->coins, station->current_game_target, -1, -1};
+                if (station->state == GAME_BALANCE_HOLD) {
+                    hud.hold_fill = (int)(BH_HOLD_BAR_WIDTH * station->hold_progress);
+                } else if (difficulty_configs[station->current_difficulty].coin_timer > 0.0f) {
+                    // Only timed difficulties show the timer
+                    hud.timer_tenths = station->coin_timer > 0 ? (int)(station->coin_timer * 10.0f) : 0;
                 }
-                break;
-        }
+                draw_hud(renderer, font_score, &hud);
+            }
+            break;
+        case WINNING:
+            for (int i = 0; i < NUM_CONFETTI; ++i) {
+                if (station->confetti[i].lifetime > 0) draw_confetti(renderer, station->confetti[i]);
+            }
+            textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
+            draw_centered_text(renderer, font_menu_title, "You Win!", WINDOW_HEIGHT / 2 - 100, textColor);
+            break;
+        case GAME_STABILITY:
+            draw_stability(renderer, font_menu_title, font_menu_description);
+            break;
+    }
 
-        // --- Performance Optimizations ---
-        // Optimized debug output
-        static int debug_frame_counter = 0;
-        if (++debug_frame_counter >= DEBUG_INTERVAL) {
-            snprintf(debug_buffer, sizeof(debug_buffer),
-                    "DEBUG: x_cob=%.2f y_cob=%.2f weight=%.2f fps=%.1f\n",
-                    x_cob, y_cob, current_total_weight, 1000.0f / delta_time);
-            fputs(debug_buffer, stdout);
-            debug_frame_counter = 0;
+    // Draw game-specific elements
+    if (station->state == GAME_DODGE) {
+        draw_line_trail(renderer); // Add trail rendering
+        
+        // Draw background
+        SDL_Color start_color = {50, 50, 50, 255}; // Dark gray
+        SDL_Color end_color = {20, 20, 20, 255};   // Darker gray
+        draw_gradient_background(renderer, start_color, end_color);
+
+        // Draw dodge blocks
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red blocks
+        for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
+            if (station->dodge_blocks[i].active) {
+                SDL_Rect block = {
+                    (int)station->dodge_blocks[i].x,
+                    (int)station->dodge_blocks[i].y,
+                    BLOCK_WIDTH,
+                    BLOCK_HEIGHT
+                };
+                render_fill_rect(renderer, &block);
+            }
         }
 
-        // Render only if the window is visible
-        if (!(SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)) {
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_RenderClear(renderer);
+        // Draw station->player
+        SDL_Rect player_rect = {
+            (int)(station->player.x - GAME_OBJECT_SIZE / 2),
+            (int)(station->player.y - GAME_OBJECT_SIZE / 2),
+            GAME_OBJECT_SIZE,
+            GAME_OBJECT_SIZE
+        };
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green station->player
+        render_fill_rect(renderer, &player_rect);
+
+        // Draw score
+        HudValues hud = {GAME_DODGE, -1, station->dodge_score, station->dodge_high_score, -1, -1};
+        draw_hud(renderer, font_score, &hud);
+    }
+
+    if (station->game_paused) {
+        SDL_Rect dim_rect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 120);
+        render_fill_rect(renderer, &dim_rect);
+        if (station->resume_countdown_active) {
+            char countdown_text[50];
+            int remaining = RESUME_COUNTDOWN_SECONDS - (int)((SDL_GetTicks() - station->resume_countdown_start) / 1000);
+            snprintf(countdown_text, sizeof(countdown_text), "Resuming in %d", remaining > 0 ? remaining : 1);
+            // Each second starts with a pulse that shrinks back to normal size
+            float second = ((SDL_GetTicks() - station->resume_countdown_start) % 1000) / 1000.0f;
+            text_size(font_menu_title, countdown_text, &text_w, &text_h);
+            draw_text_scaled(renderer, font_menu_title, countdown_text, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 - 50 + text_h / 2,
+                             1.0f + 0.25f * (1.0f - second), (SDL_Color){255, 255, 255, 255});
+        } else {
+            draw_centered_text(renderer, font_menu_title, "Paused - step back on to continue", WINDOW_HEIGHT / 2 - 50, (SDL_Color){255, 255, 255, 255});
+        }
+    }
 
-            if (state == GAME_BALANCE_HOLD) { start_color = (SDL_Color){200, 255, 200, 255}; end_color = (SDL_Color){100, 200, 100, 255}; } // Green Gradient
-            else if (state == GAME_COIN_COLLECTOR) { start_color = (SDL_Color){255, 255, 255, 255}; end_color = (SDL_Color){173, 216, 230, 255}; } // Blue/White Gradient
-            else if (state == GAME_DODGE) { start_color = (SDL_Color){40, 40, 40, 255}; end_color = (SDL_Color){0, 0, 0, 255}; } // Black Gradient
-            else { start_color = (SDL_Color){240, 240, 240, 255}; end_color = (SDL_Color){200, 200, 200, 255}; } // Default gray gradient
-            draw_gradient_background(renderer, start_color, end_color);
+    if (station->show_board_stats && station->iface) {
+        draw_board_stats_overlay(renderer, font_menu_description);
+    }
 
-            viewport_rect = (state == TRANSITIONING) ? (SDL_Rect){render_offset_x, render_offset_y, WINDOW_WIDTH, WINDOW_HEIGHT} : (SDL_Rect){0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-            SDL_RenderSetViewport(renderer, &viewport_rect);
+    soft_raster_present(renderer);
+    if (scene_target) {
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, scene_target, NULL, NULL);
+    }
+    return 1;
+}
 
-            switch(state) {
-                case CONNECTING:
-                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    // Adjust connecting text and image positions
-                    if (boardpower_texture) {
-                        int img_width = 846;
-                        int img_height = 462;
-                        int img_x = (WINDOW_WIDTH - img_width) / 2;
-                        int img_y = (WINDOW_HEIGHT / 2) - 250; // Updated y position for image
-                        SDL_Rect rect = {img_x, img_y, img_width, img_height};
-                        SDL_RenderCopy(renderer, boardpower_texture, NULL, &rect);
-                    }
+/**
+ * @brief Allocates a station and opens its window, renderer, sprites and fonts.
+ * Main thread only, since it owns every window. Leaves `station` pointing at it.
+ * @return The station, or NULL if its window or renderer could not be created.
+ */
+Station* station_open(int index) {
+    Station* s = SDL_calloc(1, sizeof(Station));
+    if (!s) return NULL;
+    station = s;
+    s->index = index;
+    s->lock = SDL_CreateMutex();
+    s->fd = -1;
+    s->claimed_board = -1;
+    s->input_watch = -1;
+    s->render_watch = -1;
+    s->snapshot_front = -1;
+    s->selected_game = NO_GAME_SELECTED;
+    s->selected_player_index = -1;
+    s->current_block_speed = BLOCK_INITIAL_SPEED;
+    s->dynamic_block_spawn_interval = BLOCK_SPAWN_INTERVAL;
+    s->ghost_enabled = GHOST_ENABLED_DEFAULT;
+    sim_seed(sim_new_seed());
+    s->fx_rng = sim_new_seed();
+    s->state = CONNECTING;
+    s->published_state = CONNECTING;
+
+    char title[64] = "Wii Fit Balance Game";
+    int window_pos = SDL_WINDOWPOS_UNDEFINED;
+    if (station_count > 1) {
+        // One fullscreen window per display, wrapping around if there are fewer displays
+        snprintf(title, sizeof(title), "Wii Fit Balance Game - Station %d", index + 1);
+        window_pos = SDL_WINDOWPOS_CENTERED_DISPLAY(index % SDL_max(SDL_GetNumVideoDisplays(), 1));
+    }
+    s->window = SDL_CreateWindow(title, window_pos, window_pos, WINDOW_WIDTH, WINDOW_HEIGHT,
+                                 bench.active ? SDL_WINDOW_HIDDEN : (SDL_WINDOW_FULLSCREEN_DESKTOP | SDL_WINDOW_SHOWN));
+    if (!s->lock || !s->window) {
+        fprintf(stderr, "Window could not be created! SDL_Error: %s\n", SDL_GetError());
+        goto fail;
+    }
+    // Enable vsync for smoother rendering. The benchmark needs unthrottled presents,
+    // and with several windows the main thread would wait for every one of them.
+    SDL_SetHint(SDL_HINT_RENDER_BATCHING, "1"); // Consecutive atlas draws become one bind
+    int vsync = tuning.vsync && !autotune_mode && !bench.active && station_count == 1;
+    s->renderer = SDL_CreateRenderer(s->window, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+    if (!s->renderer) {
+        fprintf(stderr, "Accelerated renderer unavailable (%s), falling back to software\n", SDL_GetError());
+        s->renderer = SDL_CreateRenderer(s->window, -1, SDL_RENDERER_SOFTWARE);
+    }
+    if (!s->renderer) {
+        fprintf(stderr, "Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        goto fail;
+    }
+    SDL_RendererInfo renderer_info;
+    if ((SDL_GetRendererInfo(s->renderer, &renderer_info) == 0 && (renderer_info.flags & SDL_RENDERER_SOFTWARE)) || getenv(SOFT_RASTER_ENV)) {
+        soft_raster_init(s->renderer);
+    }
+    SDL_SetRenderDrawBlendMode(s->renderer, SDL_BLENDMODE_BLEND);
+    SDL_ShowCursor(SDL_DISABLE);
 
-                    // Draw connecting text below the image
-                    draw_centered_text(renderer, font_tutorial, "Connecting to Wii Balance Board...", (WINDOW_HEIGHT / 2) + 250, textColor);
-                    break;
-                case TRANSITIONING:
-                    // Background shake is handled by viewport
-                    break;
-                case PLAYER_SELECTION:
-                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_centered_text(renderer, font_menu_title, "Select Player", 150, textColor);
+    SpriteRequest sprite_requests[MAX_SPRITES] = {
+        {"boardpower.png", BOARDPOWER_WIDTH, BOARDPOWER_HEIGHT, &s->boardpower_sprite},
+        {"coin.png", STARTING_COIN_SIZE, STARTING_COIN_SIZE, &s->coin_sprite},
+    };
+    for (int i = 0; i < num_players; i++) {
+        int size = SDL_max(PLAYER_PORTRAIT_SIZE, GAME_OBJECT_SIZE);
+        sprite_requests[2 + i] = (SpriteRequest){available_players[i].image_path, size, size, &s->player_sprites[i]};
+    }
+    if (load_sprite_atlas(s->renderer, sprite_requests, 2 + num_players) > 0) {
+        fprintf(stderr, "Failed to load one or more image textures.\n");
+    }
 
-                    int base_y = WINDOW_HEIGHT / 2 + 100;
-                    int positions[] = {WINDOW_WIDTH / 4, WINDOW_WIDTH / 2, WINDOW_WIDTH * 3 / 4};
-                    const char* instructions[] = {"Lean Left", "Stay Centered", "Lean Right"};
+    s->font_score = open_shared_font(TITLE_FONT_SIZE);
+    s->font_tutorial = open_shared_font(TUTORIAL_FONT_SIZE);
+    s->font_menu_title = open_shared_font(MENU_TITLE_FONT_SIZE);
+    s->font_menu_description = open_shared_font(MENU_DESCRIPTION_FONT_SIZE);
+    if (!s->font_score || !s->font_tutorial || !s->font_menu_title || !s->font_menu_description) {
+        fprintf(stderr, "Failed to load font '%s'! TTF_Error: %s\n", FONT_FILE, TTF_GetError());
+    }
+    if (autotune_mode) return s; // Only the window, renderer and fonts are needed
 
-                    for (int i = 0; i < num_players; i++) {
-                        int text_width, text_height;
+    if (tuning.render_scale < 1.0f && !s->soft_raster_enabled && SDL_RenderTargetSupported(s->renderer)) {
+        s->scene_target = SDL_CreateTexture(s->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                            WINDOW_WIDTH * tuning.render_scale, WINDOW_HEIGHT * tuning.render_scale);
+    }
 
-                        if (player_textures[i]) {
-                            SDL_Rect img_rect = {positions[i] - 75, base_y - 200, 150, 150};
-                            SDL_RenderCopy(renderer, player_textures[i], NULL, &img_rect);
-                        }
+    prewarm_init();
 
-                        TTF_SizeText(font_menu_title, available_players[i].name, &text_width, &text_height);
-                        int x_pos = positions[i] - (text_width / 2);
+    // Initialize with default player (will be updated when player is selected)
+    s->lowest_time_to_win = -1.0f;
+    s->total_wins = 0;
+    s->last_frame_time = SDL_GetTicks();
+    s->last_input_time = SDL_GetTicks();
+    s->connection_start_time = SDL_GetTicks();
+    init_player(&s->player);
+    s->input_watch = watchdog_register("input", WATCHDOG_INPUT_MS); // Armed while a board is connected
+    s->render_watch = watchdog_register("render", WATCHDOG_RENDER_MS);
+    watchdog_arm(s->render_watch);
+    return s;
+
+fail:
+    // Nothing has been published or started for it yet
+    if (s->window) SDL_DestroyWindow(s->window);
+    if (s->lock) SDL_DestroyMutex(s->lock);
+    SDL_free(s);
+    station = NULL;
+    return NULL;
+}
 
-                        if (player_selection_choice == (i + 1)) {
-                            textColor = (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(menu_select_timer * 10))};
-                        } else {
-                            textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                        }
-                        draw_text(renderer, font_menu_title, available_players[i].name, x_pos, base_y, textColor);
+/**
+ * @brief Releases everything station_open and the game acquired: board, workers,
+ * textures, fonts, renderer and window. Main thread only, after the station's
+ * simulation thread has exited. The Station itself stays allocated until the
+ * event bus has drained, since queued events still point at it.
+ */
+void station_close(Station* s) {
+    station = s;
+    watchdog_disarm(s->render_watch);
+    watchdog_disarm(s->input_watch);
+    if (s->iface) {
+        board_stats_log_session("exit");
+        xwii_iface_close(s->iface, XWII_IFACE_BALANCE_BOARD);
+        xwii_iface_unref(s->iface);
+        s->iface = NULL;
+        board_release();
+    }
+    prewarm_shutdown();
+    cleanup_text_cache();
+    soft_raster_shutdown();
+    if (s->scene_target) SDL_DestroyTexture(s->scene_target);
+    s->scene_target = NULL;
+    recorder_discard();
+    ghost_close();
+    cleanup_sprites();
+    cleanup_hud_layer();
+    cleanup_ink_trail();
+    close_shared_font(s->font_score);
+    close_shared_font(s->font_tutorial);
+    close_shared_font(s->font_menu_title);
+    close_shared_font(s->font_menu_description);
+    s->font_score = s->font_tutorial = s->font_menu_title = s->font_menu_description = NULL;
+    if (s->renderer) SDL_DestroyRenderer(s->renderer);
+    if (s->window) SDL_DestroyWindow(s->window);
+    s->renderer = NULL;
+    s->window = NULL;
+    if (s->lock) SDL_DestroyMutex(s->lock);
+    s->lock = NULL;
+}
 
-                        TTF_SizeText(font_menu_description, instructions[i], &text_w, &text_h);
-                        x_pos = positions[i] - (text_w / 2);
-                        draw_text(renderer, font_menu_description, instructions[i], x_pos, base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
-                    }
-                    break;
-                case MAIN_MENU:
-                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_centered_text(renderer, font_menu_title, "Select Game", 150, textColor);
-
-                    int menu_base_y = WINDOW_HEIGHT / 2;
-                    int menu_x_left = WINDOW_WIDTH / 4;
-                    int menu_x_center = WINDOW_WIDTH / 2;
-                    int menu_x_right = WINDOW_WIDTH * 3 / 4;
-                    
-                    // Balance Hold Option
-                    TTF_SizeText(font_menu_title, "Balance Hold", &text_w, &text_h);
-                    textColor = (selected_game == BALANCE_HOLD) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_text(renderer, font_menu_title, "Balance Hold", menu_x_left - text_w/2, menu_base_y, textColor);
-                    TTF_SizeText(font_menu_description, "Lean left to select.", &text_w, &text_h);
-                    draw_text(renderer, font_menu_description, "Lean left to select.", menu_x_left - text_w/2, menu_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
-
-                    // Dodge Option
-                    TTF_SizeText(font_menu_title, "Dodge", &text_w, &text_h);
-                    textColor = (selected_game == DODGE) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_text(renderer, font_menu_title, "Dodge", menu_x_center - text_w/2, menu_base_y, textColor);
-                    TTF_SizeText(font_menu_description, "Stay centered to select.", &text_w, &text_h);
-                    draw_text(renderer, font_menu_description, "Stay centered to select.", menu_x_center - text_w/2, menu_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
-
-                    // Coin Collector Option
-                    TTF_SizeText(font_menu_title, "Coin Collector", &text_w, &text_h);
-                    textColor = (selected_game == COIN_COLLECTOR) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_text(renderer, font_menu_title, "Coin Collector", menu_x_right - text_w/2, menu_base_y, textColor);
-                    TTF_SizeText(font_menu_description, "Lean right to select.", &text_w, &text_h);
-                    draw_text(renderer, font_menu_description, "Lean right to select.", menu_x_right - text_w/2, menu_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
-
-                    // NEW: Display total wins
-                    char total_wins_text[50];
-                    snprintf(total_wins_text, 50, "Total Wins: %d", total_wins);
-                    draw_centered_text(renderer, font_menu_description, total_wins_text, menu_base_y + 200, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
-                    break;
-                case DIFFICULTY_SELECTION:
-                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_centered_text(renderer, font_menu_title, "Select Difficulty", 150, textColor);
-
-                    int diff_base_y = WINDOW_HEIGHT / 2;
-                    int diff_positions[] = {WINDOW_WIDTH / 4, WINDOW_WIDTH / 2, WINDOW_WIDTH * 3 / 4};
-                    const char* difficulties[] = {"Easy", "Medium", "Hard"};
-                    const char* diff_instructions[] = {"Lean Left", "Stay Centered", "Lean Right"};
-
-                    for (int i = 0; i < 3; i++) {
-                        int text_width, text_height;
-                        TTF_SizeText(font_menu_title, difficulties[i], &text_width, &text_height);
-                        int x_pos = diff_positions[i] - (text_width / 2);
-                        
-                        textColor = (difficulty_selection == (i + 1)) ? (SDL_Color){255, 255, 255, (Uint8)(128 + 127 * sin(menu_select_timer * 10))} : (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                        
-                        // Draw the difficulty text centered at its position
-                        draw_text(renderer, font_menu_title, difficulties[i], x_pos, diff_base_y, textColor);
-                        
-                        // Draw the instruction text below, also centered
-                        TTF_SizeText(font_menu_description, diff_instructions[i], &text_width, &text_height);
-                        x_pos = diff_positions[i] - (text_width / 2);
-                        draw_text(renderer, font_menu_description, diff_instructions[i], x_pos, diff_base_y + 80, (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255});
-                    }
-                    break;
-                case GAME_BALANCE_HOLD:
-                case GAME_COIN_COLLECTOR:
-                    draw_line_trail(renderer); // MODIFIED: Call the new line trail function
-                    draw_middle_grid(renderer);
-
-                    if (state == GAME_BALANCE_HOLD) {
-                        // Draw the larger, semi-transparent "grace zone" circle
-                        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 50); // Semi-transparent white
-                        draw_filled_circle(renderer, roundf(balance_hold_target.x), roundf(balance_hold_target.y), BH_GRACE_ZONE_RADIUS);
-
-                        // Draw the solid inner target circle
-                        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                        draw_filled_circle(renderer, roundf(balance_hold_target.x), roundf(balance_hold_target.y), roundf(BH_HOLD_RADIUS * pulse_scale));
-
-                        // Draw a pulsating outline that shows hold progress
-                        SDL_SetRenderDrawColor(renderer, 95, 215, 11, 255); // Changed to solid green
-                        draw_outlined_circle(renderer, roundf(balance_hold_target.x), roundf(balance_hold_target.y), roundf(BH_HOLD_RADIUS * (1.0f + 0.5f * hold_progress)), 5);
-
-
-                    } else { // GAME_COIN_COLLECTOR
-                        for (int i = 0; i < current_game_target; ++i) {
-                            if (coin_collector_coins[i].active) {
-                                 SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255); // Gold color for coins
-                                 SDL_Rect coin_rect = {roundf(coin_collector_coins[i].x - STARTING_COIN_SIZE/2), roundf(coin_collector_coins[i].y - STARTING_COIN_SIZE/2), STARTING_COIN_SIZE, STARTING_COIN_SIZE};
-                                 if (coin_texture) {
-                                     SDL_RenderCopy(renderer, coin_texture, NULL, &coin_rect);
-                                 } else {
-                                     SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255);
-                                     draw_filled_circle(renderer, roundf(coin_collector_coins[i].x), roundf(coin_collector_coins[i].y), STARTING_COIN_SIZE/2);
-                                 }
-                            }
-                        }
-                    }
+// Simulation thread of one station when there are several. The lock is only
+// held for the update itself, so the main thread draws while this one waits
+// for the next frame.
+static int station_thread(void* data) {
+    station = data;
+    station_pin_to_core(station->index);
+    Uint64 next_frame_counter = 0;
+    int quit = 0;
+    while (!quit) {
+        SDL_LockMutex(station->lock);
+        quit = station_update();
+        SDL_UnlockMutex(station->lock);
+        frame_limit(&next_frame_counter);
+    }
+    SDL_AtomicSet(&station->finished, 1);
+    return 0;
+}
 
-                    // Draw Player
-                    if (selected_player_index != -1 && player_textures[selected_player_index]) {
-                        SDL_Rect player_rect = {roundf(player.x - GAME_OBJECT_SIZE / 2.0f), roundf(player.y - GAME_OBJECT_SIZE / 2.0f), GAME_OBJECT_SIZE, GAME_OBJECT_SIZE};
-                        SDL_RenderCopy(renderer, player_textures[selected_player_index], NULL, &player_rect);
-                    } else {
-                        // MODIFIED: Draw player with the new color #D45351
-                        SDL_SetRenderDrawColor(renderer, TRAIL_COLOR_R, TRAIL_COLOR_G, TRAIL_COLOR_B, 255);
-                        draw_filled_circle(renderer, roundf(player.x), roundf(player.y), GAME_OBJECT_SIZE / 2);
-                    }
+/**
+ * @brief Opens station_count stations and runs them until all have quit. A
+ * single station updates and draws on the main thread. With several, each
+ * simulates on its own pinned thread while the main thread routes events to
+ * them and draws every window at the target frame rate.
+ */
+void run_stations(void) {
+    SDL_Event event_sdl;
+    Uint64 next_frame_counter = 0; // Performance counter value the next frame is due at
+    int opened = 0;
+    for (int i = 0; i < station_count; i++) {
+        stations[i] = station_open(i);
+        if (!stations[i]) break;
+        opened++;
+    }
 
-                    char score_text[50];
-                    snprintf(score_text, 50, state == GAME_BALANCE_HOLD ? "Targets: %d/%d" : "Coins: %d/%d", coins, current_game_target);
-                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_text(renderer, font_score, score_text, 50, 50, textColor);
-
-                    if (state == GAME_BALANCE_HOLD) {
-                        draw_hold_timer_bar(renderer, (WINDOW_WIDTH - BH_HOLD_BAR_WIDTH) / 2, 50, BH_HOLD_BAR_WIDTH, BH_HOLD_BAR_HEIGHT, hold_progress);
-                    } else if (state == GAME_COIN_COLLECTOR) {
-                        // Only show timer in hard mode
-                        if (current_difficulty == HARD) {
-                            char timer_text[50];
-                            snprintf(timer_text, 50, "Time Left: %.1f", coin_timer > 0 ? coin_timer : 0);
-                            draw_centered_text(renderer, font_score, timer_text, 100, textColor);
-                        }
-                    }
-                    break;
-                case WINNING:
-                    for (int i = 0; i < NUM_CONFETTI; ++i) {
-                        if (confetti[i].lifetime > 0) draw_confetti(renderer, confetti[i]);
-                    }
-                    textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                    draw_centered_text(renderer, font_menu_title, "You Win!", WINDOW_HEIGHT / 2 - 100, textColor);
-                    break;
+    if (autotune_mode) {
+        if (opened) {
+            station = stations[0];
+            run_autotune(station->renderer, station->font_score);
+        }
+    } else if (station_count == 1) {
+        while (opened) {
+            Uint64 frame_start_counter = SDL_GetPerformanceCounter();
+            while (SDL_PollEvent(&event_sdl) != 0) station_route_event(&event_sdl);
+            station = stations[0];
+            if (station_update()) break;
+            if (station_draw()) SDL_RenderPresent(station->renderer);
+            if (bench.active) {
+                bench_record_frame(frame_start_counter);
+                continue; // Replays run unthrottled
             }
-
-            // Draw game-specific elements
-            if (state == GAME_DODGE) {
-                draw_line_trail(renderer); // Add trail rendering
-                
-                // Draw background
-                SDL_Color start_color = {50, 50, 50, 255}; // Dark gray
-                SDL_Color end_color = {20, 20, 20, 255};   // Darker gray
-                draw_gradient_background(renderer, start_color, end_color);
-
-                // Draw dodge blocks
-                SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red blocks
-                for (int i = 0; i < MAX_DODGE_BLOCKS; i++) {
-                    if (dodge_blocks[i].active) {
-                        SDL_Rect block = {
-                            (int)dodge_blocks[i].x,
-                            (int)dodge_blocks[i].y,
-                            BLOCK_WIDTH,
-                            BLOCK_HEIGHT
-                        };
-                        SDL_RenderFillRect(renderer, &block);
-                    }
+            frame_limit(&next_frame_counter);
+        }
+    } else {
+        int running = 0;
+        for (int i = 0; i < opened; i++) {
+            stations[i]->thread = SDL_CreateThread(station_thread, "station", stations[i]);
+            if (!stations[i]->thread) {
+                fprintf(stderr, "Station %d thread could not be started: %s\n", i + 1, SDL_GetError());
+                SDL_AtomicSet(&stations[i]->finished, 1);
+            } else {
+                running++;
+            }
+        }
+        printf("Running %d stations\n", running);
+        while (running > 0) {
+            while (SDL_PollEvent(&event_sdl) != 0) station_route_event(&event_sdl);
+            running = 0;
+            for (int i = 0; i < opened; i++) {
+                Station* s = stations[i];
+                if (!s->window) continue;
+                if (SDL_AtomicGet(&s->finished)) {
+                    // Its thread is done with it; close its window now rather than leave it frozen
+                    if (s->thread) SDL_WaitThread(s->thread, NULL);
+                    s->thread = NULL;
+                    station_close(s);
+                    continue;
                 }
+                running++;
+                station = s;
+                SDL_LockMutex(s->lock);
+                int drawn = station_draw();
+                SDL_UnlockMutex(s->lock);
+                if (drawn) SDL_RenderPresent(s->renderer);
+            }
+            frame_limit(&next_frame_counter);
+        }
+    }
 
-                // Draw player
-                SDL_Rect player_rect = {
-                    (int)(player.x - GAME_OBJECT_SIZE / 2),
-                    (int)(player.y - GAME_OBJECT_SIZE / 2),
-                    GAME_OBJECT_SIZE,
-                    GAME_OBJECT_SIZE
-                };
-                SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green player
-                SDL_RenderFillRect(renderer, &player_rect);
+    for (int i = 0; i < opened; i++) {
+        if (stations[i]->window) station_close(stations[i]);
+    }
+}
 
-                // Draw score
-                char score_text[50];
-                snprintf(score_text, 50, "Score: %d  High Score: %d", dodge_score, dodge_high_score);
-                SDL_Color textColor = {255, 255, 255, 255}; // White text
-                draw_text(renderer, font_score, score_text, 50, 50, textColor);
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--autotune") == 0) autotune_mode = 1;
+        else if (strcmp(argv[i], "--stations") == 0 && i + 1 < argc) {
+            station_count = atoi(argv[++i]);
+            if (station_count < 1 || station_count > MAX_STATIONS) {
+                fprintf(stderr, "--stations takes 1 to %d\n", MAX_STATIONS);
+                return 1;
             }
-
-            // Draw player name in game modes
-            if ((state == GAME_BALANCE_HOLD || state == GAME_COIN_COLLECTOR) && selected_player_index != -1) {
-                char player_text[100];
-                snprintf(player_text, 100, "Player: %s", available_players[selected_player_index].name);
-                textColor = (SDL_Color){FONT_COLOR_R, FONT_COLOR_G, FONT_COLOR_B, 255};
-                int text_w, text_h;
-                TTF_SizeText(font_score, player_text, &text_w, &text_h);
-                draw_text(renderer, font_score, player_text, WINDOW_WIDTH - text_w - 50, 50, textColor);
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Usage: %s --bench <recording.rec>...\n", argv[0]);
+                return 1;
             }
-
-            SDL_RenderPresent(renderer);
+            if (bench_start(&argv[i + 1], argc - i - 1) != 0) return 1;
+            break;
+        } else if (strcmp(argv[i], "--inspect") == 0) {
+            if (i + 2 >= argc) {
+                fprintf(stderr, "Usage: %s --inspect <recording.rec> <from_seconds> [to_seconds]\n", argv[0]);
+                return 1;
+            }
+            return inspect_recording(argv[i + 1], atof(argv[i + 2]), i + 3 < argc ? atof(argv[i + 3]) : 0.0f) == 0 ? 0 : 1;
         }
+    }
+    if (station_count > 1 && (autotune_mode || bench.active)) {
+        fprintf(stderr, "--autotune and --bench run a single station\n");
+        station_count = 1;
+    }
+    if (load_tuning(TUNING_FILE, &tuning) == 0) {
+        printf("Loaded %s: quality %d, scale %.2f, %d fps, audio buffer %d\n", TUNING_FILE, tuning.quality, tuning.render_scale, tuning.target_fps, tuning.audio_buffer);
+    }
 
-        // Frame rate limiting
-        Uint32 frame_time = SDL_GetTicks() - frame_start;
-        if (frame_time < FRAME_TIME) {
-            SDL_Delay(FRAME_TIME - frame_time);
-        }
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+        fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError()); return 1;
+    }
+    if (TTF_Init() == -1) {
+        fprintf(stderr, "SDL_ttf could not initialize! TTF_Error: %s\n", TTF_GetError()); SDL_Quit(); return 1;
+    }
+    if (Mix_Init(MIX_INIT_MP3 | MIX_INIT_OGG) != (MIX_INIT_MP3 | MIX_INIT_OGG)) {
+        fprintf(stderr, "SDL_mixer could not initialize! Mix_Error: %s\n", Mix_GetError());
+    }
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, tuning.audio_buffer) < 0) {
+        fprintf(stderr, "SDL_mixer could not open audio! Mix_Error: %s\n", Mix_GetError());
+    } else {
+        audio_open = 1;
+    }
+    if (IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) == 0) {
+        fprintf(stderr, "SDL_image could not initialize! IMG_Error: %s\n", IMG_GetError());
+        Mix_CloseAudio(); TTF_Quit(); SDL_Quit(); return 1;
     }
 
-cleanup_iface:
-    if (iface) {
-        xwii_iface_close(iface, XWII_IFACE_BALANCE_BOARD);
-        xwii_iface_unref(iface);
+    shared_asset_lock = SDL_CreateMutex();
+    mixer_lock = SDL_CreateMutex();
+    shared_font_data = load_shared_file(FONT_FILE, &shared_font_size, &shared_font_owned);
+
+    coin_sound = load_shared_chunk("coin.mp3");
+    win_sound = load_shared_chunk("win.mp3");
+    select_sound = load_shared_chunk("select.mp3");
+    // Hold and hit feedback is synthesised; target.wav and reset.wav are only needed without synthesis.
+    // With several stations in one room only the sound effects play: no tone, no music.
+    if (station_count > 1 || synth_init() != 0) {
+        target_sound = load_shared_chunk("target.wav");
+        reset_sound = load_shared_chunk("reset.wav");
+    }
+    if (station_count == 1) {
+        connection_intro_music = Mix_LoadMUS("connection_intro.wav");
+        connection_main_music = Mix_LoadMUS("connection_main.wav");
+        transition_music = Mix_LoadMUS("transition.wav");
+        main_intro_music = Mix_LoadMUS("main_intro.wav");
+        main_loop_music = Mix_LoadMUS("main_loop.wav");
     }
 
-cleanup:
-    cleanup_text_cache();
+    if (!coin_sound || !win_sound || !select_sound || ((!target_sound || !reset_sound) && !synth_available()) ||
+        (station_count == 1 && (!connection_intro_music || !connection_main_music || !transition_music || !main_intro_music || !main_loop_music))) {
+        fprintf(stderr, "One or more audio files failed to load. Please check file paths. Mix_Error: %s\n", Mix_GetError());
+    }
+
+    // Set callback for intro music ending
+    Mix_HookMusicFinished(music_intro_finished_callback);
+
+    if (connection_intro_music && Mix_PlayMusic(connection_intro_music, 0) == -1) {
+        fprintf(stderr, "Failed to play connection_intro.wav: %s\n", Mix_GetError());
+    }
+
+    audio_watch = watchdog_register("audio", WATCHDOG_AUDIO_MS);
+    if (audio_open && !synth_available()) Mix_SetPostMix(audio_heartbeat_postmix, NULL);
+    // Autotune replaces the post-mix hook with its own probe
+    if (audio_open && !autotune_mode) watchdog_arm(audio_watch);
+    event_bus_start();
+    watchdog_start();
+    if (audio_open && !autotune_mode) audio_keeper_start();
+    run_stations();
+    audio_keeper_stop();
+    watchdog_stop();
+    event_bus_stop(); // Flushes pending sounds, profile writes and recordings
+    for (int i = 0; i < station_count; i++) SDL_free(stations[i]);
+
+    int exit_code = 0;
+    if (bench.active && bench_report() != 0) exit_code = 1;
+    synth_shutdown();
     if (coin_sound) Mix_FreeChunk(coin_sound);
     if (win_sound) Mix_FreeChunk(win_sound);
     if (select_sound) Mix_FreeChunk(select_sound);
@@ -1597,70 +7333,17 @@ cleanup:
     if (transition_music) Mix_FreeMusic(transition_music);
     if (main_intro_music) Mix_FreeMusic(main_intro_music);
     if (main_loop_music) Mix_FreeMusic(main_loop_music);
-    if (boardpower_texture) SDL_DestroyTexture(boardpower_texture);
-    for (int i = 0; i < num_players; i++) {
-        if (player_textures[i]) {
-            SDL_DestroyTexture(player_textures[i]);
-        }
-    }
-    if (coin_texture) SDL_DestroyTexture(coin_texture);
-    if (font_score) TTF_CloseFont(font_score);
-    if (font_tutorial) TTF_CloseFont(font_tutorial);
-    if (font_menu_title) TTF_CloseFont(font_menu_title);
-    if (font_menu_description) TTF_CloseFont(font_menu_description);
-    if (renderer) SDL_DestroyRenderer(renderer);
-    if (window) SDL_DestroyWindow(window);
+    cleanup_shared_images();
+    cleanup_sdf_atlas(); // Its master face reads the shared font bytes
+    if (shared_font_owned) SDL_free((void*)shared_font_data);
+    asset_cache_release_all();
+    render_cache_release_all(); // After everything that may point into a mapping
+    if (shared_asset_lock) SDL_DestroyMutex(shared_asset_lock);
+    if (mixer_lock) SDL_DestroyMutex(mixer_lock);
     Mix_Quit();
     IMG_Quit();
     TTF_Quit();
     SDL_Quit();
 
-    return 0;
-}
-
-// Add texture caching for text
-typedef struct {
-    char* text;
-    SDL_Texture* texture;
-    int w, h;
-} CachedText;
-
-#define MAX_CACHED_TEXTS 32
-CachedText text_cache[MAX_CACHED_TEXTS];
-int cached_text_count = 0;
-
-SDL_Texture* get_cached_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color) {
-    // Check cache first
-    for (int i = 0; i < cached_text_count; i++) {
-        if (strcmp(text_cache[i].text, text) == 0) {
-            return text_cache[i].texture;
-        }
-    }
-    
-    // Create new texture if not found
-    if (cached_text_count < MAX_CACHED_TEXTS) {
-        SDL_Surface* surface = TTF_RenderText_Blended(font, text, color);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-            if (texture) {
-                text_cache[cached_text_count].text = strdup(text);
-                text_cache[cached_text_count].texture = texture;
-                text_cache[cached_text_count].w = surface->w;
-                text_cache[cached_text_count].h = surface->h;
-                cached_text_count++;
-                SDL_FreeSurface(surface);
-                return texture;
-            }
-            SDL_FreeSurface(surface);
-        }
-    }
-    return NULL;
-}
-
-void cleanup_text_cache() {
-    for (int i = 0; i < cached_text_count; i++) {
-        free(text_cache[i].text);
-        SDL_DestroyTexture(text_cache[i].texture);
-    }
-    cached_text_count = 0;
+    return exit_code;
 }
@@ -0,0 +1,549 @@
+// Virtual Wii Balance Board for testing the game without the hardware.
+// It creates a HID device through /dev/uhid that looks like a balance board
+// connected over Bluetooth. The kernel's hid-wiimote driver binds to it and
+// libxwiimote finds it like a real board, so the game's whole input path
+// (monitor, interface, evdev, dispatch) is exercised. The tool answers the
+// driver's protocol requests and sends weight reports at the board's cadence,
+// taken from a session recording, a script or a built-in sway pattern.
+//
+// Needs write access to /dev/uhid (usually root) and the hid-wiimote module.
+
+// --- Include necessary libraries ---
+#define _GNU_SOURCE      // For ppoll
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>      // For offsetof
+#include <string.h>      // For memset, memcpy, strcmp
+#include <math.h>        // For cos, sin
+#include <time.h>        // For clock_gettime
+#include <signal.h>      // For sigaction
+#include <unistd.h>      // For read, write, close
+#include <fcntl.h>       // For open
+#include <errno.h>       // For errno
+#include <poll.h>        // For ppoll
+#include <linux/uhid.h>  // For struct uhid_event
+
+// --- Configuration ---
+#define UHID_PATH "/dev/uhid"
+#define BOARD_NAME "Nintendo RVL-WBC-01" // hid-wiimote recognises the balance board by this name
+#define BOARD_BUS 0x05 // BUS_BLUETOOTH
+#define NINTENDO_VENDOR_ID 0x057e
+#define WIIMOTE_PRODUCT_ID 0x0306
+#define DEFAULT_RATE_HZ 100.0 // Real boards report at ~100 Hz over Bluetooth
+#define DEFAULT_WEIGHT_KG 70.0 // Body weight for the built-in pattern
+#define CALIBRATION_ZERO 1000 // Raw reading at 0 kg; every count above it is 10 g
+#define SWAY_PERIOD_SECONDS 8.0 // Built-in pattern: one slow circle of the centre of balance...
+#define SWAY_AMOUNT 0.5 // ...at this fraction of full lean
+#define END_OFF_BOARD_SECONDS 1.0 // Empty-board reports sent after a non-looping source ends
+#define MAX_SCRIPT_FRAMES 100000
+
+// --- Wiimote Protocol ---
+enum {
+    REPORT_LEDS = 0x11,
+    REPORT_DRM = 0x12,          // Data reporting mode
+    REPORT_STATUS_REQUEST = 0x15,
+    REPORT_WRITE_MEMORY = 0x16,
+    REPORT_READ_MEMORY = 0x17,
+    REPORT_STATUS = 0x20,
+    REPORT_READ_DATA = 0x21,
+    REPORT_ACK = 0x22,
+    REPORT_KEE = 0x34           // Buttons and 19 extension bytes, what the driver picks for the board
+};
+#define STATUS_EXTENSION 0x02 // Status flag: an extension (the board's sensors) is connected
+#define MEMORY_REGISTER_SPACE 0x04 // Read/write flag: address is a register, not EEPROM
+#define EXTENSION_REGISTERS 0xa40000 // The balance board answers as an extension at this address
+#define MEMORY_ERROR_NONEXISTENT 0x07
+#define CALIBRATION_ADDRESS 0x24 // Three sets (0, 17, 34 kg) of four big-endian cell readings
+#define EXTENSION_ID_ADDRESS 0xfa
+static const uint8_t balance_board_id[6] = {0x00, 0x00, 0xa4, 0x20, 0x04, 0x02};
+
+// Report IDs and payload sizes, used to build the report descriptor
+static const uint8_t output_reports[][2] = {
+    {0x10, 1}, {0x11, 1}, {0x12, 2}, {0x13, 1}, {0x14, 1}, {0x15, 1}, {0x16, 21}, {0x17, 6}, {0x18, 21}, {0x19, 1}, {0x1a, 1}
+};
+static const uint8_t input_reports[][2] = {
+    {0x20, 6}, {0x21, 21}, {0x22, 4}, {0x30, 2}, {0x31, 5}, {0x32, 10}, {0x33, 17}, {0x34, 21},
+    {0x35, 21}, {0x36, 21}, {0x37, 21}, {0x3d, 21}, {0x3e, 21}, {0x3f, 21}
+};
+
+// --- Session Recording Layout ---
+// Copies of the recording structures in game.c; keep them in sync.
+#define RECORDING_MAGIC "BBRC"
+#define RECORDING_INDEX_MAGIC "BBIX"
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t sample_size;
+    uint8_t mode;
+    uint8_t difficulty;
+    uint8_t player_index;
+    uint8_t completed;
+    uint32_t duration_ms;
+    int64_t started_at;
+    uint32_t seed;          // Version 3 and later
+    uint32_t reserved;
+} RecordingHeader;
+
+typedef struct {
+    uint32_t time_ms;
+    int16_t x, y;
+    int16_t x_cob, y_cob;   // 10 g units, as the game computes them
+    uint16_t weight;        // 10 g units
+    uint16_t score;
+} RecordingSample;
+
+typedef struct {
+    uint32_t sample_count;
+    uint32_t keyframe_count;
+    char magic[4];
+} RecordingTrailer;
+
+// Cell loads at one point in time; cells in the game's order (TL, TR, BL, BR), in kg
+typedef struct {
+    double time;
+    double cells[4];
+} CellFrame;
+
+// --- Globals ---
+static int uhid_fd = -1;
+static volatile sig_atomic_t quit = 0;
+static int device_open = 0;         // The driver has opened the device
+static uint8_t data_mode = REPORT_KEE;
+static uint8_t led_flags = 0;
+static uint8_t extension_registers[256];
+static CellFrame* frames = NULL;    // Cell source; NULL for the built-in pattern
+static int frame_count = 0;
+static double body_weight = DEFAULT_WEIGHT_KG;
+
+// --- Device ---
+static int uhid_write(const struct uhid_event* event) {
+    if (write(uhid_fd, event, sizeof(*event)) != sizeof(*event)) {
+        perror("Failed to write to " UHID_PATH);
+        return -1;
+    }
+    return 0;
+}
+
+static int send_report(const uint8_t* data, uint16_t size) {
+    struct uhid_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = UHID_INPUT2;
+    event.u.input2.size = size;
+    memcpy(event.u.input2.data, data, size);
+    return uhid_write(&event);
+}
+
+static size_t append_report_items(uint8_t* descriptor, size_t size, uint8_t id, uint8_t count, uint8_t main_item) {
+    const uint8_t items[] = {0x85, id, 0x95, count, 0x09, 0x01, main_item, 0x00};
+    memcpy(descriptor + size, items, sizeof(items));
+    return size + sizeof(items);
+}
+
+// Vendor-defined reports with the Wii Remote's IDs and sizes; the driver reads the raw reports itself
+static size_t build_report_descriptor(uint8_t* descriptor) {
+    const uint8_t header[] = {
+        0x05, 0x01,        // Usage Page (Generic Desktop)
+        0x09, 0x05,        // Usage (Game Pad)
+        0xa1, 0x01,        // Collection (Application)
+        0x15, 0x00,        //   Logical Minimum (0)
+        0x26, 0xff, 0x00,  //   Logical Maximum (255)
+        0x75, 0x08,        //   Report Size (8)
+        0x06, 0x00, 0xff,  //   Usage Page (Vendor Defined)
+    };
+    size_t size = sizeof(header);
+    memcpy(descriptor, header, size);
+    for (size_t i = 0; i < sizeof(output_reports) / sizeof(output_reports[0]); i++) {
+        size = append_report_items(descriptor, size, output_reports[i][0], output_reports[i][1], 0x91);
+    }
+    for (size_t i = 0; i < sizeof(input_reports) / sizeof(input_reports[0]); i++) {
+        size = append_report_items(descriptor, size, input_reports[i][0], input_reports[i][1], 0x81);
+    }
+    descriptor[size++] = 0xc0; // End Collection
+    return size;
+}
+
+static void put_be16(uint8_t* out, unsigned int value) {
+    out[0] = (value >> 8) & 0xff;
+    out[1] = value & 0xff;
+}
+
+// Cell reading in the board's raw units for a load in kg
+static unsigned int cell_raw(double kg) {
+    double raw = CALIBRATION_ZERO + kg * 100.0;
+    return raw < 0.0 ? 0 : (raw > 65535.0 ? 65535 : (unsigned int)raw);
+}
+
+static int create_device(void) {
+    uhid_fd = open(UHID_PATH, O_RDWR | O_CLOEXEC);
+    if (uhid_fd < 0) {
+        perror("Failed to open " UHID_PATH);
+        return -1;
+    }
+    // Linear calibration: 0, 17 and 34 kg read CALIBRATION_ZERO plus 10 g per count
+    static const double calibration_kg[3] = {0.0, 17.0, 34.0};
+    for (int level = 0; level < 3; level++) {
+        for (int cell = 0; cell < 4; cell++) {
+            put_be16(&extension_registers[CALIBRATION_ADDRESS + (level * 4 + cell) * 2], cell_raw(calibration_kg[level]));
+        }
+    }
+    memcpy(&extension_registers[EXTENSION_ID_ADDRESS], balance_board_id, sizeof(balance_board_id));
+
+    struct uhid_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = UHID_CREATE2;
+    snprintf((char*)event.u.create2.name, sizeof(event.u.create2.name), "%s", BOARD_NAME);
+    snprintf((char*)event.u.create2.phys, sizeof(event.u.create2.phys), "virtual_board");
+    snprintf((char*)event.u.create2.uniq, sizeof(event.u.create2.uniq), "00:00:00:00:00:00");
+    event.u.create2.rd_size = build_report_descriptor(event.u.create2.rd_data);
+    event.u.create2.bus = BOARD_BUS;
+    event.u.create2.vendor = NINTENDO_VENDOR_ID;
+    event.u.create2.product = WIIMOTE_PRODUCT_ID;
+    if (uhid_write(&event) != 0) {
+        close(uhid_fd);
+        uhid_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void destroy_device(void) {
+    if (uhid_fd < 0) return;
+    struct uhid_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = UHID_DESTROY;
+    uhid_write(&event);
+    close(uhid_fd);
+    uhid_fd = -1;
+}
+
+static void send_status(void) {
+    uint8_t report[7] = {REPORT_STATUS, 0, 0, STATUS_EXTENSION | led_flags, 0, 0, 0xc0};
+    send_report(report, sizeof(report));
+}
+
+// Answers a memory read in 16-byte chunks. Only the extension registers exist.
+static void answer_read(const uint8_t* request) {
+    int registers = request[1] & MEMORY_REGISTER_SPACE;
+    unsigned int address = (request[2] << 16) | (request[3] << 8) | request[4];
+    unsigned int size = (request[5] << 8) | request[6];
+    int known = registers && (address & 0xffff00) == EXTENSION_REGISTERS;
+    do {
+        unsigned int chunk = size > 16 ? 16 : (size ? size : 1);
+        uint8_t report[22] = {REPORT_READ_DATA, 0, 0};
+        if (known && (address & 0xff) + chunk <= sizeof(extension_registers)) {
+            report[3] = (chunk - 1) << 4;
+            memcpy(&report[6], &extension_registers[address & 0xff], chunk);
+        } else {
+            report[3] = MEMORY_ERROR_NONEXISTENT;
+            size = chunk; // Stop after the error
+        }
+        put_be16(&report[4], address & 0xffff);
+        send_report(report, sizeof(report));
+        address += chunk;
+        size -= chunk;
+    } while (size > 0);
+}
+
+// Writes are only acknowledged: the driver's extension init writes leave the
+// calibration and ID it reads afterwards unchanged, as on a real board.
+static void answer_write(void) {
+    uint8_t report[5] = {REPORT_ACK, 0, 0, REPORT_WRITE_MEMORY, 0};
+    send_report(report, sizeof(report));
+}
+
+static void handle_output(const uint8_t* data, size_t size) {
+    if (size < 2) return;
+    switch (data[0]) {
+        case REPORT_LEDS:
+            led_flags = data[1] & 0xf0;
+            break;
+        case REPORT_DRM:
+            if (size >= 3) data_mode = data[2];
+            break;
+        case REPORT_STATUS_REQUEST:
+            send_status();
+            break;
+        case REPORT_WRITE_MEMORY:
+            if (size >= 22) answer_write();
+            break;
+        case REPORT_READ_MEMORY:
+            if (size >= 7) answer_read(data);
+            break;
+    }
+}
+
+static void handle_uhid_event(void) {
+    struct uhid_event event;
+    ssize_t got = read(uhid_fd, &event, sizeof(event));
+    if (got <= 0) {
+        if (got < 0 && errno != EINTR && errno != EAGAIN) {
+            perror("Failed to read from " UHID_PATH);
+            quit = 1;
+        }
+        return;
+    }
+    switch (event.type) {
+        case UHID_START:
+            printf("Virtual board: device started\n");
+            break;
+        case UHID_OPEN:
+            device_open = 1;
+            break;
+        case UHID_CLOSE:
+            device_open = 0;
+            break;
+        case UHID_OUTPUT:
+            handle_output(event.u.output.data, event.u.output.size);
+            break;
+        case UHID_GET_REPORT: {
+            struct uhid_event reply;
+            memset(&reply, 0, sizeof(reply));
+            reply.type = UHID_GET_REPORT_REPLY;
+            reply.u.get_report_reply.id = event.u.get_report.id;
+            reply.u.get_report_reply.err = EIO;
+            uhid_write(&reply);
+            break;
+        }
+        case UHID_SET_REPORT: {
+            struct uhid_event reply;
+            memset(&reply, 0, sizeof(reply));
+            reply.type = UHID_SET_REPORT_REPLY;
+            reply.u.set_report_reply.id = event.u.set_report.id;
+            handle_output(event.u.set_report.data, event.u.set_report.size);
+            uhid_write(&reply);
+            break;
+        }
+    }
+}
+
+// Sends one weight report in the data mode the driver asked for
+static void send_cells(const double* cells) {
+    // Extension bytes: TR, BR, TL, BL as big-endian raw readings, temperature, battery
+    uint8_t extension[11] = {0};
+    put_be16(&extension[0], cell_raw(cells[1]));
+    put_be16(&extension[2], cell_raw(cells[3]));
+    put_be16(&extension[4], cell_raw(cells[0]));
+    put_be16(&extension[6], cell_raw(cells[2]));
+    extension[8] = 0x19;
+    extension[10] = 0xc0;
+
+    int offset, length;
+    switch (data_mode) {
+        case 0x32: offset = 3; length = 8; break;
+        case 0x35: offset = 6; length = 16; break;
+        case 0x36: offset = 13; length = 9; break;
+        case 0x3d: offset = 1; length = 21; break;
+        default: data_mode = REPORT_KEE; offset = 3; length = 19; break;
+    }
+    uint8_t report[22] = {data_mode};
+    memcpy(&report[offset], extension, length < (int)sizeof(extension) ? length : (int)sizeof(extension));
+    send_report(report, offset + length);
+}
+
+// --- Cell Sources ---
+// Recorded sessions only keep the CoB and total weight, so the cells are
+// rebuilt with equal loads on the two diagonals; that reproduces the same CoB.
+static void cells_from_cob(double weight_kg, double x_kg, double y_kg, double* cells) {
+    cells[0] = (weight_kg - x_kg + y_kg) / 4.0; // TL
+    cells[1] = (weight_kg + x_kg + y_kg) / 4.0; // TR
+    cells[2] = (weight_kg - x_kg - y_kg) / 4.0; // BL
+    cells[3] = (weight_kg + x_kg - y_kg) / 4.0; // BR
+    for (int i = 0; i < 4; i++) {
+        if (cells[i] < 0.0) cells[i] = 0.0;
+    }
+}
+
+static int load_recording(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror("Failed to open recording");
+        return -1;
+    }
+    RecordingHeader header;
+    if (fread(&header, offsetof(RecordingHeader, seed), 1, file) != 1 || memcmp(header.magic, RECORDING_MAGIC, 4) != 0 ||
+        header.sample_size != sizeof(RecordingSample)) {
+        fprintf(stderr, "%s is not a session recording\n", path);
+        fclose(file);
+        return -1;
+    }
+    // Headers before version 3 end where the seed starts
+    long header_size = header.version >= 3 ? (long)sizeof(header) : (long)offsetof(RecordingHeader, seed);
+    fseek(file, 0, SEEK_END);
+    long body = ftell(file) - header_size;
+    long count = body / (long)sizeof(RecordingSample);
+    if (header.version >= 2 && body >= (long)sizeof(RecordingTrailer)) {
+        // Closed recordings end with the keyframe index; only the samples are needed
+        RecordingTrailer trailer;
+        fseek(file, -(long)sizeof(trailer), SEEK_END);
+        if (fread(&trailer, sizeof(trailer), 1, file) == 1 && memcmp(trailer.magic, RECORDING_INDEX_MAGIC, 4) == 0 &&
+            (long)trailer.sample_count <= count) {
+            count = trailer.sample_count;
+        }
+    }
+    fseek(file, header_size, SEEK_SET);
+    frames = calloc(count > 0 ? count : 1, sizeof(CellFrame));
+    if (!frames) {
+        fclose(file);
+        return -1;
+    }
+    RecordingSample sample;
+    while (frame_count < count && fread(&sample, sizeof(sample), 1, file) == 1) {
+        CellFrame* frame = &frames[frame_count++];
+        frame->time = sample.time_ms / 1000.0;
+        cells_from_cob(sample.weight / 100.0, sample.x_cob / 100.0, sample.y_cob / 100.0, frame->cells);
+    }
+    fclose(file);
+    printf("Virtual board: replaying %d samples (%.1fs) from %s\n", frame_count,
+           frame_count ? frames[frame_count - 1].time : 0.0, path);
+    return frame_count > 0 ? 0 : -1;
+}
+
+// Script lines are "<seconds> <TL kg> <TR kg> <BL kg> <BR kg>"; loads ramp linearly between lines
+static int load_script(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror("Failed to open script");
+        return -1;
+    }
+    frames = calloc(MAX_SCRIPT_FRAMES, sizeof(CellFrame));
+    if (!frames) {
+        fclose(file);
+        return -1;
+    }
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) && frame_count < MAX_SCRIPT_FRAMES) {
+        line_number++;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+        CellFrame* frame = &frames[frame_count];
+        if (sscanf(line, "%lf %lf %lf %lf %lf", &frame->time, &frame->cells[0], &frame->cells[1], &frame->cells[2], &frame->cells[3]) != 5 ||
+            (frame_count > 0 && frame->time < frames[frame_count - 1].time)) {
+            fprintf(stderr, "%s:%d: expected increasing \"<seconds> <TL> <TR> <BL> <BR>\"\n", path, line_number);
+            fclose(file);
+            return -1;
+        }
+        frame_count++;
+    }
+    fclose(file);
+    return frame_count > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Cell loads at time t seconds into the source.
+ * @return 0, or -1 once a non-looping source has run out.
+ */
+static int cells_at(double t, int loop, double* cells) {
+    if (!frames) {
+        double angle = 2.0 * M_PI * t / SWAY_PERIOD_SECONDS;
+        cells_from_cob(body_weight, body_weight * SWAY_AMOUNT * cos(angle), body_weight * SWAY_AMOUNT * sin(angle), cells);
+        return 0;
+    }
+    double length = frames[frame_count - 1].time;
+    if (t > length) {
+        if (!loop || length <= 0.0) return -1;
+        t = fmod(t, length);
+    }
+    static int cursor = 0; // Playback only moves forward, apart from wrapping
+    if (cursor >= frame_count || frames[cursor].time > t) cursor = 0;
+    while (cursor + 1 < frame_count && frames[cursor + 1].time <= t) cursor++;
+    const CellFrame* a = &frames[cursor];
+    const CellFrame* b = &frames[cursor + 1 < frame_count ? cursor + 1 : cursor];
+    double span = b->time - a->time;
+    double blend = span > 0.0 ? (t - a->time) / span : 0.0;
+    for (int i = 0; i < 4; i++) cells[i] = a->cells[i] + (b->cells[i] - a->cells[i]) * blend;
+    return 0;
+}
+
+// --- Main ---
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void handle_signal(int signal_number) {
+    (void)signal_number;
+    quit = 1;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--rec <recording.rec> | --script <file>] [--loop] [--rate <hz>] [--jitter <ms>] [--weight <kg>]\n"
+            "Without a recording or script the board reports a person slowly circling their centre of balance.\n",
+            program);
+}
+
+int main(int argc, char* argv[]) {
+    double rate_hz = DEFAULT_RATE_HZ, jitter_ms = 0.0;
+    int loop = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rec") == 0 && i + 1 < argc) {
+            if (load_recording(argv[++i]) != 0) return 1;
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            if (load_script(argv[++i]) != 0) return 1;
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate_hz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+            jitter_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--weight") == 0 && i + 1 < argc) {
+            body_weight = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--loop") == 0) {
+            loop = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (rate_hz <= 0.0) {
+        fprintf(stderr, "--rate must be positive\n");
+        return 1;
+    }
+
+    struct sigaction action = {0};
+    action.sa_handler = handle_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (create_device() != 0) return 1;
+    printf("Virtual board: created, reporting at %.0f Hz once the driver opens it\n", rate_hz);
+
+    double period = 1.0 / rate_hz;
+    double start = 0.0, deadline = now_seconds(), ended_at = 0.0;
+    double late_max = 0.0, late_total = 0.0;
+    unsigned long reports = 0, late_reports = 0;
+    while (!quit) {
+        double now = now_seconds();
+        if (now >= deadline) {
+            if (device_open) {
+                double cells[4] = {0.0, 0.0, 0.0, 0.0};
+                if (start == 0.0) start = now;
+                if (ended_at == 0.0 && cells_at(now - start, loop, cells) != 0) ended_at = now;
+                // A finished source steps off the board, then the board disappears
+                if (ended_at != 0.0 && now - ended_at >= END_OFF_BOARD_SECONDS) break;
+                send_cells(cells);
+                reports++;
+                double late = now - deadline;
+                late_total += late;
+                if (late > late_max) late_max = late;
+                if (late > period / 2.0) late_reports++;
+            }
+            double jitter = jitter_ms > 0.0 ? (rand() / (double)RAND_MAX * 2.0 - 1.0) * jitter_ms / 1000.0 : 0.0;
+            deadline += period + jitter;
+            if (deadline < now - period) deadline = now; // Don't burst to catch up after a stall
+            continue;
+        }
+        struct pollfd fds = {uhid_fd, POLLIN, 0};
+        double wait = deadline - now;
+        struct timespec timeout = {(time_t)wait, (long)((wait - (time_t)wait) * 1e9)};
+        if (ppoll(&fds, 1, &timeout, NULL) > 0 && (fds.revents & POLLIN)) handle_uhid_event();
+    }
+
+    if (reports > 0) {
+        printf("Virtual board: %lu reports, mean lateness %.3f ms, max %.3f ms, %lu more than half a period late\n",
+               reports, late_total / reports * 1000.0, late_max * 1000.0, late_reports);
+    }
+    destroy_device();
+    free(frames);
+    return 0;
+}